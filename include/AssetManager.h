@@ -3,19 +3,167 @@
 
 #include "olcPixelGameEngine.h"
 #include "olcSoundWaveEngine.h"
+#include "olcAssetBundle.h"
+#include "olcTextureAtlas.h"
 
 #include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <filesystem>
 
+// Assets are loaded asynchronously. LoadGraphic/LoadSound check the file exists and
+// queue it on a pool of worker threads, which decode the PNG/WAV in parallel. The
+// only part that has to happen on the engine thread is turning a decoded sprite into
+// a Decal (a GPU upload), which happens either in ProcessLoads(), called once per
+// frame, or on demand the first time the graphic is asked for.
+//
+// Load* and Get* are called from the engine thread, as before. A GraphicHandle must
+// only be resolved on the engine thread; a SoundHandle can be resolved anywhere.
+//
+// Assets are looked up by AssetID, a 64 bit FNV-1a hash of the key. Built from a
+// string literal the hash is a constant expression, so
+//
+//     static constexpr AssetID PLAYER{ "player" };
+//     AssetManager::GetDecal(PLAYER);
+//
+// costs one probe of a flat table, and a handle fetched once with GetGraphicHandle()
+// caches the pointers it resolves to, so costs nothing at all.
+//
+// With EnableHotReload(), files loaded from disk are watched (inotify on Linux,
+// polling elsewhere). A changed file is decoded again on the workers, and swapped
+// in by ProcessLoads(), so between frames. A graphic keeps its Renderable, Sprite
+// and Decal, and only its texture is uploaded again, so pointers stay valid. A sound
+// gets a new Wave, and the old one is kept alive until no voice is playing it, so
+// voices already playing it carry on; a SoundHandle notices the swap and hands out
+// the new one. Wave pointers kept from GetSound() are not safe across a reload.
+//
+// BuildAtlas() packs the graphics loaded so far into a few large textures. Drawing
+// from GetRegion()/GraphicHandle::Region() with DrawPartialDecal() then binds one
+// texture for a whole run of sprites, rather than one each. Regions of graphics not
+// in an atlas are the whole of their own decal, so drawing code needn't care.
+//
+// SetTextureCache() keeps every decoded PNG in a directory as raw RGBA, named by a
+// hash of the PNG's contents. Loading an unchanged file again maps the cached copy
+// and uploads straight from it, with no decode. Edited files simply hash to a new
+// name, so the copies of old versions are trimmed away, least recently used first,
+// whenever the cache is set up; the directory can be deleted at any time.
+//
+// SetSoundSampleRate() tells the workers the rate the audio device runs at, and
+// each sound is resampled to it as part of its decode. PlayWaveform() then finds
+// the converted copy ready, instead of converting the whole wave on the game
+// thread the first time it is played.
+
+// O------------------------------------------------------------------------------O
+// | AssetID - compile time hash of an asset key                                  |
+// O------------------------------------------------------------------------------O
+struct AssetID
+{
+    uint64_t hash = 0;
+
+    constexpr AssetID() = default;
+    constexpr AssetID(const char* key) : hash(Hash(key, Length(key))) {}
+    AssetID(const std::string& key) : hash(Hash(key.data(), key.size())) {}
+
+    static constexpr size_t Length(const char* key)
+    {
+        size_t n = 0;
+        while(key[n] != '\0') n++;
+        return n;
+    }
+
+    // FNV-1a, the same as asset bundles index by. It never returns 0, which marks
+    // an empty slot in AssetTable
+    static constexpr uint64_t Hash(const char* key, size_t nLength)
+    {
+        return olc::AssetBundle::Hash(key, nLength);
+    }
+
+    static constexpr AssetID FromHash(uint64_t h)
+    {
+        AssetID id;
+        id.hash = h;
+        return id;
+    }
+
+    constexpr bool operator==(const AssetID& rhs) const { return hash == rhs.hash; }
+    constexpr bool operator!=(const AssetID& rhs) const { return hash != rhs.hash; }
+};
+
+// O------------------------------------------------------------------------------O
+// | AssetTable - open addressing AssetID -> T* map, linear probing               |
+// O------------------------------------------------------------------------------O
+template<typename T>
+class AssetTable
+{
+public:
+    T* Find(AssetID id) const
+    {
+        if(nCount == 0) return nullptr;
+        const size_t nMask = vSlots.size() - 1;
+        for(size_t i = size_t(id.hash) & nMask; ; i = (i + 1) & nMask)
+        {
+            const Slot& slot = vSlots[i];
+            if(slot.hash == id.hash) return slot.value;
+            if(slot.hash == 0) return nullptr;
+        }
+    }
+
+    // the caller checks Find() first, ids are never inserted twice
+    void Insert(AssetID id, T* value)
+    {
+        assert(id.hash != 0 && value != nullptr);
+        // kept at most half full, so probe sequences stay short
+        if((nCount + 1) * 2 > vSlots.size()) Grow();
+        const size_t nMask = vSlots.size() - 1;
+        size_t i = size_t(id.hash) & nMask;
+        while(vSlots[i].hash != 0) i = (i + 1) & nMask;
+        vSlots[i] = { id.hash, value };
+        nCount++;
+    }
+
+    size_t size() const { return nCount; }
+
+private:
+    struct Slot
+    {
+        uint64_t hash = 0;
+        T* value = nullptr;
+    };
+
+    void Grow()
+    {
+        std::vector<Slot> vOld = std::move(vSlots);
+        vSlots.assign(std::max<size_t>(16, vOld.size() * 2), Slot{});
+        nCount = 0;
+        for(auto & slot : vOld)
+            if(slot.hash != 0) Insert(AssetID::FromHash(slot.hash), slot.value);
+    }
+
+    std::vector<Slot> vSlots;
+    size_t nCount = 0;
+};
+
 class AssetManager
 {
 private:
     AssetManager();
     ~AssetManager();
 
+    struct GraphicEntry;
+    struct SoundEntry;
+
 public:
     static AssetManager& getInstance()
     {
@@ -23,136 +171,460 @@ public:
         return The_ONE_and_ONLY_Instance;
     }
 
+public: // Handles to assets which may still be loading
+
+    // The first Get() resolves the graphic and the handle keeps the pointers, so keep
+    // handles around (as members, say) rather than fetching them every frame. Copy a
+    // handle rather than share one between threads.
+    class GraphicHandle
+    {
+    public:
+        GraphicHandle() = default;
+        // true once the graphic can be used without waiting or uploading
+        bool IsReady() const;
+        // waits for the decode if it has not finished, and uploads it if it hasn't been
+        olc::Renderable* Get() const { if(graphic == nullptr) Resolve(); return graphic; }
+        olc::Decal* Decal() const { if(graphic == nullptr) Resolve(); return decal; }
+        olc::Sprite* Sprite() const { if(graphic == nullptr) Resolve(); return sprite; }
+        const olc::AtlasRegion& Region() const;
+        explicit operator bool() const { return entry != nullptr; }
+
+    private:
+        friend class AssetManager;
+        explicit GraphicHandle(GraphicEntry* e) : entry(e) {}
+        void Resolve() const;
+        GraphicEntry* entry = nullptr;
+        mutable olc::Renderable* graphic = nullptr;
+        mutable olc::Decal* decal = nullptr;
+        mutable olc::Sprite* sprite = nullptr;
+    };
+
+    class SoundHandle
+    {
+    public:
+        SoundHandle() = default;
+        bool IsReady() const;
+        // waits for the decode if it has not finished
+        olc::sound::Wave* Get() const
+        {
+            if(sample == nullptr || version != entry->version.load(std::memory_order_acquire)) Resolve();
+            return sample;
+        }
+        explicit operator bool() const { return entry != nullptr; }
+
+    private:
+        friend class AssetManager;
+        explicit SoundHandle(SoundEntry* e) : entry(e) {}
+        void Resolve() const;
+        SoundEntry* entry = nullptr;
+        mutable olc::sound::Wave* sample = nullptr;
+        mutable uint32_t version = 0;
+    };
+
 public: // Static methods
 
-    // loads a graphic from the provided file path, maps it to the provided key
-    static void LoadGraphic(const std::string& key, const std::string& path)
+    // queues a graphic at the provided file path for loading, mapped to the provided key
+    static GraphicHandle LoadGraphic(const std::string& key, const std::string& path)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        return am._loadGraphic(key, path);
+    }
+
+    // caches decoded graphics loaded from now on in the directory dir, creating it if
+    // need be, and first trims it to nMaxBytes. An empty dir turns the cache off
+    static void SetTextureCache(const std::string& dir, uint64_t nMaxBytes = uint64_t(512) << 20)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._setTextureCache(dir, nMaxBytes);
+    }
+
+    // queues a sound at the provided file path for loading, mapped to the provided key
+    static SoundHandle LoadSound(const std::string& key, const std::string& path)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        return am._loadSound(key, path);
+    }
+
+    // resamples sounds loaded from now on to nSampleRate on the workers, so playing them
+    // costs nothing extra. Pass the rate given to WaveEngine::InitialiseAudio(), or 0 to
+    // leave sounds at their own rate, for PlayWaveform() to convert when first played
+    static void SetSoundSampleRate(uint32_t nSampleRate)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am.nSoundSampleRate = nSampleRate;
+    }
+
+    // queues every graphic and sound in a bundle built by olcBundle, each mapped to
+    // its name in the bundle, e.g. "gfx/space.png". Uncompressed payloads are used
+    // straight from the mapping; compressed ones are decompressed on the workers
+    static void LoadBundle(const std::string& path)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._loadBundle(path);
+    }
+
+    // uploads graphics which have finished decoding, at most nMaxUploads of them, so
+    // a level can stream in over a few frames. Returns the number still loading.
+    // Call once per frame from the engine thread, e.g. at the top of OnUserUpdate
+    static size_t ProcessLoads(size_t nMaxUploads = SIZE_MAX)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        return am._processLoads(nMaxUploads);
+    }
+
+    // watches the files behind every graphic and sound loaded from disk, and reloads
+    // them when they change. Swaps happen in ProcessLoads(), which must be called
+    static void EnableHotReload(bool enable = true)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._enableHotReload(enable);
+    }
+
+    // decodes the file behind a graphic or sound again, and swaps it in at the next
+    // ProcessLoads(). A failed decode leaves the old asset in place
+    static void ReloadGraphic(AssetID id)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._reloadGraphic(am._findGraphic(id));
+    }
+
+    static void ReloadSound(AssetID id)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._reloadSound(am._findSound(id));
+    }
+
+    // packs every graphic loaded since the last call into a texture atlas of pages up
+    // to nPageSize square. Graphics too big for a page keep their own decal
+    static void BuildAtlas(int32_t nPageSize = 2048, bool filter = false)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._buildAtlas(nPageSize, filter);
+    }
+
+    // blocks until everything queued so far is loaded and uploaded
+    static void WaitForLoads()
+    {
+        AssetManager& am = AssetManager::getInstance();
+        am._waitForLoads();
+    }
+
+    // get a handle to the graphic of the provided key, without waiting for it
+    static GraphicHandle GetGraphicHandle(AssetID id)
     {
         AssetManager& am = AssetManager::getInstance();
-        am._loadGraphic(key, path);
+        return GraphicHandle(am._findGraphic(id));
     }
-    
-    // loads a sound from the provided file path, maps it to the provided key
-    static void LoadSound(const std::string& key, const std::string& path)
+
+    // get a handle to the sound of the provided key, without waiting for it
+    static SoundHandle GetSoundHandle(AssetID id)
     {
         AssetManager& am = AssetManager::getInstance();
-        am._loadSound(key, path);
+        return SoundHandle(am._findSound(id));
     }
 
     // get the decal of the provided key
-    static olc::Decal* GetDecal(const std::string& key)
+    static olc::Decal* GetDecal(AssetID id)
     {
         AssetManager& am = AssetManager::getInstance();
-        return am._getGraphic(key)->Decal();
+        return am._getGraphicEntry(id)->decal;
     }
-    
+
     // get the sprite of the provided key
-    static olc::Sprite* GetSprite(const std::string& key)
+    static olc::Sprite* GetSprite(AssetID id)
+    {
+        AssetManager& am = AssetManager::getInstance();
+        return am._getGraphicEntry(id)->sprite;
+    }
+
+    // get where the graphic of the provided key can be drawn from, for DrawPartialDecal()
+    static const olc::AtlasRegion& GetRegion(AssetID id)
     {
         AssetManager& am = AssetManager::getInstance();
-        return am._getGraphic(key)->Sprite();
+        return am._getGraphicEntry(id)->region;
     }
 
     // get the olc::Renderable of the provided key
-    static olc::Renderable* GetRenderable(const std::string& key)
+    static olc::Renderable* GetRenderable(AssetID id)
     {
         AssetManager& am = AssetManager::getInstance();
-        return am._getGraphic(key);
+        return am._getGraphic(id);
     }
 
     // get the olc::sound::Wave of the provided key
-    static olc::sound::Wave* GetSound(const std::string& key)
+    static olc::sound::Wave* GetSound(AssetID id)
     {
         AssetManager& am = AssetManager::getInstance();
-        return am._getSound(key);
+        return am._getSound(id);
     }
 
 public: // Non-static methods
-    olc::Renderable* _getGraphic(const std::string& key);
-    olc::sound::Wave* _getSound(const std::string& key);
-    void _loadGraphic(const std::string& key, const std::string& path);
-    void _loadSound(const std::string& key, const std::string& path);
+    olc::Renderable* _getGraphic(AssetID id);
+    olc::sound::Wave* _getSound(AssetID id);
+    GraphicHandle _loadGraphic(const std::string& key, const std::string& path);
+    SoundHandle _loadSound(const std::string& key, const std::string& path);
+    void _loadBundle(const std::string& path);
+    size_t _processLoads(size_t nMaxUploads);
+    void _waitForLoads();
+    void _enableHotReload(bool enable);
+    void _buildAtlas(int32_t nPageSize, bool filter);
+    void _setTextureCache(const std::string& dir, uint64_t nMaxBytes);
+
+private: // Non-static methods
+    GraphicEntry* _findGraphic(AssetID id) const
+    {
+        GraphicEntry* entry = tGraphics.Find(id);
+        assert(entry != nullptr);
+        return entry;
+    }
+
+    SoundEntry* _findSound(AssetID id) const
+    {
+        SoundEntry* entry = tSounds.Find(id);
+        assert(entry != nullptr);
+        return entry;
+    }
+
+    // the entry of a graphic which has been uploaded, resolving it if need be
+    GraphicEntry* _getGraphicEntry(AssetID id);
+
+    olc::Renderable* _resolveGraphic(GraphicEntry* entry);
+    olc::sound::Wave* _resolveSound(SoundEntry* entry);
+    void _checkNewKey(const std::string& key, const std::string* existing);
+    std::string _checkFile(const std::string& path);
+    GraphicHandle _addGraphic(const std::string& key, const std::string& path, std::function<std::unique_ptr<olc::Sprite>()> decode);
+    SoundHandle _addSound(const std::string& key, const std::string& path, std::function<std::unique_ptr<olc::sound::Wave>()> decode);
+    void _reloadGraphic(GraphicEntry* entry);
+    void _reloadSound(SoundEntry* entry);
+    void _processReloads();
+    void _watchFile(const std::string& file);
+    void _watcherThread();
+    void _queueJob(std::function<void()> job);
+    void _workerThread();
+    // decodes the graphic at path, or maps the copy in cacheDir decoded by an earlier run
+    static std::unique_ptr<olc::Sprite> _loadCachedSprite(const std::string& path, const std::string& cacheDir);
+    static uint64_t _hashContent(const uint8_t* data, size_t size);
+    // converts a decoded sample to the device rate ahead of playing it, see SetSoundSampleRate()
+    static std::unique_ptr<olc::sound::Wave> _prepareSound(std::unique_ptr<olc::sound::Wave> sample, uint32_t nSampleRate);
 
 private: // Non-static properties
-    std::map<std::string, olc::sound::Wave*> mSounds;
-    std::map<std::string, olc::Renderable*> mGraphics;
+    struct GraphicEntry
+    {
+        std::string key;
+        std::string path;
+        // filled in by a worker, collected once by the engine thread
+        std::future<std::unique_ptr<olc::Sprite>> decoded;
+        // created on the engine thread once the decode has been collected
+        std::unique_ptr<olc::Renderable> graphic;
+        olc::Decal* decal = nullptr;
+        olc::Sprite* sprite = nullptr;
+        // in an atlas page, or the whole of decal
+        olc::AtlasRegion region;
+        olc::TextureAtlas* atlas = nullptr;
+        size_t atlasIndex = 0;
+
+        // the file on disk, canonical, and how to decode it again
+        std::string file;
+        std::function<std::unique_ptr<olc::Sprite>()> decode;
+        std::future<std::unique_ptr<olc::Sprite>> reloaded;
+        bool reloadAgain = false;
+    };
+
+    struct SoundEntry
+    {
+        std::string key;
+        std::string path;
+        std::shared_future<std::unique_ptr<olc::sound::Wave>> decoded;
+        // cached once the future has been waited on successfully
+        std::atomic<olc::sound::Wave*> sample{ nullptr };
+        // bumped by every reload, so handles know to fetch the new sample
+        std::atomic<uint32_t> version{ 0 };
+
+        std::string file;
+        std::function<std::unique_ptr<olc::sound::Wave>()> decode;
+        std::future<std::unique_ptr<olc::sound::Wave>> reloaded;
+        bool reloadAgain = false;
+        // reloaded samples, the current one last. Older ones are freed by ProcessLoads()
+        // once no voice is playing them
+        std::vector<std::unique_ptr<olc::sound::Wave>> vVersions;
+    };
+
+    // entries own the assets, the tables are for lookup
+    std::vector<std::unique_ptr<SoundEntry>> vSounds;
+    std::vector<std::unique_ptr<GraphicEntry>> vGraphics;
+    AssetTable<SoundEntry> tSounds;
+    AssetTable<GraphicEntry> tGraphics;
+    // graphics whose decal has yet to be created, oldest first
+    std::vector<GraphicEntry*> vPendingGraphics;
+    // kept open for as long as anything might be mapped from them
+    std::vector<std::shared_ptr<olc::AssetBundle>> vBundles;
+    std::vector<std::unique_ptr<olc::TextureAtlas>> vAtlases;
+    // where decoded graphics are cached, empty for nowhere
+    std::string sTextureCache;
+    // the rate sounds are resampled to as they load, 0 for not at all
+    uint32_t nSoundSampleRate = 0;
+    // entries with a reload in flight
+    std::vector<GraphicEntry*> vReloadingGraphics;
+    std::vector<SoundEntry*> vReloadingSounds;
+    // sounds holding superseded samples that voices may still be playing
+    std::vector<SoundEntry*> vRetiringSounds;
+
+    // file watching. The watcher thread only reports changed files; everything else
+    // happens on the engine thread
+    std::thread thWatcher;
+    std::atomic<bool> bWatching{ false };
+    std::mutex muxWatch;
+    std::map<std::string, std::filesystem::file_time_type> mWatchedFiles;
+    std::vector<std::string> vChangedFiles;
+
+    // worker pool, started on the first load
+    std::vector<std::thread> vWorkers;
+    std::deque<std::function<void()>> qJobs;
+    std::mutex muxJobs;
+    std::condition_variable cvJobs;
+    bool bQuit = false;
 
 }; // AssetManager
 
 #ifdef ASSET_MANAGER_IMPLEMENTATION
 #undef ASSET_MANAGER_IMPLEMENTATION
 
+#if defined(__linux__)
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #define ASSET_MANAGER_INOTIFY
+#endif
+
 AssetManager::AssetManager()
 { }
 
 AssetManager::~AssetManager()
 {
-    for(auto & g : mGraphics) delete g.second;
-    for(auto & s : mSounds)   delete s.second;
-    
-    mGraphics.clear();
-    mSounds.clear();
+    _enableHotReload(false);
+
+    {
+        std::unique_lock<std::mutex> lock(muxJobs);
+        bQuit = true;
+        qJobs.clear();
+    }
+    cvJobs.notify_all();
+    for(auto & w : vWorkers) w.join();
+
+    vPendingGraphics.clear();
+    vGraphics.clear();
+    vSounds.clear();
 }
 
-olc::Renderable* AssetManager::_getGraphic(const std::string& key)
+bool AssetManager::GraphicHandle::IsReady() const
 {
-    
-    assert(mGraphics.find(key) != mGraphics.end());
+    return entry != nullptr && entry->graphic != nullptr;
+}
 
-    return mGraphics[key];
+void AssetManager::GraphicHandle::Resolve() const
+{
+    assert(entry != nullptr);
+    graphic = AssetManager::getInstance()._resolveGraphic(entry);
+    decal = entry->decal;
+    sprite = entry->sprite;
 }
 
-olc::sound::Wave* AssetManager::_getSound(const std::string& key)
+const olc::AtlasRegion& AssetManager::GraphicHandle::Region() const
 {
-    assert(mSounds.find(key) != mSounds.end());
+    if(graphic == nullptr) Resolve();
+    return entry->region;
+}
 
-    return mSounds[key];
+bool AssetManager::SoundHandle::IsReady() const
+{
+    return entry != nullptr && entry->decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
 }
 
-void AssetManager::_loadGraphic(const std::string& key, const std::string& path)
+void AssetManager::SoundHandle::Resolve() const
 {
-    // ensure we have actually set a key and path
-    assert(!key.empty() && !path.empty());
-    
-    // check if the provided key already exists!
-    if(mGraphics.find(key) != mGraphics.end())
-    {
-        std::cout << "AssetManager: attempted to use an a key <" << key << "> that already existed." << std::endl;
-        exit(EXIT_FAILURE);
-    }
+    assert(entry != nullptr);
+    version = entry->version.load(std::memory_order_acquire);
+    sample = entry->sample.load(std::memory_order_acquire);
+    if(sample == nullptr) sample = AssetManager::getInstance()._resolveSound(entry);
+}
 
-    // ensure the file exists and is readable
-    std::filesystem::path assetPath = std::filesystem::weakly_canonical(std::filesystem::absolute(path));
-    if(!(std::filesystem::exists(assetPath) && std::filesystem::is_regular_file(assetPath)))
+AssetManager::GraphicEntry* AssetManager::_getGraphicEntry(AssetID id)
+{
+    GraphicEntry* entry = _findGraphic(id);
+    if(entry->graphic == nullptr) _resolveGraphic(entry);
+    return entry;
+}
+
+olc::Renderable* AssetManager::_getGraphic(AssetID id)
+{
+    return _getGraphicEntry(id)->graphic.get();
+}
+
+olc::sound::Wave* AssetManager::_getSound(AssetID id)
+{
+    SoundEntry* entry = _findSound(id);
+    olc::sound::Wave* sample = entry->sample.load(std::memory_order_acquire);
+    return sample != nullptr ? sample : _resolveSound(entry);
+}
+
+olc::Renderable* AssetManager::_resolveGraphic(GraphicEntry* entry)
+{
+    if(entry->graphic) return entry->graphic.get();
+
+    // waits here if the worker has not got to it yet
+    std::unique_ptr<olc::Sprite> sprite = entry->decoded.get();
+    if(sprite == nullptr)
     {
-        std::cout << "AssetManager: attempted to load file <" << path << "> which does not exist." << std::endl;
+        std::cout << "AssetManager: attempted to load sprite <" << entry->path << ">, and something went wrong, is it a valid PNG file?" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    olc::Renderable* graphic = new olc::Renderable();
-    graphic->Load(path);
-    
-    if(graphic->Sprite() == nullptr || graphic->Decal() == nullptr)
+    entry->graphic = std::make_unique<olc::Renderable>();
+    entry->graphic->Create(std::move(sprite));
+    entry->decal = entry->graphic->Decal();
+    entry->sprite = entry->graphic->Sprite();
+    entry->region = { entry->decal, { 0.0f, 0.0f }, olc::vf2d(entry->sprite->Size()), -1 };
+
+    return entry->graphic.get();
+}
+
+olc::sound::Wave* AssetManager::_resolveSound(SoundEntry* entry)
+{
+    olc::sound::Wave* sample = entry->decoded.get().get();
+    if(sample == nullptr)
     {
-        std::cout << "AssetManager: attempted to load sprite <" << path << ">, and something went wrong, is it a valid PNG file?" << std::endl;
+        std::cout << "AssetManager: attempted to load sound <" << entry->path << ">, and something went wrong, is it a valid WAV file?" << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    mGraphics[key] = graphic;
+    entry->sample.store(sample, std::memory_order_release);
+    return sample;
 }
 
-void AssetManager::_loadSound(const std::string& key, const std::string& path)
+void AssetManager::_checkNewKey(const std::string& key, const std::string* existing)
 {
-    // ensure we have actually set a key and path
-    assert(!key.empty() && !path.empty());
-    
+    // ensure we have actually set a key
+    assert(!key.empty());
+
     // check if the provided key already exists!
-    if(mSounds.find(key) != mSounds.end())
+    if(existing != nullptr && *existing == key)
     {
         std::cout << "AssetManager: attempted to use an a key <" << key << "> that already existed." << std::endl;
         exit(EXIT_FAILURE);
     }
 
+    // two keys hashing to the same AssetID would silently alias, so refuse them
+    if(existing != nullptr)
+    {
+        std::cout << "AssetManager: the key <" << key << "> has the same hash as <" << *existing << ">, rename one of them." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+std::string AssetManager::_checkFile(const std::string& path)
+{
+    assert(!path.empty());
+
     // ensure the file exists and is readable
     std::filesystem::path assetPath = std::filesystem::weakly_canonical(std::filesystem::absolute(path));
     if(!(std::filesystem::exists(assetPath) && std::filesystem::is_regular_file(assetPath)))
@@ -161,17 +633,588 @@ void AssetManager::_loadSound(const std::string& key, const std::string& path)
         exit(EXIT_FAILURE);
     }
 
-    olc::sound::Wave* sample = new olc::sound::Wave(path);
+    return assetPath.string();
+}
 
-    if(sample == nullptr)
+AssetManager::GraphicHandle AssetManager::_addGraphic(const std::string& key, const std::string& path, std::function<std::unique_ptr<olc::Sprite>()> decode)
+{
+    const AssetID id(key);
+    const GraphicEntry* existing = tGraphics.Find(id);
+    _checkNewKey(key, existing != nullptr ? &existing->key : nullptr);
+
+    auto task = std::make_shared<std::packaged_task<std::unique_ptr<olc::Sprite>()>>(decode);
+
+    auto entry = std::make_unique<GraphicEntry>();
+    entry->key = key;
+    entry->path = path;
+    entry->decode = std::move(decode);
+    entry->decoded = task->get_future();
+
+    GraphicEntry* pEntry = entry.get();
+    vGraphics.push_back(std::move(entry));
+    tGraphics.Insert(id, pEntry);
+    vPendingGraphics.push_back(pEntry);
+
+    _queueJob([task]() { (*task)(); });
+    return GraphicHandle(pEntry);
+}
+
+AssetManager::SoundHandle AssetManager::_addSound(const std::string& key, const std::string& path, std::function<std::unique_ptr<olc::sound::Wave>()> decode)
+{
+    const AssetID id(key);
+    const SoundEntry* existing = tSounds.Find(id);
+    _checkNewKey(key, existing != nullptr ? &existing->key : nullptr);
+
+    auto task = std::make_shared<std::packaged_task<std::unique_ptr<olc::sound::Wave>()>>(decode);
+
+    auto entry = std::make_unique<SoundEntry>();
+    entry->key = key;
+    entry->path = path;
+    entry->decode = std::move(decode);
+    entry->decoded = task->get_future().share();
+
+    SoundEntry* pEntry = entry.get();
+    vSounds.push_back(std::move(entry));
+    tSounds.Insert(id, pEntry);
+
+    _queueJob([task]() { (*task)(); });
+    return SoundHandle(pEntry);
+}
+
+AssetManager::GraphicHandle AssetManager::_loadGraphic(const std::string& key, const std::string& path)
+{
+    const std::string file = _checkFile(path);
+
+    // decoding the PNG is CPU only, so it can happen on any thread
+    GraphicHandle handle = _addGraphic(key, path, [path, cacheDir = sTextureCache]()
+    {
+        if(!cacheDir.empty()) return _loadCachedSprite(path, cacheDir);
+        auto sprite = std::make_unique<olc::Sprite>();
+        if(sprite->LoadFromFile(path) != olc::rcode::OK) sprite.reset();
+        return sprite;
+    });
+
+    handle.entry->file = file;
+    _watchFile(file);
+    return handle;
+}
+
+AssetManager::SoundHandle AssetManager::_loadSound(const std::string& key, const std::string& path)
+{
+    const std::string file = _checkFile(path);
+
+    SoundHandle handle = _addSound(key, path, [path, sampleRate = nSoundSampleRate]()
     {
-        std::cout << "AssetManager: attempted to load sound <" << path << ">, and something went wrong, is it a valid WAV file?" << std::endl;
+        auto sample = std::make_unique<olc::sound::Wave>(path);
+        if(sample->vChannelView.empty()) sample.reset();
+        return _prepareSound(std::move(sample), sampleRate);
+    });
+
+    handle.entry->file = file;
+    _watchFile(file);
+    return handle;
+}
+
+void AssetManager::_loadBundle(const std::string& path)
+{
+    _checkFile(path);
+
+    std::shared_ptr<olc::AssetBundle> bundle = olc::AssetBundle::Open(path);
+    if(bundle == nullptr)
+    {
+        std::cout << "AssetManager: attempted to load bundle <" << path << ">, and something went wrong, was it built by olcBundle?" << std::endl;
         exit(EXIT_FAILURE);
     }
-    
-    mSounds[key] = sample;
+    vBundles.push_back(bundle);
+
+    for(size_t i = 0; i < bundle->size(); i++)
+    {
+        const olc::BundleEntry* e = &(*bundle)[i];
+        const std::string key = bundle->Name(*e);
+
+        // the decoders own a reference to the bundle, and entries live in its mapping
+        if(e->nType == olc::BundleEntry::IMAGE)
+        {
+            _addGraphic(key, path + ":" + key, [bundle, e]()
+            {
+                const int32_t w = int32_t(e->nParam[0]), h = int32_t(e->nParam[1]);
+                const size_t nPixels = size_t(w) * size_t(h);
+                std::unique_ptr<olc::Sprite> sprite;
+                if(e->nSize != nPixels * sizeof(olc::Pixel)) return sprite;
+
+                if(e->nCompression == olc::BundleEntry::NONE)
+                {
+                    sprite = std::make_unique<olc::Sprite>();
+                    sprite->width = w;
+                    sprite->height = h;
+                    sprite->pColData.Map(bundle->Mapping(), size_t(e->nOffset), nPixels);
+                }
+                else
+                {
+                    sprite = std::make_unique<olc::Sprite>(w, h);
+                    if(!bundle->Read(*e, sprite->GetData())) sprite.reset();
+                }
+                return sprite;
+            });
+        }
+        else if(e->nType == olc::BundleEntry::WAVE)
+        {
+            _addSound(key, path + ":" + key, [bundle, e, sampleRate = nSoundSampleRate]()
+            {
+                const size_t nChannels = e->nParam[0], nSampleRate = e->nParam[1], nSamples = e->nParam[2];
+                std::unique_ptr<olc::sound::Wave> sample;
+                if(e->nSize != nChannels * nSamples * sizeof(float)) return sample;
+
+                olc::sound::wave::File<float> file;
+                if(e->nCompression == olc::BundleEntry::NONE)
+                {
+                    if(!file.MapData(bundle->Mapping(), size_t(e->nOffset), nChannels, nSampleRate, nSamples)) return sample;
+                }
+                else
+                {
+                    file = olc::sound::wave::File<float>(nChannels, sizeof(float), nSampleRate, nSamples);
+                    if(!bundle->Read(*e, file.data())) return sample;
+                }
+
+                sample = std::make_unique<olc::sound::Wave>();
+                if(!sample->LoadAudioWaveform(std::move(file))) sample.reset();
+                return _prepareSound(std::move(sample), sampleRate);
+            });
+        }
+    }
+}
+
+std::unique_ptr<olc::sound::Wave> AssetManager::_prepareSound(std::unique_ptr<olc::sound::Wave> sample, uint32_t nSampleRate)
+{
+    // the copy is cached inside the wave, which only reaches the engine thread through the
+    // decode future, so the one thread rule of Wave::Resampled() holds
+    if(sample != nullptr && nSampleRate != 0) sample->Resampled(nSampleRate);
+    return sample;
+}
+
+size_t AssetManager::_processLoads(size_t nMaxUploads)
+{
+    _processReloads();
+
+    size_t nUploaded = 0;
+    auto it = vPendingGraphics.begin();
+    while(it != vPendingGraphics.end())
+    {
+        GraphicEntry* entry = *it;
+        if(entry->graphic)
+        {
+            // already resolved on demand
+            it = vPendingGraphics.erase(it);
+        }
+        else if(nUploaded < nMaxUploads && entry->decoded.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            _resolveGraphic(entry);
+            nUploaded++;
+            it = vPendingGraphics.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    size_t nLoading = vPendingGraphics.size();
+    for(auto & s : vSounds)
+        if(s->sample.load(std::memory_order_acquire) == nullptr
+            && s->decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            nLoading++;
+
+    return nLoading;
+}
+
+void AssetManager::_waitForLoads()
+{
+    for(auto* entry : vPendingGraphics) _resolveGraphic(entry);
+    vPendingGraphics.clear();
+
+    for(auto & s : vSounds)
+        if(s->sample.load(std::memory_order_acquire) == nullptr)
+            _resolveSound(s.get());
+}
+
+void AssetManager::_reloadGraphic(GraphicEntry* entry)
+{
+    // not uploaded yet, so there is nothing to replace
+    if(entry->graphic == nullptr || !entry->decode) return;
+
+    // a reload is already running, it may have read the file before this change
+    if(entry->reloaded.valid())
+    {
+        entry->reloadAgain = true;
+        return;
+    }
+
+    auto task = std::make_shared<std::packaged_task<std::unique_ptr<olc::Sprite>()>>(entry->decode);
+    entry->reloaded = task->get_future();
+    vReloadingGraphics.push_back(entry);
+    _queueJob([task]() { (*task)(); });
+}
+
+void AssetManager::_reloadSound(SoundEntry* entry)
+{
+    if(entry->sample.load(std::memory_order_acquire) == nullptr || !entry->decode) return;
+
+    if(entry->reloaded.valid())
+    {
+        entry->reloadAgain = true;
+        return;
+    }
+
+    auto task = std::make_shared<std::packaged_task<std::unique_ptr<olc::sound::Wave>()>>(entry->decode);
+    entry->reloaded = task->get_future();
+    vReloadingSounds.push_back(entry);
+    _queueJob([task]() { (*task)(); });
+}
+
+void AssetManager::_processReloads()
+{
+    std::vector<std::string> vChanged;
+    {
+        std::unique_lock<std::mutex> lock(muxWatch);
+        vChanged.swap(vChangedFiles);
+    }
+
+    for(auto & file : vChanged)
+    {
+        for(auto & g : vGraphics) if(g->file == file) _reloadGraphic(g.get());
+        for(auto & s : vSounds) if(s->file == file) _reloadSound(s.get());
+    }
+
+    auto ready = [](auto& future) { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+
+    for(size_t i = 0; i < vReloadingGraphics.size(); )
+    {
+        GraphicEntry* entry = vReloadingGraphics[i];
+        if(!ready(entry->reloaded)) { i++; continue; }
+
+        std::unique_ptr<olc::Sprite> sprite = entry->reloaded.get();
+        if(sprite == nullptr)
+        {
+            std::cout << "AssetManager: reloading sprite <" << entry->path << "> failed, keeping the old one." << std::endl;
+        }
+        else
+        {
+            // same Sprite and Decal objects, so every pointer handed out stays valid, and
+            // only this one texture is uploaded again (Update() copes with a new size)
+            entry->sprite->width = sprite->width;
+            entry->sprite->height = sprite->height;
+            entry->sprite->pColData = std::move(sprite->pColData);
+            entry->decal->Update();
+
+            // a graphic that changed size no longer fits its slot, so draws from its own decal
+            if(entry->atlas != nullptr && !entry->atlas->Update(entry->atlasIndex, entry->sprite))
+                entry->atlas = nullptr;
+            if(entry->atlas == nullptr)
+                entry->region = { entry->decal, { 0.0f, 0.0f }, olc::vf2d(entry->sprite->Size()), -1 };
+        }
+
+        vReloadingGraphics.erase(vReloadingGraphics.begin() + i);
+        if(entry->reloadAgain)
+        {
+            entry->reloadAgain = false;
+            _reloadGraphic(entry);
+        }
+    }
+
+    for(size_t i = 0; i < vReloadingSounds.size(); )
+    {
+        SoundEntry* entry = vReloadingSounds[i];
+        if(!ready(entry->reloaded)) { i++; continue; }
+
+        std::unique_ptr<olc::sound::Wave> sample = entry->reloaded.get();
+        if(sample == nullptr)
+        {
+            std::cout << "AssetManager: reloading sound <" << entry->path << "> failed, keeping the old one." << std::endl;
+        }
+        else
+        {
+            // the mixer may be part way through the old sample, so it is swapped, not overwritten
+            entry->vVersions.push_back(std::move(sample));
+            entry->sample.store(entry->vVersions.back().get(), std::memory_order_release);
+            entry->version.fetch_add(1, std::memory_order_release);
+            if(entry->vVersions.size() > 1 &&
+                std::find(vRetiringSounds.begin(), vRetiringSounds.end(), entry) == vRetiringSounds.end())
+                vRetiringSounds.push_back(entry);
+        }
+
+        vReloadingSounds.erase(vReloadingSounds.begin() + i);
+        if(entry->reloadAgain)
+        {
+            entry->reloadAgain = false;
+            _reloadSound(entry);
+        }
+    }
+
+    // superseded samples, and the copies resampled from them, go once their voices finish.
+    // The very first sample belongs to the decode future, so stays with the entry
+    for(size_t i = 0; i < vRetiringSounds.size(); )
+    {
+        auto& versions = vRetiringSounds[i]->vVersions;
+        versions.erase(std::remove_if(versions.begin(), versions.end() - 1,
+            [](const std::unique_ptr<olc::sound::Wave>& w) { return !w->IsPlaying(); }), versions.end() - 1);
+
+        if(versions.size() == 1) vRetiringSounds.erase(vRetiringSounds.begin() + i);
+        else i++;
+    }
+}
+
+void AssetManager::_setTextureCache(const std::string& dir, uint64_t nMaxBytes)
+{
+    sTextureCache.clear();
+    if(dir.empty()) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if(!std::filesystem::is_directory(dir, ec))
+    {
+        std::cout << "AssetManager: cannot use <" << dir << "> as a texture cache, graphics will not be cached." << std::endl;
+        return;
+    }
+    sTextureCache = dir;
+
+    // hits touch their file, so the oldest are copies of graphics since edited or no longer
+    // used. Files still mapped elsewhere may refuse to go, which is fine, they go next time
+    struct CachedFile { std::filesystem::path path; std::filesystem::file_time_type time; uintmax_t size; };
+    std::vector<CachedFile> vFiles;
+    uintmax_t nTotal = 0;
+    for(const auto& e : std::filesystem::directory_iterator(dir, ec))
+    {
+        if(!e.is_regular_file(ec) || e.path().extension() != ".rgba") continue;
+        vFiles.push_back({ e.path(), e.last_write_time(ec), e.file_size(ec) });
+        nTotal += vFiles.back().size;
+    }
+
+    std::sort(vFiles.begin(), vFiles.end(), [](const CachedFile& a, const CachedFile& b) { return a.time < b.time; });
+    for(size_t i = 0; i < vFiles.size() && nTotal > nMaxBytes; i++)
+        if(std::filesystem::remove(vFiles[i].path, ec)) nTotal -= vFiles[i].size;
+}
+
+uint64_t AssetManager::_hashContent(const uint8_t* data, size_t size)
+{
+    // this only names cache files, so it needs to be quick more than strong: a word at a time,
+    // each mixed in with a multiply and a shift
+    constexpr uint64_t nMul = 0xff51afd7ed558ccdull;
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ size;
+    size_t i = 0;
+    for(; i + 8 <= size; i += 8)
+    {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        h = (h ^ w) * nMul;
+        h ^= h >> 32;
+    }
+    for(; i < size; i++)
+        h = (h ^ data[i]) * nMul;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    return h ^ (h >> 33);
+}
+
+std::unique_ptr<olc::Sprite> AssetManager::_loadCachedSprite(const std::string& path, const std::string& cacheDir)
+{
+    auto sprite = std::make_unique<olc::Sprite>();
+
+    // already raw, so there's nothing to cache. This is the only raw probe of the source,
+    // a miss below goes straight to the image loader
+    if(sprite->LoadFromRawFile(path) == olc::rcode::OK) return sprite;
+
+    std::shared_ptr<olc::MappedFile> source = olc::MappedFile::Open(path);
+    if(!source) return nullptr;
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-%llx.rgba",
+        (unsigned long long)_hashContent(source->data(), source->size()), (unsigned long long)source->size());
+    const std::filesystem::path cached = std::filesystem::path(cacheDir) / name;
+    source.reset();
+
+    std::error_code ec;
+    if(sprite->LoadFromRawFile(cached.string()) == olc::rcode::OK)
+    {
+        std::filesystem::last_write_time(cached, std::filesystem::file_time_type::clock::now(), ec);
+        return sprite;
+    }
+
+    if(olc::Sprite::loader == nullptr || olc::Sprite::loader->LoadImageResource(sprite.get(), path, nullptr) != olc::rcode::OK)
+        return nullptr;
+
+    // written under a name of its own and renamed into place, so nobody, this process or
+    // another, ever maps half a file. Failing to cache just means decoding again next time
+    const std::filesystem::path temp = cached.string() + ".tmp" +
+        std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+            uint64_t(std::chrono::steady_clock::now().time_since_epoch().count()));
+    if(sprite->SaveToRawFile(temp.string()) == olc::rcode::OK)
+        std::filesystem::rename(temp, cached, ec);
+    std::filesystem::remove(temp, ec);
+    return sprite;
+}
+
+void AssetManager::_buildAtlas(int32_t nPageSize, bool filter)
+{
+    // graphics have to be decoded before they can be packed
+    for(auto* entry : vPendingGraphics) _resolveGraphic(entry);
+    vPendingGraphics.clear();
+
+    auto atlas = std::make_unique<olc::TextureAtlas>(nPageSize);
+    std::vector<GraphicEntry*> vPacked;
+    for(auto & g : vGraphics)
+    {
+        if(g->atlas != nullptr) continue;
+        atlas->Add(g->sprite);
+        vPacked.push_back(g.get());
+    }
+    if(vPacked.empty()) return;
+
+    atlas->Build(filter);
+    for(size_t i = 0; i < vPacked.size(); i++)
+    {
+        const olc::AtlasRegion& r = atlas->Region(i);
+        if(r.decal == nullptr) continue;
+        vPacked[i]->region = r;
+        vPacked[i]->atlas = atlas.get();
+        vPacked[i]->atlasIndex = i;
+    }
+    vAtlases.push_back(std::move(atlas));
+}
+
+void AssetManager::_watchFile(const std::string& file)
+{
+    std::error_code ec;
+    const auto time = std::filesystem::last_write_time(file, ec);
+
+    std::unique_lock<std::mutex> lock(muxWatch);
+    mWatchedFiles[file] = time;
+}
+
+void AssetManager::_enableHotReload(bool enable)
+{
+    if(enable == bWatching.load()) return;
+
+    bWatching = enable;
+    if(enable)
+        thWatcher = std::thread(&AssetManager::_watcherThread, this);
+    else if(thWatcher.joinable())
+        thWatcher.join();
+}
+
+void AssetManager::_watcherThread()
+{
+    auto changed = [this](const std::string& file)
+    {
+        std::unique_lock<std::mutex> lock(muxWatch);
+        auto it = mWatchedFiles.find(file);
+        if(it == mWatchedFiles.end()) return;
+
+        std::error_code ec;
+        it->second = std::filesystem::last_write_time(file, ec);
+        if(std::find(vChangedFiles.begin(), vChangedFiles.end(), file) == vChangedFiles.end())
+            vChangedFiles.push_back(file);
+    };
+
+#if defined(ASSET_MANAGER_INOTIFY)
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd >= 0)
+    {
+        // directories rather than files are watched, as editors often save by
+        // writing a new file and renaming it over the old one
+        std::map<int, std::string> mDirs;
+        size_t nFilesSeen = SIZE_MAX;
+        alignas(inotify_event) char buffer[4096];
+
+        while(bWatching)
+        {
+            {
+                std::unique_lock<std::mutex> lock(muxWatch);
+                if(nFilesSeen != mWatchedFiles.size())
+                {
+                    nFilesSeen = mWatchedFiles.size();
+                    for(auto & f : mWatchedFiles)
+                    {
+                        const std::string dir = std::filesystem::path(f.first).parent_path().string();
+                        const int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+                        if(wd >= 0) mDirs[wd] = dir;
+                    }
+                }
+            }
+
+            // wakes up now and then to notice new files, and being switched off
+            pollfd pfd = { fd, POLLIN, 0 };
+            if(poll(&pfd, 1, 250) <= 0) continue;
+
+            ssize_t nBytes;
+            while((nBytes = read(fd, buffer, sizeof(buffer))) > 0)
+            {
+                for(char* p = buffer; p < buffer + nBytes; )
+                {
+                    const inotify_event* ev = reinterpret_cast<const inotify_event*>(p);
+                    auto it = mDirs.find(ev->wd);
+                    if(ev->len > 0 && it != mDirs.end())
+                        changed((std::filesystem::path(it->second) / ev->name).string());
+                    p += sizeof(inotify_event) + ev->len;
+                }
+            }
+        }
+
+        close(fd);
+        return;
+    }
+#endif
+
+    // no inotify, so poll the modification times instead
+    while(bWatching)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        std::vector<std::pair<std::string, std::filesystem::file_time_type>> vFiles;
+        {
+            std::unique_lock<std::mutex> lock(muxWatch);
+            vFiles.assign(mWatchedFiles.begin(), mWatchedFiles.end());
+        }
+
+        for(auto & f : vFiles)
+        {
+            std::error_code ec;
+            const auto time = std::filesystem::last_write_time(f.first, ec);
+            if(!ec && time != f.second) changed(f.first);
+        }
+    }
+}
+
+void AssetManager::_queueJob(std::function<void()> job)
+{
+    {
+        std::unique_lock<std::mutex> lock(muxJobs);
+        if(vWorkers.empty())
+        {
+            // leave a core for the engine thread, which has decals to create
+            const unsigned int nCores = std::thread::hardware_concurrency();
+            const unsigned int nWorkers = std::max(1u, std::min(8u, nCores > 1 ? nCores - 1 : 1u));
+            for(unsigned int i = 0; i < nWorkers; i++)
+                vWorkers.emplace_back(&AssetManager::_workerThread, this);
+        }
+        qJobs.push_back(std::move(job));
+    }
+    cvJobs.notify_one();
+}
+
+void AssetManager::_workerThread()
+{
+    for(;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(muxJobs);
+            cvJobs.wait(lock, [this]() { return bQuit || !qJobs.empty(); });
+            if(bQuit) return;
+            job = std::move(qJobs.front());
+            qJobs.pop_front();
+        }
+        job();
+    }
 }
 
 #endif // ASSET_MANAGER_IMPLEMENTATION
 
-#endif // ASSET_MANAGER_H
\ No newline at end of file
+#endif // ASSET_MANAGER_H
@@ -0,0 +1,514 @@
+/*
+	olcAssetBundle.h
+
+	+-------------------------------------------------------------+
+	|        Packed, memory mapped asset bundles for PGE & SWE    |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	An asset bundle is a single file holding many assets, already decoded
+	into the form the engines use them in - RGBA pixels for sprites, and
+	interleaved float32 samples for waves - so loading one is a lookup
+	and, at most, a decompress.
+
+	Layout, all little endian:
+
+		BundleHeader                     64 bytes
+		BundleEntry[nEntries]            64 bytes each, sorted by nHash
+		names                            not terminated, see nNameOffset
+		payloads                         each starting on a 64 byte boundary
+
+	Entries are found by a binary search of the index on the 64 bit FNV-1a
+	hash of their name, the same hash AssetManager uses for its AssetIDs.
+	A payload may be stored LZ4 compressed (block format), in which case
+	it is decompressed on load. Uncompressed payloads are used in place
+	from the mapping, with no copy at all.
+
+	The reader holds no state besides the mapping, so any number of
+	threads can Find() and Read() from one bundle at the same time.
+
+	Bundles are built with the olcBundle tool in tools/, or with
+	olc::AssetBundleWriter directly. tools/olcLZ4Check round trips the
+	codec, and checks it against the reference lz4 tool in both directions.
+
+	Usage
+	~~~~~
+	Exactly one translation unit must provide the implementation:
+
+	#define OLC_ASSETBUNDLE
+	#include "olcAssetBundle.h"
+*/
+
+#pragma once
+#ifndef OLC_ASSETBUNDLE_H
+#define OLC_ASSETBUNDLE_H
+
+#include "olcMappedFile.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace olc
+{
+	// O------------------------------------------------------------------------------O
+	// | Bundle file structures                                                       |
+	// O------------------------------------------------------------------------------O
+	struct BundleHeader
+	{
+		char     sMagic[8];
+		uint32_t nVersion;
+		uint32_t nEntries;
+		uint64_t nIndexOffset;
+		uint64_t nNamesOffset;
+		uint64_t nNamesSize;
+		uint8_t  nReserved[24];
+	};
+	static_assert(sizeof(BundleHeader) == 64, "BundleHeader must stay 64 bytes");
+
+	struct BundleEntry
+	{
+		enum Type : uint32_t { RAW = 0, IMAGE = 1, WAVE = 2 };
+		enum Compression : uint32_t { NONE = 0, LZ4 = 1 };
+
+		uint64_t nHash;
+		uint64_t nOffset;      // of the payload, from the start of the file
+		uint64_t nStoredSize;  // bytes in the file
+		uint64_t nSize;        // bytes once decompressed
+		uint32_t nType;
+		uint32_t nCompression;
+		uint32_t nNameOffset;  // into the names block
+		uint32_t nNameLength;
+		// IMAGE: width, height    WAVE: channels, sample rate, samples per channel
+		uint32_t nParam[4];
+	};
+	static_assert(sizeof(BundleEntry) == 64, "BundleEntry must stay 64 bytes");
+
+	namespace lz4
+	{
+		// Worst case size of compressing nSize bytes
+		constexpr size_t Bound(const size_t nSize) { return nSize + nSize / 255 + 16; }
+		// Returns the compressed size, pDst must hold at least Bound(nSrc) bytes
+		size_t Compress(const uint8_t* pSrc, const size_t nSrc, uint8_t* pDst);
+		// Returns false unless pSrc decompresses to exactly nDst bytes
+		bool Decompress(const uint8_t* pSrc, const size_t nSrc, uint8_t* pDst, const size_t nDst);
+	}
+
+	// O------------------------------------------------------------------------------O
+	// | olc::AssetBundle - Read-only, thread safe view of a bundle                   |
+	// O------------------------------------------------------------------------------O
+	class AssetBundle
+	{
+	public:
+		AssetBundle() = default;
+		AssetBundle(const AssetBundle&) = delete;
+		AssetBundle& operator=(const AssetBundle&) = delete;
+
+	public:
+		// Returns nullptr if the file cannot be opened or is not a bundle
+		static std::shared_ptr<AssetBundle> Open(const std::string& sFile);
+
+		// FNV-1a of a name, 0 is never returned
+		static constexpr uint64_t Hash(const char* sName, const size_t nLength)
+		{
+			uint64_t h = 0xcbf29ce484222325ull;
+			for (size_t i = 0; i < nLength; i++)
+			{
+				h ^= uint64_t(uint8_t(sName[i]));
+				h *= 0x100000001b3ull;
+			}
+			return h == 0 ? 1 : h;
+		}
+
+	public:
+		const BundleEntry* Find(const uint64_t nHash) const;
+		const BundleEntry* Find(const std::string& sName) const { return Find(Hash(sName.data(), sName.size())); }
+
+		size_t size() const { return m_nEntries; }
+		const BundleEntry& operator[](const size_t i) const { return m_pEntries[i]; }
+		std::string Name(const BundleEntry& entry) const;
+
+		// The payload in place, only for entries stored uncompressed
+		const uint8_t* Data(const BundleEntry& entry) const;
+		// Copies or decompresses the payload into pDst, which holds entry.nSize bytes
+		bool Read(const BundleEntry& entry, void* pDst) const;
+
+		// For handing to anything that wants to keep the mapping alive, e.g. PixelStore::Map()
+		const std::shared_ptr<olc::MappedFile>& Mapping() const { return m_pFile; }
+
+	private:
+		std::shared_ptr<olc::MappedFile> m_pFile;
+		const BundleEntry* m_pEntries = nullptr;
+		size_t m_nEntries = 0;
+		const char* m_pNames = nullptr;
+		size_t m_nNamesSize = 0;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::AssetBundleWriter - Builds a bundle in memory, then saves it            |
+	// O------------------------------------------------------------------------------O
+	class AssetBundleWriter
+	{
+	public:
+		void AddRaw(const std::string& sName, const void* pData, const size_t nBytes);
+		// nWidth * nHeight RGBA pixels, as olc::Pixel
+		void AddImage(const std::string& sName, const uint32_t nWidth, const uint32_t nHeight, const void* pPixels);
+		// nSamples frames of nChannels interleaved float32 samples
+		void AddWave(const std::string& sName, const uint32_t nChannels, const uint32_t nSampleRate, const uint32_t nSamples, const float* pSamples);
+
+		// Compressed payloads are only kept if they save at least an eighth
+		bool Save(const std::string& sFile, const bool bCompress = true, std::string* pError = nullptr) const;
+
+	private:
+		struct Item
+		{
+			std::string sName;
+			uint32_t nType = 0;
+			uint32_t nParam[4] = { 0, 0, 0, 0 };
+			std::vector<uint8_t> vData;
+		};
+		void Add(Item&& item, const void* pData, const size_t nBytes);
+		std::vector<Item> m_vItems;
+	};
+}
+
+#ifdef OLC_ASSETBUNDLE
+#undef OLC_ASSETBUNDLE
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace olc
+{
+	namespace lz4
+	{
+		static constexpr size_t nMinMatch = 4;
+		static constexpr size_t nLastLiterals = 5;
+		static constexpr size_t nMatchLimit = 12;
+		static constexpr size_t nMaxOffset = 65535;
+		static constexpr int nHashBits = 14;
+
+		static uint32_t Read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+		static uint32_t HashOf(const uint32_t v) { return (v * 2654435761u) >> (32 - nHashBits); }
+
+		static uint8_t* WriteLength(uint8_t* pDst, size_t nLength)
+		{
+			while (nLength >= 255) { *pDst++ = 255; nLength -= 255; }
+			*pDst++ = uint8_t(nLength);
+			return pDst;
+		}
+
+		size_t Compress(const uint8_t* pSrc, const size_t nSrc, uint8_t* pDst)
+		{
+			std::vector<int64_t> vTable(size_t(1) << nHashBits, -1);
+			uint8_t* op = pDst;
+			size_t ip = 0, anchor = 0;
+
+			auto Emit = [&](const size_t nLiterals, const size_t nOffset, const size_t nMatch)
+			{
+				uint8_t* pToken = op++;
+				uint8_t token = uint8_t(std::min<size_t>(nLiterals, 15) << 4);
+				if (nLiterals >= 15) op = WriteLength(op, nLiterals - 15);
+				// An empty source may be a null pointer, which memcpy must never see
+				if (nLiterals > 0) std::memcpy(op, pSrc + anchor, nLiterals);
+				op += nLiterals;
+
+				if (nMatch > 0)
+				{
+					*op++ = uint8_t(nOffset & 0xFF);
+					*op++ = uint8_t(nOffset >> 8);
+					const size_t nExtra = nMatch - nMinMatch;
+					token |= uint8_t(std::min<size_t>(nExtra, 15));
+					if (nExtra >= 15) op = WriteLength(op, nExtra - 15);
+				}
+				*pToken = token;
+			};
+
+			// The format requires the last match to start 12 bytes before the end,
+			// and the last 5 bytes to be literals
+			if (nSrc > nMatchLimit)
+			{
+				const size_t nLimit = nSrc - nMatchLimit;
+				while (ip < nLimit)
+				{
+					const uint32_t nSeq = Read32(pSrc + ip);
+					const uint32_t h = HashOf(nSeq);
+					const int64_t ref = vTable[h];
+					vTable[h] = int64_t(ip);
+
+					if (ref < 0 || ip - size_t(ref) > nMaxOffset || Read32(pSrc + ref) != nSeq)
+					{
+						// Step faster through data that isn't matching
+						ip += 1 + ((ip - anchor) >> 6);
+						continue;
+					}
+
+					size_t nMatch = nMinMatch;
+					while (ip + nMatch < nSrc - nLastLiterals && pSrc[ref + nMatch] == pSrc[ip + nMatch]) nMatch++;
+
+					Emit(ip - anchor, ip - size_t(ref), nMatch);
+					ip += nMatch;
+					anchor = ip;
+				}
+			}
+
+			Emit(nSrc - anchor, 0, 0);
+			return size_t(op - pDst);
+		}
+
+		bool Decompress(const uint8_t* pSrc, const size_t nSrc, uint8_t* pDst, const size_t nDst)
+		{
+			size_t ip = 0, op = 0;
+
+			auto ReadLength = [&](size_t& nLength)
+			{
+				uint8_t b = 0;
+				do
+				{
+					if (ip >= nSrc) return false;
+					b = pSrc[ip++];
+					nLength += b;
+				} while (b == 255);
+				return true;
+			};
+
+			while (ip < nSrc)
+			{
+				const uint8_t token = pSrc[ip++];
+
+				size_t nLiterals = token >> 4;
+				if (nLiterals == 15 && !ReadLength(nLiterals)) return false;
+				if (nLiterals > nSrc - ip || nLiterals > nDst - op) return false;
+				if (nLiterals > 0) std::memcpy(pDst + op, pSrc + ip, nLiterals);
+				ip += nLiterals;
+				op += nLiterals;
+
+				// The last sequence has no match
+				if (ip == nSrc) break;
+
+				if (nSrc - ip < 2) return false;
+				const size_t nOffset = size_t(pSrc[ip]) | (size_t(pSrc[ip + 1]) << 8);
+				ip += 2;
+				if (nOffset == 0 || nOffset > op) return false;
+
+				size_t nMatch = token & 0x0F;
+				if (nMatch == 15 && !ReadLength(nMatch)) return false;
+				nMatch += nMinMatch;
+				if (nMatch > nDst - op) return false;
+
+				// Matches may overlap their own output, which repeats a pattern
+				const uint8_t* pMatch = pDst + op - nOffset;
+				if (nOffset >= nMatch)
+					std::memcpy(pDst + op, pMatch, nMatch);
+				else
+					for (size_t i = 0; i < nMatch; i++) pDst[op + i] = pMatch[i];
+				op += nMatch;
+			}
+
+			return op == nDst;
+		}
+	}
+
+	static constexpr char sBundleMagic[8] = { 'o', 'l', 'c', 'B', 'N', 'D', 'L', '\0' };
+	static constexpr size_t nBundleAlign = 64;
+
+	std::shared_ptr<AssetBundle> AssetBundle::Open(const std::string& sFile)
+	{
+		std::shared_ptr<olc::MappedFile> pFile = olc::MappedFile::Open(sFile);
+		if (!pFile || pFile->size() < sizeof(BundleHeader)) return nullptr;
+
+		BundleHeader header;
+		std::memcpy(&header, pFile->data(), sizeof(BundleHeader));
+		if (std::memcmp(header.sMagic, sBundleMagic, sizeof(header.sMagic)) != 0 || header.nVersion != 1)
+			return nullptr;
+
+		const uint64_t nSize = pFile->size();
+		if (header.nIndexOffset % alignof(BundleEntry) != 0 || header.nIndexOffset > nSize
+			|| uint64_t(header.nEntries) * sizeof(BundleEntry) > nSize - header.nIndexOffset
+			|| header.nNamesOffset > nSize || header.nNamesSize > nSize - header.nNamesOffset)
+			return nullptr;
+
+		auto pBundle = std::make_shared<AssetBundle>();
+		pBundle->m_pFile = pFile;
+		pBundle->m_pEntries = reinterpret_cast<const BundleEntry*>(pFile->data() + header.nIndexOffset);
+		pBundle->m_nEntries = header.nEntries;
+		pBundle->m_pNames = reinterpret_cast<const char*>(pFile->data() + header.nNamesOffset);
+		pBundle->m_nNamesSize = size_t(header.nNamesSize);
+
+		// Validate every entry once here, so lookups never have to
+		for (size_t i = 0; i < pBundle->m_nEntries; i++)
+		{
+			const BundleEntry& e = pBundle->m_pEntries[i];
+			if (e.nOffset > nSize || e.nStoredSize > nSize - e.nOffset
+				|| uint64_t(e.nNameOffset) + e.nNameLength > header.nNamesSize
+				|| (e.nCompression == BundleEntry::NONE && e.nStoredSize != e.nSize)
+				|| e.nCompression > BundleEntry::LZ4
+				|| (i > 0 && pBundle->m_pEntries[i - 1].nHash >= e.nHash))
+				return nullptr;
+		}
+
+		return pBundle;
+	}
+
+	const BundleEntry* AssetBundle::Find(const uint64_t nHash) const
+	{
+		const BundleEntry* pEnd = m_pEntries + m_nEntries;
+		const BundleEntry* p = std::lower_bound(m_pEntries, pEnd, nHash,
+			[](const BundleEntry& e, const uint64_t h) { return e.nHash < h; });
+		return (p != pEnd && p->nHash == nHash) ? p : nullptr;
+	}
+
+	std::string AssetBundle::Name(const BundleEntry& entry) const
+	{
+		return std::string(m_pNames + entry.nNameOffset, entry.nNameLength);
+	}
+
+	const uint8_t* AssetBundle::Data(const BundleEntry& entry) const
+	{
+		if (entry.nCompression != BundleEntry::NONE) return nullptr;
+		return m_pFile->data() + entry.nOffset;
+	}
+
+	bool AssetBundle::Read(const BundleEntry& entry, void* pDst) const
+	{
+		const uint8_t* pSrc = m_pFile->data() + entry.nOffset;
+		if (entry.nCompression == BundleEntry::LZ4)
+			return lz4::Decompress(pSrc, size_t(entry.nStoredSize), static_cast<uint8_t*>(pDst), size_t(entry.nSize));
+
+		std::memcpy(pDst, pSrc, size_t(entry.nSize));
+		return true;
+	}
+
+	void AssetBundleWriter::Add(Item&& item, const void* pData, const size_t nBytes)
+	{
+		const uint8_t* p = static_cast<const uint8_t*>(pData);
+		item.vData.assign(p, p + nBytes);
+		m_vItems.push_back(std::move(item));
+	}
+
+	void AssetBundleWriter::AddRaw(const std::string& sName, const void* pData, const size_t nBytes)
+	{
+		Item item;
+		item.sName = sName;
+		item.nType = BundleEntry::RAW;
+		Add(std::move(item), pData, nBytes);
+	}
+
+	void AssetBundleWriter::AddImage(const std::string& sName, const uint32_t nWidth, const uint32_t nHeight, const void* pPixels)
+	{
+		Item item;
+		item.sName = sName;
+		item.nType = BundleEntry::IMAGE;
+		item.nParam[0] = nWidth;
+		item.nParam[1] = nHeight;
+		Add(std::move(item), pPixels, size_t(nWidth) * size_t(nHeight) * 4);
+	}
+
+	void AssetBundleWriter::AddWave(const std::string& sName, const uint32_t nChannels, const uint32_t nSampleRate, const uint32_t nSamples, const float* pSamples)
+	{
+		Item item;
+		item.sName = sName;
+		item.nType = BundleEntry::WAVE;
+		item.nParam[0] = nChannels;
+		item.nParam[1] = nSampleRate;
+		item.nParam[2] = nSamples;
+		Add(std::move(item), pSamples, size_t(nChannels) * size_t(nSamples) * sizeof(float));
+	}
+
+	bool AssetBundleWriter::Save(const std::string& sFile, const bool bCompress, std::string* pError) const
+	{
+		auto Fail = [&](const std::string& sWhy) { if (pError) *pError = sWhy; return false; };
+		auto Align = [](const uint64_t n) { return (n + nBundleAlign - 1) & ~uint64_t(nBundleAlign - 1); };
+
+		// The index is sorted by hash so it can be binary searched
+		std::vector<const Item*> vSorted;
+		std::vector<uint64_t> vHashes;
+		for (const auto& item : m_vItems) vSorted.push_back(&item);
+		std::sort(vSorted.begin(), vSorted.end(), [](const Item* a, const Item* b)
+			{ return AssetBundle::Hash(a->sName.data(), a->sName.size()) < AssetBundle::Hash(b->sName.data(), b->sName.size()); });
+
+		for (size_t i = 0; i < vSorted.size(); i++)
+		{
+			vHashes.push_back(AssetBundle::Hash(vSorted[i]->sName.data(), vSorted[i]->sName.size()));
+			if (i > 0 && vHashes[i] == vHashes[i - 1])
+				return Fail(vSorted[i]->sName == vSorted[i - 1]->sName
+					? "duplicate name <" + vSorted[i]->sName + ">"
+					: "<" + vSorted[i]->sName + "> and <" + vSorted[i - 1]->sName + "> have the same hash");
+		}
+
+		BundleHeader header{};
+		std::memcpy(header.sMagic, sBundleMagic, sizeof(header.sMagic));
+		header.nVersion = 1;
+		header.nEntries = uint32_t(vSorted.size());
+		header.nIndexOffset = sizeof(BundleHeader);
+		header.nNamesOffset = header.nIndexOffset + vSorted.size() * sizeof(BundleEntry);
+
+		std::string sNames;
+		std::vector<BundleEntry> vEntries(vSorted.size());
+		std::vector<std::vector<uint8_t>> vCompressed(vSorted.size());
+		for (size_t i = 0; i < vSorted.size(); i++)
+		{
+			const Item& item = *vSorted[i];
+			BundleEntry& e = vEntries[i];
+			e = BundleEntry{};
+			e.nHash = vHashes[i];
+			e.nType = item.nType;
+			e.nSize = item.vData.size();
+			e.nStoredSize = e.nSize;
+			e.nNameOffset = uint32_t(sNames.size());
+			e.nNameLength = uint32_t(item.sName.size());
+			std::copy(std::begin(item.nParam), std::end(item.nParam), e.nParam);
+			sNames += item.sName;
+
+			if (bCompress && !item.vData.empty())
+			{
+				std::vector<uint8_t>& v = vCompressed[i];
+				v.resize(lz4::Bound(item.vData.size()));
+				v.resize(lz4::Compress(item.vData.data(), item.vData.size(), v.data()));
+				if (v.size() <= item.vData.size() - item.vData.size() / 8)
+				{
+					e.nCompression = BundleEntry::LZ4;
+					e.nStoredSize = v.size();
+				}
+				else
+					v.clear();
+			}
+		}
+		header.nNamesSize = sNames.size();
+
+		uint64_t nOffset = Align(header.nNamesOffset + header.nNamesSize);
+		for (auto& e : vEntries)
+		{
+			e.nOffset = nOffset;
+			nOffset = Align(nOffset + e.nStoredSize);
+		}
+
+		std::ofstream ofs(sFile, std::ios::binary);
+		if (!ofs.is_open()) return Fail("cannot write <" + sFile + ">");
+
+		uint64_t nWritten = 0;
+		auto Write = [&](const void* p, const size_t n) { ofs.write(static_cast<const char*>(p), std::streamsize(n)); nWritten += n; };
+		auto PadTo = [&](const uint64_t n) { static const char pad[nBundleAlign] = {}; Write(pad, size_t(n - nWritten)); };
+
+		Write(&header, sizeof(BundleHeader));
+		Write(vEntries.data(), vEntries.size() * sizeof(BundleEntry));
+		Write(sNames.data(), sNames.size());
+		for (size_t i = 0; i < vEntries.size(); i++)
+		{
+			PadTo(vEntries[i].nOffset);
+			if (vEntries[i].nCompression == BundleEntry::LZ4)
+				Write(vCompressed[i].data(), vCompressed[i].size());
+			else
+				Write(vSorted[i]->vData.data(), vSorted[i]->vData.size());
+		}
+
+		return ofs.good() ? true : Fail("error writing <" + sFile + ">");
+	}
+}
+
+#endif // OLC_ASSETBUNDLE
+#endif // OLC_ASSETBUNDLE_H
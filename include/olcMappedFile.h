@@ -0,0 +1,174 @@
+/*
+	olcMappedFile.h
+
+	+-------------------------------------------------------------+
+	|       Memory mapped, zero-copy asset source for PGE & SWE   |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	olc::MappedFile maps a file on disk into the address space of the
+	process. Assets stored in a "raw" format (float32 wave data chunks,
+	pre-decoded RGBA sprites) can then be referenced straight from the
+	mapping, rather than being copied through a std::ifstream.
+
+	The mapping is private and copy-on-write. Pages are shared with the
+	OS page cache (and so with any other process that has mapped the same
+	file) until they are written to, at which point that page alone is
+	copied.
+
+	On platforms without memory mapping (Emscripten) the file is read
+	into memory instead, so callers never need to care.
+
+	Usage
+	~~~~~
+	Exactly one translation unit must provide the implementation:
+
+	#define OLC_MAPPEDFILE
+	#include "olcMappedFile.h"
+*/
+
+#pragma once
+#ifndef OLC_MAPPEDFILE_H
+#define OLC_MAPPEDFILE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace olc
+{
+	// O------------------------------------------------------------------------------O
+	// | olc::MappedFile - A read-only (copy-on-write) view of a file on disk         |
+	// O------------------------------------------------------------------------------O
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+	public:
+		// Maps the whole of sFile, returns nullptr if the file cannot be opened
+		static std::shared_ptr<MappedFile> Open(const std::string& sFile);
+
+	public:
+		const uint8_t* data() const { return m_pData; }
+		uint8_t* data() { return m_pData; }
+		size_t size() const { return m_nSize; }
+		// True if backed by the OS page cache, false if a heap copy had to be made
+		bool IsMapped() const { return m_bMapped; }
+
+	private:
+		uint8_t* m_pData = nullptr;
+		size_t m_nSize = 0;
+		bool m_bMapped = false;
+		std::vector<uint8_t> m_vFallback;
+#if defined(_WIN32)
+		void* m_hFile = nullptr;
+		void* m_hMapping = nullptr;
+#endif
+	};
+}
+
+#ifdef OLC_MAPPEDFILE
+#undef OLC_MAPPEDFILE
+
+#if defined(_WIN32)
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define OLC_MAPPEDFILE_POSIX
+#endif
+
+#include <fstream>
+
+namespace olc
+{
+	MappedFile::~MappedFile()
+	{
+#if defined(_WIN32)
+		if (m_bMapped) UnmapViewOfFile(m_pData);
+		if (m_hMapping != nullptr) CloseHandle(m_hMapping);
+		if (m_hFile != nullptr) CloseHandle(m_hFile);
+#elif defined(OLC_MAPPEDFILE_POSIX)
+		if (m_bMapped) munmap(m_pData, m_nSize);
+#endif
+	}
+
+	std::shared_ptr<MappedFile> MappedFile::Open(const std::string& sFile)
+	{
+		auto pFile = std::make_shared<MappedFile>();
+
+#if defined(_WIN32)
+		HANDLE hFile = CreateFileA(sFile.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE) return nullptr;
+		pFile->m_hFile = hFile;
+
+		LARGE_INTEGER liSize;
+		if (!GetFileSizeEx(hFile, &liSize)) return nullptr;
+		pFile->m_nSize = size_t(liSize.QuadPart);
+
+		if (pFile->m_nSize > 0)
+		{
+			// PAGE_WRITECOPY + FILE_MAP_COPY is the windows equivalent of MAP_PRIVATE
+			pFile->m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (pFile->m_hMapping != nullptr)
+			{
+				pFile->m_pData = static_cast<uint8_t*>(MapViewOfFile(pFile->m_hMapping, FILE_MAP_COPY, 0, 0, 0));
+				pFile->m_bMapped = pFile->m_pData != nullptr;
+			}
+		}
+#elif defined(OLC_MAPPEDFILE_POSIX)
+		int fd = open(sFile.c_str(), O_RDONLY);
+		if (fd < 0) return nullptr;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			close(fd);
+			return nullptr;
+		}
+		pFile->m_nSize = size_t(st.st_size);
+
+		if (pFile->m_nSize > 0)
+		{
+			void* p = mmap(nullptr, pFile->m_nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (p != MAP_FAILED)
+			{
+				pFile->m_pData = static_cast<uint8_t*>(p);
+				pFile->m_bMapped = true;
+			}
+		}
+
+		// The mapping holds its own reference to the file
+		close(fd);
+#endif
+
+		if (!pFile->m_bMapped)
+		{
+			// No mapping available, so fall back to reading it all in
+			std::ifstream ifs(sFile, std::ios::binary | std::ios::ate);
+			if (!ifs.is_open()) return nullptr;
+			pFile->m_nSize = size_t(ifs.tellg());
+			pFile->m_vFallback.resize(pFile->m_nSize);
+			ifs.seekg(0, std::ios::beg);
+			ifs.read(reinterpret_cast<char*>(pFile->m_vFallback.data()), pFile->m_nSize);
+			pFile->m_pData = pFile->m_vFallback.data();
+		}
+
+		return pFile;
+	}
+}
+
+#endif // OLC_MAPPEDFILE
+#endif // OLC_MAPPEDFILE_H
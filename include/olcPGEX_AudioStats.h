@@ -0,0 +1,130 @@
+/*
+	olcPGEX_AudioStats.h
+
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|                Audio Thread Telemetry Overlay               |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	Draws olc::sound::WaveEngine::GetAudioStats() over the top of the
+	screen - how long blocks take to mix compared to how long they
+	play for, the worst case, deadline misses, device underruns, the
+	peak number of voices and the output latency, plus a histogram of
+	block timings.
+
+	Use it to size nBlocks/nBlockSamples in InitialiseAudio() for a
+	machine: if the histogram reaches the right hand side, or underruns
+	climb, give the mixer more headroom.
+
+	Usage
+	~~~~~
+	Construct after the PixelGameEngine, e.g. as a member of your
+	application class, then press the toggle key (F3 by default):
+
+	olc::sound::WaveEngine engine;
+	olc::AudioStatsOverlay overlay{ &engine };
+
+	Exactly one translation unit must provide the implementation:
+
+	#define OLC_PGEX_AUDIOSTATS
+	#include "olcPGEX_AudioStats.h"
+*/
+
+#pragma once
+#ifndef OLC_PGEX_AUDIOSTATS_H
+#define OLC_PGEX_AUDIOSTATS_H
+
+#include "olcPixelGameEngine.h"
+#include "olcSoundWaveEngine.h"
+
+namespace olc
+{
+	class AudioStatsOverlay : public olc::PGEX
+	{
+	public:
+		AudioStatsOverlay(olc::sound::WaveEngine* pEngine, const olc::Key keyToggle = olc::Key::F3, const bool bVisible = false);
+
+	public:
+		void Show(const bool bShow);
+		bool IsShowing() const;
+
+	protected:
+		void OnAfterUserUpdate(float fElapsedTime) override;
+
+	private:
+		olc::sound::WaveEngine* m_pEngine = nullptr;
+		olc::Key m_keyToggle;
+		bool m_bVisible = false;
+	};
+}
+
+#ifdef OLC_PGEX_AUDIOSTATS
+#undef OLC_PGEX_AUDIOSTATS
+
+#include <iomanip>
+
+namespace olc
+{
+	AudioStatsOverlay::AudioStatsOverlay(olc::sound::WaveEngine* pEngine, const olc::Key keyToggle, const bool bVisible)
+		: olc::PGEX(true), m_pEngine(pEngine), m_keyToggle(keyToggle), m_bVisible(bVisible)
+	{ }
+
+	void AudioStatsOverlay::Show(const bool bShow)
+	{ m_bVisible = bShow; }
+
+	bool AudioStatsOverlay::IsShowing() const
+	{ return m_bVisible; }
+
+	void AudioStatsOverlay::OnAfterUserUpdate(float fElapsedTime)
+	{
+		UNUSED(fElapsedTime);
+		if (pge->GetKey(m_keyToggle).bPressed) m_bVisible = !m_bVisible;
+		if (!m_bVisible || m_pEngine == nullptr) return;
+
+		const olc::sound::AudioStats stats = m_pEngine->GetAudioStats();
+		auto ms = [](double d) { std::stringstream ss; ss << std::fixed << std::setprecision(2) << d * 1000.0 << "ms"; return ss.str(); };
+		auto pc = [&](double d) { return std::to_string(int(d / std::max(stats.dBlockPeriod, 1e-9) * 100.0)) + "%"; };
+
+		const std::vector<std::string> vLines =
+		{
+			"AUDIO   block " + ms(stats.dBlockPeriod),
+			"mean  " + ms(stats.dMeanCallback) + " " + pc(stats.dMeanCallback),
+			"worst " + ms(stats.dWorstCallback) + " " + pc(stats.dWorstCallback),
+			"p99   <" + std::to_string(int(stats.Percentile(0.99f) * 100.0)) + "%",
+			"miss " + std::to_string(stats.nDeadlineMisses) + " xrun " + std::to_string(stats.nUnderruns),
+			"voices peak " + std::to_string(stats.nPeakVoices),
+			"latency " + ms(stats.dOutputLatency) + (stats.bRealtime ? " RT" : ""),
+		};
+
+		// Panel, with a histogram of block timings beneath the text
+		constexpr int32_t nBarWidth = 6, nHistHeight = 24;
+		const int32_t nWidth = std::max(int32_t(olc::sound::AudioStats::nHistogramBuckets) * nBarWidth, 22 * 8) + 4;
+		const int32_t nHeight = int32_t(vLines.size()) * 10 + nHistHeight + 8;
+
+		olc::Pixel::Mode modeOld = pge->GetPixelMode();
+		pge->SetPixelMode(olc::Pixel::ALPHA);
+		pge->FillRect(0, 0, nWidth, nHeight, olc::Pixel(0, 0, 0, 192));
+		pge->SetPixelMode(modeOld);
+
+		for (size_t i = 0; i < vLines.size(); i++)
+			pge->DrawString(2, 2 + int32_t(i) * 10, vLines[i], i == 4 && (stats.nDeadlineMisses + stats.nUnderruns) > 0 ? olc::RED : olc::WHITE);
+
+		uint64_t nMost = 1;
+		for (auto n : stats.vHistogram) nMost = std::max(nMost, n);
+
+		const int32_t nBase = nHeight - 3;
+		for (size_t i = 0; i < olc::sound::AudioStats::nHistogramBuckets; i++)
+		{
+			// Buckets past 100% of the block period are blocks that missed their deadline
+			int32_t h = int32_t(double(stats.vHistogram[i]) / double(nMost) * nHistHeight);
+			if (stats.vHistogram[i] > 0) h = std::max(h, 1);
+			pge->FillRect(2 + int32_t(i) * nBarWidth, nBase - h, nBarWidth - 1, h, i >= 10 ? olc::RED : olc::GREEN);
+		}
+		pge->DrawLine(2 + 10 * nBarWidth - 1, nBase - nHistHeight, 2 + 10 * nBarWidth - 1, nBase, olc::YELLOW);
+	}
+}
+
+#endif // OLC_PGEX_AUDIOSTATS
+#endif // OLC_PGEX_AUDIOSTATS_H
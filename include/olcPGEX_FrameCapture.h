@@ -0,0 +1,343 @@
+/*
+	olcPGEX_FrameCapture.h
+
+	+-------------------------------------------------------------+
+	|         OneLoneCoder Pixel Game Engine Extension            |
+	|               Frame Capture and Frame Diffing               |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	Copies layer 0's draw target once OnUserUpdate() has finished with
+	it, and hands the copy to a background thread that writes it out as
+	a PNG or as a raw sprite (Sprite::SaveToRawFile). The game thread
+	only pays for a memcpy; if the encoder falls more than nMaxPending
+	frames behind, capturing waits for it rather than dropping frames,
+	and Stalls() counts how often that happened.
+
+	Only the CPU side of layer 0 is captured - decals and other layers
+	are drawn by the GPU and are not part of it. That is exactly the
+	output of the software rasteriser, and it is the same on every
+	machine, which makes it suitable for golden frame tests. Compare()
+	diffs two frames with a per channel tolerance.
+
+	PNGs need an image loader that can save (OLC_IMAGE_LIBPNG); raw
+	frames always work, and Sprite::LoadFromFile() reads either back.
+
+	Usage
+	~~~~~
+	Construct after the PixelGameEngine, e.g. as a member of your
+	application class:
+
+	olc::FrameCapture capture;
+	capture.Start("frames", olc::FrameCapture::Format::PNG, 30);	// every 30th frame
+	...
+	capture.Flush();
+
+	Exactly one translation unit must provide the implementation:
+
+	#define OLC_PGEX_FRAMECAPTURE
+	#include "olcPGEX_FrameCapture.h"
+*/
+
+#pragma once
+#ifndef OLC_PGEX_FRAMECAPTURE_H
+#define OLC_PGEX_FRAMECAPTURE_H
+
+#include "olcPixelGameEngine.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace olc
+{
+	// How two frames differ. Pixels within the tolerance on every channel count as equal
+	struct FrameDiff
+	{
+		bool bSameSize = true;
+		uint32_t nDiffering = 0;
+		// Largest difference in any one channel, tolerated or not
+		uint8_t nMaxDelta = 0;
+		// First differing pixel, in reading order
+		olc::vi2d vFirst = { -1, -1 };
+
+		bool Matches(const uint32_t nAllowed = 0) const { return bSameSize && nDiffering <= nAllowed; }
+	};
+
+	class FrameCapture : public olc::PGEX
+	{
+	public:
+		enum class Format { PNG, RAW };
+
+		FrameCapture(const size_t nMaxPending = 8);
+		~FrameCapture();
+
+	public:
+		// Captures the current frame and every nEvery'th one after it into sDirectory, named
+		// by FrameName(). Called before the engine starts, capturing begins with frame 0
+		void Start(const std::string& sDirectory, const Format format = Format::PNG, const uint32_t nEvery = 1);
+		void Stop();
+		// Captures just the frame being updated now, to sFile
+		void CaptureFrame(const std::string& sFile, const Format format = Format::PNG);
+		// Waits until every frame captured so far has been written
+		void Flush();
+
+		// Frames updated since construction; during the first OnUserUpdate() this is 0
+		uint64_t FrameIndex() const { return m_nFrame; }
+		size_t Written() const;
+		size_t Failed() const;
+		size_t Stalls() const;
+
+		// "frame_000120.png", "frame_000120.rgba"
+		static std::string FrameName(const uint64_t nFrame, const Format format);
+		// Compares two frames. pDiff, if given, is filled with a dimmed copy of pExpected
+		// with the differing pixels in red
+		static FrameDiff Compare(const olc::Sprite* pExpected, const olc::Sprite* pActual,
+			const uint8_t nTolerance = 0, olc::Sprite* pDiff = nullptr);
+
+	protected:
+		void OnAfterUserUpdate(float fElapsedTime) override;
+
+	private:
+		struct Job
+		{
+			std::unique_ptr<olc::Sprite> pFrame;
+			std::string sFile;
+			Format format = Format::PNG;
+		};
+
+		void Enqueue(const std::string& sFile, const Format format);
+		void EncoderThread();
+
+		const size_t m_nMaxPending;
+		uint64_t m_nFrame = 0;
+
+		bool m_bCapturing = false;
+		std::string m_sDirectory;
+		Format m_format = Format::PNG;
+		uint32_t m_nEvery = 1;
+		uint64_t m_nNextFrame = 0;
+		std::vector<std::pair<std::string, Format>> m_vOneShots;
+
+		// Shared with the encoder thread, under m_mux
+		mutable std::mutex m_mux;
+		std::condition_variable m_cvWork;
+		std::condition_variable m_cvDone;
+		std::deque<Job> m_qJobs;
+		std::vector<std::unique_ptr<olc::Sprite>> m_vFree;
+		size_t m_nInFlight = 0;
+		size_t m_nWritten = 0;
+		size_t m_nFailed = 0;
+		size_t m_nStalls = 0;
+		bool m_bQuit = false;
+
+		std::unique_ptr<olc::ImageLoader> m_pLoader;
+		std::thread m_thread;
+	};
+}
+
+#ifdef OLC_PGEX_FRAMECAPTURE
+#undef OLC_PGEX_FRAMECAPTURE
+
+#include <cstdio>
+
+namespace olc
+{
+	FrameCapture::FrameCapture(const size_t nMaxPending)
+		: olc::PGEX(true), m_nMaxPending(std::max<size_t>(nMaxPending, 1))
+	{ }
+
+	FrameCapture::~FrameCapture()
+	{
+		if (!m_thread.joinable()) return;
+		{
+			std::lock_guard<std::mutex> lock(m_mux);
+			m_bQuit = true;
+		}
+		m_cvWork.notify_one();
+		m_thread.join();
+	}
+
+	void FrameCapture::Start(const std::string& sDirectory, const Format format, const uint32_t nEvery)
+	{
+		m_bCapturing = true;
+		m_sDirectory = sDirectory;
+		m_format = format;
+		m_nEvery = std::max(nEvery, 1u);
+		m_nNextFrame = m_nFrame;
+	}
+
+	void FrameCapture::Stop()
+	{ m_bCapturing = false; }
+
+	void FrameCapture::CaptureFrame(const std::string& sFile, const Format format)
+	{ m_vOneShots.push_back({ sFile, format }); }
+
+	void FrameCapture::Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mux);
+		m_cvDone.wait(lock, [&] { return m_nInFlight == 0; });
+	}
+
+	size_t FrameCapture::Written() const
+	{
+		std::lock_guard<std::mutex> lock(m_mux);
+		return m_nWritten;
+	}
+
+	size_t FrameCapture::Failed() const
+	{
+		std::lock_guard<std::mutex> lock(m_mux);
+		return m_nFailed;
+	}
+
+	size_t FrameCapture::Stalls() const
+	{
+		std::lock_guard<std::mutex> lock(m_mux);
+		return m_nStalls;
+	}
+
+	std::string FrameCapture::FrameName(const uint64_t nFrame, const Format format)
+	{
+		char sName[64];
+		std::snprintf(sName, sizeof(sName), "frame_%06llu.%s", (unsigned long long)nFrame, format == Format::PNG ? "png" : "rgba");
+		return sName;
+	}
+
+	void FrameCapture::OnAfterUserUpdate(float fElapsedTime)
+	{
+		UNUSED(fElapsedTime);
+		if (m_bCapturing && m_nFrame == m_nNextFrame)
+		{
+			Enqueue(m_sDirectory + "/" + FrameName(m_nFrame, m_format), m_format);
+			m_nNextFrame += m_nEvery;
+		}
+
+		for (const auto& shot : m_vOneShots)
+			Enqueue(shot.first, shot.second);
+		m_vOneShots.clear();
+
+		m_nFrame++;
+	}
+
+	void FrameCapture::Enqueue(const std::string& sFile, const Format format)
+	{
+		olc::Sprite* pSource = pge->GetLayers()[0].pDrawTarget.Sprite();
+		std::unique_ptr<olc::Sprite> pFrame;
+		{
+			std::unique_lock<std::mutex> lock(m_mux);
+			if (!m_thread.joinable())
+			{
+				// Image loaders are not thread safe, so the encoder gets one of its own
+				if (olc::Sprite::loader) m_pLoader = olc::Sprite::loader->Clone();
+				m_thread = std::thread(&FrameCapture::EncoderThread, this);
+			}
+
+			if (m_nInFlight >= m_nMaxPending)
+			{
+				m_nStalls++;
+				m_cvDone.wait(lock, [&] { return m_nInFlight < m_nMaxPending; });
+			}
+			m_nInFlight++;
+
+			if (!m_vFree.empty())
+			{
+				pFrame = std::move(m_vFree.back());
+				m_vFree.pop_back();
+			}
+		}
+
+		// Frames are recycled, so once warmed up this is only the copy
+		if (!pFrame) pFrame = std::make_unique<olc::Sprite>();
+		if (pFrame->width != pSource->width || pFrame->height != pSource->height)
+		{
+			pFrame->width = pSource->width;
+			pFrame->height = pSource->height;
+			pFrame->pColData.resize(size_t(pSource->width) * size_t(pSource->height));
+		}
+		std::memcpy(pFrame->GetData(), pSource->GetData(), pFrame->pColData.size() * sizeof(olc::Pixel));
+
+		{
+			std::lock_guard<std::mutex> lock(m_mux);
+			m_qJobs.push_back({ std::move(pFrame), sFile, format });
+		}
+		m_cvWork.notify_one();
+	}
+
+	void FrameCapture::EncoderThread()
+	{
+		for (;;)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mux);
+				m_cvWork.wait(lock, [&] { return !m_qJobs.empty() || m_bQuit; });
+				// Whatever is queued is still written before quitting
+				if (m_qJobs.empty()) return;
+				job = std::move(m_qJobs.front());
+				m_qJobs.pop_front();
+			}
+
+			olc::rcode result = olc::rcode::FAIL;
+			if (job.format == Format::RAW)
+				result = job.pFrame->SaveToRawFile(job.sFile);
+			else if (m_pLoader)
+				result = m_pLoader->SaveImageResource(job.pFrame.get(), job.sFile);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mux);
+				if (result == olc::rcode::OK) m_nWritten++; else m_nFailed++;
+				m_vFree.push_back(std::move(job.pFrame));
+				m_nInFlight--;
+			}
+			m_cvDone.notify_all();
+		}
+	}
+
+	FrameDiff FrameCapture::Compare(const olc::Sprite* pExpected, const olc::Sprite* pActual, const uint8_t nTolerance, olc::Sprite* pDiff)
+	{
+		FrameDiff diff;
+		if (pExpected->width != pActual->width || pExpected->height != pActual->height)
+		{
+			diff.bSameSize = false;
+			return diff;
+		}
+
+		const size_t nPixels = size_t(pExpected->width) * size_t(pExpected->height);
+		const olc::Pixel* pE = pExpected->pColData.data();
+		const olc::Pixel* pA = pActual->pColData.data();
+
+		// Identical frames are the common case, and need no per pixel work
+		if (pDiff == nullptr && std::memcmp(pE, pA, nPixels * sizeof(olc::Pixel)) == 0)
+			return diff;
+
+		if (pDiff != nullptr)
+		{
+			pDiff->width = pExpected->width;
+			pDiff->height = pExpected->height;
+			pDiff->pColData.resize(nPixels);
+		}
+
+		for (size_t i = 0; i < nPixels; i++)
+		{
+			const olc::Pixel e = pE[i], a = pA[i];
+			const uint8_t nDelta = uint8_t(std::max(
+				std::max(std::abs(int(e.r) - int(a.r)), std::abs(int(e.g) - int(a.g))),
+				std::max(std::abs(int(e.b) - int(a.b)), std::abs(int(e.a) - int(a.a)))));
+			diff.nMaxDelta = std::max(diff.nMaxDelta, nDelta);
+
+			const bool bDiffers = nDelta > nTolerance;
+			if (bDiffers && diff.nDiffering++ == 0)
+				diff.vFirst = { int32_t(i % size_t(pExpected->width)), int32_t(i / size_t(pExpected->width)) };
+
+			if (pDiff != nullptr)
+				pDiff->pColData[i] = bDiffers ? olc::Pixel(255, 0, 0) : olc::Pixel(e.r / 4, e.g / 4, e.b / 4);
+		}
+		return diff;
+	}
+}
+
+#endif // OLC_PGEX_FRAMECAPTURE
+#endif // OLC_PGEX_FRAMECAPTURE_H
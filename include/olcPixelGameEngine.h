@@ -389,14 +389,20 @@ int main()
 #include <list>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <map>
 #include <functional>
 #include <algorithm>
 #include <array>
 #include <cstring>
+#include <memory>
 #pragma endregion
 
+#include "olcMappedFile.h"
+
 #define PGE_VER 223
 
 // O------------------------------------------------------------------------------O
@@ -451,6 +457,16 @@ int main()
 	#endif
 #endif
 
+// No window either, but the real OpenGL 3.3 renderer draws into an EGL pbuffer,
+// so decals and layers can be tested and timed on machines without a display
+#if defined(OLC_PGE_OFFSCREEN)
+	#define OLC_PLATFORM_HEADLESS
+	#define OLC_GFX_OPENGL33
+	#if !defined(OLC_IMAGE_STB) && !defined(OLC_IMAGE_GDI) && !defined(OLC_IMAGE_LIBPNG)
+		#define OLC_IMAGE_HEADLESS
+	#endif
+#endif
+
 // Platform
 #if !defined(OLC_PLATFORM_WINAPI) && !defined(OLC_PLATFORM_X11) && !defined(OLC_PLATFORM_GLUT) && !defined(OLC_PLATFORM_EMSCRIPTEN) && !defined(OLC_PLATFORM_HEADLESS)
 	#if !defined(OLC_PLATFORM_CUSTOM_EX)
@@ -532,6 +548,7 @@ int main()
 	{
 		#include <X11/X.h>
 		#include <X11/Xlib.h>
+		#include <X11/XKBlib.h>
 	}
 #endif
 
@@ -659,6 +676,19 @@ namespace olc
 		bool bHeld = false;		// Set true for all frames between pressed and released events
 	};
 
+	// O------------------------------------------------------------------------------O
+	// | olc::FrameStats - How steady the frame times were over the last second       |
+	// O------------------------------------------------------------------------------O
+	struct FrameStats
+	{
+		uint32_t nFrames = 0;
+		float fMean = 0.0f;		// Seconds per frame
+		float fJitter = 0.0f;	// Standard deviation of the frame time, in seconds
+		float fMin = 0.0f;
+		float fMax = 0.0f;
+		uint32_t nLate = 0;		// Frames that started after their frame rate limit deadline
+	};
+
 
 
 
@@ -739,6 +769,24 @@ namespace olc
 	typedef v2d_generic<double> vd2d;
 #endif
 
+	// O------------------------------------------------------------------------------O
+	// | olc::InputEvent - One key, button, wheel or mouse movement, as it happened   |
+	// O------------------------------------------------------------------------------O
+	struct InputEvent
+	{
+		enum class Type : uint8_t { KEY, MOUSE_BUTTON, MOUSE_WHEEL, MOUSE_MOVE };
+		InputEvent() = default;
+		InputEvent(const Type t, const int32_t code, const bool down = false, const olc::vi2d& pos = { 0, 0 })
+			: type(t), nCode(code), bDown(down), vPos(pos) {}
+
+		Type type = Type::KEY;
+		int32_t nCode = 0;		// olc::Key, mouse button, or wheel delta
+		bool bDown = false;		// KEY and MOUSE_BUTTON only
+		olc::vi2d vPos;			// Mouse position in pixel space, MOUSE_MOVE only
+		std::chrono::steady_clock::time_point tp;
+		float fAge = 0.0f;		// Seconds before the frame it is delivered with began
+	};
+
 
 
 	
@@ -779,9 +827,52 @@ namespace olc
 		virtual ~ImageLoader() = default;
 		virtual olc::rcode LoadImageResource(olc::Sprite* spr, const std::string& sImageFile, olc::ResourcePack* pack) = 0;
 		virtual olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) = 0;
+		// A loader of the same kind for another thread, or nullptr if decoding must stay on one
+		virtual std::unique_ptr<olc::ImageLoader> Clone() const { return nullptr; }
 	};
 
 
+	// O------------------------------------------------------------------------------O
+	// | olc::PixelStore - Pixel storage which is either owned, or memory mapped      |
+	// O------------------------------------------------------------------------------O
+	class PixelStore
+	{
+	public:
+		PixelStore() = default;
+		// Copies always own their pixels, only moving a store carries a mapping across
+		PixelStore(const PixelStore& p);
+		PixelStore(PixelStore&& p) noexcept;
+		PixelStore& operator=(const PixelStore& p);
+		PixelStore& operator=(PixelStore&& p) noexcept;
+
+	public:
+		// Views nPixels pixels at nOffset bytes into an existing mapping - no copy is made
+		void Map(std::shared_ptr<olc::MappedFile> pFile, size_t nOffset, size_t nPixels);
+		bool IsMapped() const { return pMapping != nullptr; }
+
+		// std::vector style access, resizing a mapped store takes a private copy first
+		void resize(size_t n);
+		void resize(size_t n, const Pixel& p);
+		void clear();
+		size_t size() const { return nPixels; }
+		bool empty() const { return nPixels == 0; }
+		Pixel* data() { return pPixels; }
+		const Pixel* data() const { return pPixels; }
+		Pixel* begin() { return pPixels; }
+		Pixel* end() { return pPixels + nPixels; }
+		const Pixel* begin() const { return pPixels; }
+		const Pixel* end() const { return pPixels + nPixels; }
+		Pixel& operator[](size_t i) { return pPixels[i]; }
+		const Pixel& operator[](size_t i) const { return pPixels[i]; }
+
+	private:
+		void Detach();
+		std::vector<Pixel> vOwned;
+		std::shared_ptr<olc::MappedFile> pMapping;
+		Pixel* pPixels = nullptr;
+		size_t nPixels = 0;
+	};
+
 	// O------------------------------------------------------------------------------O
 	// | olc::Sprite - An image represented by a 2D array of olc::Pixel               |
 	// O------------------------------------------------------------------------------O
@@ -796,6 +887,12 @@ namespace olc
 
 	public:
 		olc::rcode LoadFromFile(const std::string& sImageFile, olc::ResourcePack* pack = nullptr);
+		// Loads vFiles[i] into vSprites[i] on nThreads workers (0 for one per core), each with
+		// its own image loader. Returns each file's result, in order
+		static std::vector<olc::rcode> LoadFromFiles(const std::vector<olc::Sprite*>& vSprites, const std::vector<std::string>& vFiles, size_t nThreads = 0);
+		// Pre-decoded RGBA sprites are memory mapped, and used directly from the page cache
+		olc::rcode LoadFromRawFile(const std::string& sImageFile);
+		olc::rcode SaveToRawFile(const std::string& sImageFile) const;
 
 	public:
 		int32_t width = 0;
@@ -817,7 +914,7 @@ namespace olc
 		olc::Sprite* Duplicate();
 		olc::Sprite* Duplicate(const olc::vi2d& vPos, const olc::vi2d& vSize);
 		olc::vi2d Size() const;
-		std::vector<olc::Pixel> pColData;
+		olc::PixelStore pColData;
 		Mode modeSample = Mode::NORMAL;
 
 		static std::unique_ptr<olc::ImageLoader> loader;
@@ -871,6 +968,8 @@ namespace olc
 		Renderable(const Renderable&) = delete;
 		olc::rcode Load(const std::string& sFile, ResourcePack* pack = nullptr, bool filter = false, bool clamp = true);
 		void Create(uint32_t width, uint32_t height, bool filter = false, bool clamp = true);
+		// Takes ownership of an already decoded sprite and uploads it, so the decode can happen elsewhere
+		void Create(std::unique_ptr<olc::Sprite> sprite, bool filter = false, bool clamp = true);
 		olc::Decal* Decal() const;
 		olc::Sprite* Sprite() const;
 
@@ -887,15 +986,39 @@ namespace olc
 	struct DecalInstance
 	{
 		olc::Decal* decal = nullptr;
-		std::vector<olc::vf2d> pos;
-		std::vector<olc::vf2d> uv;
-		std::vector<float> w;
-		std::vector<olc::Pixel> tint;
+		// Vertex attributes, "points" of each, held by the layer's DecalArena until it is reset
+		olc::vf2d* pos = nullptr;
+		olc::vf2d* uv = nullptr;
+		float* w = nullptr;
+		olc::Pixel* tint = nullptr;
 		olc::DecalMode mode = olc::DecalMode::NORMAL;
 		olc::DecalStructure structure = olc::DecalStructure::FAN;
 		uint32_t points = 0;
 	};
 
+	// Bump allocator for decal vertices. Reset() keeps every block, so once a layer has
+	// seen a frame's worth of decals, drawing them allocates nothing
+	class DecalArena
+	{
+	public:
+		// Points di's attributes at nPoints fresh, contiguous vertices
+		void Allocate(olc::DecalInstance& di, const uint32_t nPoints);
+		void Reset();
+
+	private:
+		struct Block
+		{
+			std::unique_ptr<olc::vf2d[]> pos;
+			std::unique_ptr<olc::vf2d[]> uv;
+			std::unique_ptr<float[]> w;
+			std::unique_ptr<olc::Pixel[]> tint;
+			uint32_t nCapacity = 0;
+			uint32_t nUsed = 0;
+		};
+		std::vector<Block> vBlocks;
+		size_t nBlock = 0;
+	};
+
 	struct LayerDesc
 	{
 		olc::vf2d vOffset = { 0, 0 };
@@ -905,6 +1028,7 @@ namespace olc
 		olc::Renderable pDrawTarget;
 		uint32_t nResID = 0;
 		std::vector<DecalInstance> vecDecalInstance;
+		DecalArena decalArena;
 		olc::Pixel tint = olc::WHITE;
 		std::function<void()> funcHook = nullptr;
 	};
@@ -928,6 +1052,12 @@ namespace olc
 		virtual void       ApplyTexture(uint32_t id) = 0;
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) = 0;
 		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) = 0;
+		// Makes the graphics context current on the calling thread, or releases it. Returns
+		// false if the context cannot move between threads
+		virtual bool       MakeCurrent(const bool bCurrent) { UNUSED(bCurrent); return false; }
+		// Copies the frame last drawn, bottom row first, into spr, which is already sized
+		// as the window. Renderers with nothing to read leave it untouched
+		virtual void       ReadFrame(olc::Sprite* spr) { UNUSED(spr); }
 		static olc::PixelGameEngine* ptrPGE;
 	};
 
@@ -948,6 +1078,7 @@ namespace olc
 	};
 
 	class PGEX;
+	class Renderer_Pipelined;
 
 	// The Static Twins (plus one)
 	static std::unique_ptr<Renderer> renderer;
@@ -963,8 +1094,10 @@ namespace olc
 		PixelGameEngine();
 		virtual ~PixelGameEngine();
 	public:
+		// pipelined: a render thread uploads and presents each frame while OnUserUpdate() runs
+		// the next one. Custom layer render functions are then called on the render thread
 		olc::rcode Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h,
-			bool full_screen = false, bool vsync = false, bool cohesion = false);
+			bool full_screen = false, bool vsync = false, bool cohesion = false, bool pipelined = false);
 		olc::rcode Start();
 
 	public: // User Override Interfaces
@@ -1021,6 +1154,11 @@ namespace olc
 		uint32_t GetFPS() const;
 		// Gets last update of elapsed time
 		float GetElapsedTime() const;
+		// Gets frame time statistics for the last whole second
+		const olc::FrameStats& GetFrameStats() const;
+		// Gets every input event since the last frame, oldest first. Unlike GetKey(),
+		// this keeps a press and release that both happen within one frame apart
+		const std::vector<olc::InputEvent>& GetInputEvents() const;
 		// Gets Actual Window size
 		const olc::vi2d& GetWindowSize() const;
 		// Gets pixel scale
@@ -1032,6 +1170,11 @@ namespace olc
 		// Gets any files dropped this frame
 		const std::vector<std::string>& GetDroppedFiles() const;
 		const olc::vi2d& GetDroppedFilesPoint() const;
+		// Copies the last frame drawn into pSprite, sized as the window. Meant for the
+		// offscreen renderer (OLC_PGE_OFFSCREEN), which keeps each frame until the next.
+		// Call on the engine thread while the engine runs, e.g. from OnUserUpdate() - once
+		// Start() has returned the device is gone, and all that reads back is black
+		void ReadFrame(olc::Sprite* pSprite);
 
 	public: // CONFIGURATION ROUTINES
 		// Layer targeting functions
@@ -1047,6 +1190,11 @@ namespace olc
 		std::vector<LayerDesc>& GetLayers();
 		uint32_t CreateLayer();
 
+		// Caps the frame rate, sleeping away what is left of each frame. 0 runs flat out
+		void SetFrameRateLimit(float fFramesPerSecond);
+		// Passes the mean of the last nFrames frame times as fElapsedTime. 1 is unsmoothed
+		void SetFrameTimeSmoothing(uint32_t nFrames);
+
 		// Change the pixel mode for different optimisations
 		// olc::Pixel::NORMAL = No transparency
 		// olc::Pixel::MASK   = Transparent if alpha is < 255
@@ -1086,7 +1234,7 @@ namespace olc
 		void FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p = olc::WHITE);
 		void FillTriangle(const olc::vi2d& pos1, const olc::vi2d& pos2, const olc::vi2d& pos3, Pixel p = olc::WHITE);
 		// Fill a textured and coloured triangle
-		void FillTexturedTriangle(const std::vector<olc::vf2d>& vPoints, std::vector<olc::vf2d> vTex, std::vector<olc::Pixel> vColour, olc::Sprite* sprTex);
+		void FillTexturedTriangle(const std::vector<olc::vf2d>& vPoints, const std::vector<olc::vf2d>& vTex, const std::vector<olc::Pixel>& vColour, olc::Sprite* sprTex);
 		void FillTexturedPolygon(const std::vector<olc::vf2d>& vPoints, const std::vector<olc::vf2d>& vTex, const std::vector<olc::Pixel>& vColour, olc::Sprite* sprTex, olc::DecalStructure structure = olc::DecalStructure::LIST);
 		// Draws an entire sprite at location (x,y)
 		void DrawSprite(int32_t x, int32_t y, Sprite* sprite, uint32_t scale = 1, uint8_t flip = olc::Sprite::NONE);
@@ -1235,10 +1383,28 @@ namespace olc
 		uint8_t		nTargetLayer = 0;
 		uint32_t	nLastFPS = 0;
 		bool        bPixelCohesion = false;
+		bool        bPipelined = false;
+		olc::Renderer_Pipelined* pPipeline = nullptr;
 		DecalMode   nDecalMode = DecalMode::NORMAL;
 		DecalStructure nDecalStructure = DecalStructure::FAN;
 		std::function<olc::Pixel(const int x, const int y, const olc::Pixel&, const olc::Pixel&)> funcPixelMode;
-		std::chrono::time_point<std::chrono::system_clock> m_tp1, m_tp2;
+		std::chrono::time_point<std::chrono::steady_clock> m_tp1, m_tp2;
+
+		// Frame pacing
+		float		fFrameRateLimit = 0.0f;
+		float		fSleepMargin = 0.002f;
+		std::chrono::time_point<std::chrono::steady_clock> tpFrameDeadline;
+		bool		bFrameLate = false;
+		std::vector<float> vFrameTimes = { 0.0f };
+		size_t		nFrameTimeIndex = 0;
+		size_t		nFrameTimeCount = 0;
+		olc::FrameStats frameStats;
+		uint32_t	nStatFrames = 0;
+		uint32_t	nStatLate = 0;
+		double		dStatSum = 0.0;
+		double		dStatSumSq = 0.0;
+		float		fStatMin = 0.0f;
+		float		fStatMax = 0.0f;
 		std::vector<olc::vi2d> vFontSpacing;
 		std::vector<std::string> vDroppedFiles;
 		std::vector<std::string> vDroppedFilesCache;
@@ -1269,15 +1435,34 @@ namespace olc
 		// State of keyboard		
 		bool		pKeyNewState[256] = { 0 };
 		bool		pKeyOldState[256] = { 0 };
+		uint8_t		pKeyToggles[256] = { 0 };
 		HWButton	pKeyboardState[256] = { 0 };
 
 		// State of mouse
 		bool		pMouseNewState[nMouseButtons] = { 0 };
 		bool		pMouseOldState[nMouseButtons] = { 0 };
+		uint8_t		pMouseToggles[nMouseButtons] = { 0 };
 		HWButton	pMouseState[nMouseButtons] = { 0 };
 
+		// Input events, gathered from the platform until the next frame takes them
+		std::mutex	muxInputEvents;
+		std::vector<olc::InputEvent> vInputEvents;
+		std::vector<olc::InputEvent> vInputEventsCache;
+		void		PushInputEvent(olc::InputEvent e, std::chrono::steady_clock::time_point tp);
+
 		// The main engine thread
 		void		EngineThread();
+		// Waits out the rest of the frame when the frame rate is limited
+		void		PaceFrame();
+		// Runs frames while a render thread draws and presents the one before
+		void		RunPipelined();
+		// Hands the layers of the frame just updated to the render thread
+		void		SubmitFrame();
+
+		// Queues a decal of nPoints vertices on the target layer, to be filled in by the caller
+		olc::DecalInstance& NewDecalInstance(olc::Decal* decal, const uint32_t nPoints);
+		// Software rasterises one triangle, the work behind FillTexturedTriangle/Polygon
+		void RasterTriangle(const olc::vf2d* pPos, const olc::vf2d* pTex, const olc::Pixel* pCol, const olc::Sprite* sprTex);
 
 
 		// If anything sets this flag to false, the engine
@@ -1286,15 +1471,16 @@ namespace olc
 
 	public:
 		// "Break In" Functions
-		void olc_UpdateMouse(int32_t x, int32_t y);
-		void olc_UpdateMouseWheel(int32_t delta);
+		// Platforms that know when an input happened pass it as tp, otherwise it is now
+		void olc_UpdateMouse(int32_t x, int32_t y, std::chrono::steady_clock::time_point tp = {});
+		void olc_UpdateMouseWheel(int32_t delta, std::chrono::steady_clock::time_point tp = {});
 		void olc_UpdateWindowSize(int32_t x, int32_t y);
 		void olc_UpdateViewport();
 		void olc_ConstructFontSheet();
 		void olc_CoreUpdate();
 		void olc_PrepareEngine();
-		void olc_UpdateMouseState(int32_t button, bool state);
-		void olc_UpdateKeyState(int32_t key, bool state);
+		void olc_UpdateMouseState(int32_t button, bool state, std::chrono::steady_clock::time_point tp = {});
+		void olc_UpdateKeyState(int32_t key, bool state, std::chrono::steady_clock::time_point tp = {});
 		void olc_UpdateMouseFocus(bool state);
 		void olc_UpdateKeyFocus(bool state);
 		void olc_Terminate();
@@ -1383,10 +1569,18 @@ namespace olc
 		#define GL_CLAMP GL_CLAMP_TO_EDGE
 	#endif
 
+	#if defined(OLC_PLATFORM_HEADLESS)
+		#include <EGL/egl.h>
+		#include <EGL/eglext.h>
+		#define CALLSTYLE
+	#endif
+
 namespace olc
 {
 	typedef char GLchar;
 	typedef ptrdiff_t GLsizeiptr;
+	typedef ptrdiff_t GLintptr;
+	typedef void* locSync_t;
 
 	typedef GLuint CALLSTYLE locCreateShader_t(GLenum type);
 	typedef GLuint CALLSTYLE locCreateProgram_t(void);
@@ -1416,6 +1610,13 @@ namespace olc
 	typedef void CALLSTYLE locFrameBufferTexture2D_t(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
 	typedef void CALLSTYLE locDrawBuffers_t(GLsizei n, const GLenum* bufs);
 	typedef void CALLSTYLE locBlendFuncSeparate_t(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+	typedef void CALLSTYLE locDeleteBuffers_t(GLsizei n, const GLuint* buffers);
+	typedef void CALLSTYLE locBufferStorage_t(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	typedef void* CALLSTYLE locMapBufferRange_t(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	typedef GLboolean CALLSTYLE locUnmapBuffer_t(GLenum target);
+	typedef locSync_t CALLSTYLE locFenceSync_t(GLenum condition, GLbitfield flags);
+	typedef GLenum CALLSTYLE locClientWaitSync_t(locSync_t sync, GLbitfield flags, uint64_t timeout);
+	typedef void CALLSTYLE locDeleteSync_t(locSync_t sync);
 
 #if defined(OLC_PLATFORM_WINAPI)
 	typedef void __stdcall locSwapInterval_t(GLsizei n);
@@ -1425,6 +1626,10 @@ namespace olc
 	typedef int(locSwapInterval_t)(X11::Display* dpy, X11::GLXDrawable drawable, int interval);
 #endif
 
+#if defined(OLC_PLATFORM_HEADLESS)
+	typedef EGLBoolean(locSwapInterval_t)(EGLDisplay display, EGLint interval);
+#endif
+
 #if defined(OLC_PLATFORM_EMSCRIPTEN)
 	typedef void CALLSTYLE locShaderSource_t(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
 	typedef EGLBoolean(locSwapInterval_t)(EGLDisplay display, EGLint interval);
@@ -1567,9 +1772,96 @@ namespace olc
 	Pixel PixelLerp(const olc::Pixel& p1, const olc::Pixel& p2, float t)
 	{ return (p2 * t) + p1 * (1.0f - t); }
 
+	// O------------------------------------------------------------------------------O
+	// | olc::PixelStore IMPLEMENTATION                                               |
+	// O------------------------------------------------------------------------------O
+	PixelStore::PixelStore(const PixelStore& p)
+	{ *this = p; }
+
+	PixelStore::PixelStore(PixelStore&& p) noexcept
+	{ *this = std::move(p); }
+
+	PixelStore& PixelStore::operator=(const PixelStore& p)
+	{
+		if (this == &p) return *this;
+		// A copy always owns its pixels. Sharing the mapping would share its private
+		// pages too, and writes to one copy would show up in the other
+		if (p.pMapping)
+			vOwned.assign(p.pPixels, p.pPixels + p.nPixels);
+		else
+			vOwned = p.vOwned;
+		pMapping.reset();
+		nPixels = p.nPixels;
+		pPixels = vOwned.data();
+		return *this;
+	}
+
+	PixelStore& PixelStore::operator=(PixelStore&& p) noexcept
+	{
+		if (this == &p) return *this;
+		vOwned = std::move(p.vOwned);
+		pMapping = std::move(p.pMapping);
+		nPixels = p.nPixels;
+		pPixels = pMapping ? p.pPixels : vOwned.data();
+		p.pPixels = nullptr; p.nPixels = 0;
+		return *this;
+	}
+
+	void PixelStore::Map(std::shared_ptr<olc::MappedFile> pFile, size_t nOffset, size_t nCount)
+	{
+		vOwned.clear();
+		vOwned.shrink_to_fit();
+		pMapping = pFile;
+		pPixels = reinterpret_cast<Pixel*>(pMapping->data() + nOffset);
+		nPixels = nCount;
+	}
+
+	void PixelStore::Detach()
+	{
+		if (!pMapping) return;
+		vOwned.assign(pPixels, pPixels + nPixels);
+		pMapping.reset();
+	}
+
+	void PixelStore::resize(size_t n)
+	{
+		Detach();
+		vOwned.resize(n);
+		pPixels = vOwned.data(); nPixels = n;
+	}
+
+	void PixelStore::resize(size_t n, const Pixel& p)
+	{
+		Detach();
+		vOwned.resize(n, p);
+		pPixels = vOwned.data(); nPixels = n;
+	}
+
+	void PixelStore::clear()
+	{
+		vOwned.clear();
+		pMapping.reset();
+		pPixels = nullptr; nPixels = 0;
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::Sprite IMPLEMENTATION                                                   |
 	// O------------------------------------------------------------------------------O
+
+	// Header of the pre-decoded sprite format. Pixels follow at nDataOffset, stored
+	// exactly as olc::Pixel, so a mapped file can be drawn from without decoding
+	struct RawSpriteHeader
+	{
+		char     sMagic[8];
+		uint32_t nVersion;
+		int32_t  nWidth;
+		int32_t  nHeight;
+		uint32_t nDataOffset;
+		uint8_t  nReserved[40];
+	};
+	static_assert(sizeof(RawSpriteHeader) == 64, "RawSpriteHeader must stay 64 bytes");
+	static constexpr char sRawSpriteMagic[8] = { 'o', 'l', 'c', 'R', 'G', 'B', 'A', '\0' };
+
 	Sprite::Sprite()
 	{ width = 0; height = 0; }
 
@@ -1669,10 +1961,98 @@ namespace olc
 
 	olc::rcode Sprite::LoadFromFile(const std::string& sImageFile, olc::ResourcePack* pack)
 	{
-		UNUSED(pack);
+		// Pre-decoded sprites on disk bypass the image loader entirely
+		if (pack == nullptr && LoadFromRawFile(sImageFile) == olc::rcode::OK)
+			return olc::rcode::OK;
+
 		return loader->LoadImageResource(this, sImageFile, pack);
 	}
 
+	std::vector<olc::rcode> Sprite::LoadFromFiles(const std::vector<olc::Sprite*>& vSprites, const std::vector<std::string>& vFiles, size_t nThreads)
+	{
+		const size_t nFiles = std::min(vSprites.size(), vFiles.size());
+		std::vector<olc::rcode> vResults(nFiles, olc::rcode::FAIL);
+		if (!loader) return vResults;
+
+		std::atomic<size_t> nNext = 0;
+		auto worker = [&](olc::ImageLoader* pLoader)
+		{
+			for (size_t i = nNext++; i < nFiles; i = nNext++)
+			{
+				if (vSprites[i]->LoadFromRawFile(vFiles[i]) == olc::rcode::OK)
+					vResults[i] = olc::rcode::OK;
+				else
+					vResults[i] = pLoader->LoadImageResource(vSprites[i], vFiles[i], nullptr);
+			}
+		};
+
+		if (nThreads == 0) nThreads = std::max(1u, std::thread::hardware_concurrency());
+		nThreads = std::min(nThreads, nFiles);
+
+		// A loader that can't be cloned decodes everything itself
+		std::vector<std::unique_ptr<olc::ImageLoader>> vLoaders;
+		for (size_t n = 1; n < nThreads; n++)
+		{
+			auto pLoader = loader->Clone();
+			if (!pLoader) break;
+			vLoaders.push_back(std::move(pLoader));
+		}
+
+		std::vector<std::thread> vWorkers;
+		for (auto& pLoader : vLoaders)
+			vWorkers.emplace_back(worker, pLoader.get());
+		worker(loader.get());
+		for (auto& t : vWorkers) t.join();
+		return vResults;
+	}
+
+	olc::rcode Sprite::LoadFromRawFile(const std::string& sImageFile)
+	{
+		// Most files offered here are PNGs, so read the magic before mapping the whole file
+		{
+			char sMagic[sizeof(sRawSpriteMagic)];
+			std::ifstream ifs(sImageFile, std::ios::binary);
+			if (!ifs.is_open()) return olc::rcode::NO_FILE;
+			if (!ifs.read(sMagic, sizeof(sMagic)) || std::memcmp(sMagic, sRawSpriteMagic, sizeof(sMagic)) != 0)
+				return olc::rcode::FAIL;
+		}
+
+		std::shared_ptr<olc::MappedFile> pFile = olc::MappedFile::Open(sImageFile);
+		if (!pFile) return olc::rcode::NO_FILE;
+
+		RawSpriteHeader header;
+		if (pFile->size() < sizeof(RawSpriteHeader)) return olc::rcode::FAIL;
+		std::memcpy(&header, pFile->data(), sizeof(RawSpriteHeader));
+		if (std::memcmp(header.sMagic, sRawSpriteMagic, sizeof(header.sMagic)) != 0 || header.nVersion != 1)
+			return olc::rcode::FAIL;
+
+		size_t nPixels = size_t(header.nWidth) * size_t(header.nHeight);
+		if (header.nWidth <= 0 || header.nHeight <= 0 || header.nDataOffset % alignof(olc::Pixel) != 0 ||
+			header.nDataOffset + nPixels * sizeof(olc::Pixel) > pFile->size())
+			return olc::rcode::FAIL;
+
+		width = header.nWidth;
+		height = header.nHeight;
+		pColData.Map(pFile, header.nDataOffset, nPixels);
+		return olc::rcode::OK;
+	}
+
+	olc::rcode Sprite::SaveToRawFile(const std::string& sImageFile) const
+	{
+		std::ofstream ofs(sImageFile, std::ios::binary);
+		if (!ofs.is_open()) return olc::rcode::FAIL;
+
+		RawSpriteHeader header{};
+		std::memcpy(header.sMagic, sRawSpriteMagic, sizeof(header.sMagic));
+		header.nVersion = 1;
+		header.nWidth = width;
+		header.nHeight = height;
+		header.nDataOffset = sizeof(RawSpriteHeader);
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(RawSpriteHeader));
+		ofs.write(reinterpret_cast<const char*>(pColData.data()), pColData.size() * sizeof(olc::Pixel));
+		return ofs.good() ? olc::rcode::OK : olc::rcode::FAIL;
+	}
+
 	olc::Sprite* Sprite::Duplicate()
 	{
 		olc::Sprite* spr = new olc::Sprite(width, height);
@@ -1743,6 +2123,12 @@ namespace olc
 		pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
 	}
 
+	void Renderable::Create(std::unique_ptr<olc::Sprite> sprite, bool filter, bool clamp)
+	{
+		pSprite = std::move(sprite);
+		pDecal = std::make_unique<olc::Decal>(pSprite.get(), filter, clamp);
+	}
+
 	olc::rcode Renderable::Load(const std::string& sFile, ResourcePack* pack, bool filter, bool clamp)
 	{
 		pSprite = std::make_unique<olc::Sprite>();
@@ -1765,6 +2151,40 @@ namespace olc
 	olc::Sprite* Renderable::Sprite() const
 	{ return pSprite.get(); }
 
+	// O------------------------------------------------------------------------------O
+	// | olc::DecalArena IMPLEMENTATION                                               |
+	// O------------------------------------------------------------------------------O
+	void DecalArena::Allocate(olc::DecalInstance& di, const uint32_t nPoints)
+	{
+		// Move on to the next block with room, making one only if none is left
+		while (nBlock < vBlocks.size() && vBlocks[nBlock].nCapacity - vBlocks[nBlock].nUsed < nPoints)
+			nBlock++;
+		if (nBlock == vBlocks.size())
+		{
+			Block b;
+			b.nCapacity = std::max(nPoints, uint32_t(4096));
+			b.pos = std::make_unique<olc::vf2d[]>(b.nCapacity);
+			b.uv = std::make_unique<olc::vf2d[]>(b.nCapacity);
+			b.w = std::make_unique<float[]>(b.nCapacity);
+			b.tint = std::make_unique<olc::Pixel[]>(b.nCapacity);
+			vBlocks.push_back(std::move(b));
+		}
+
+		Block& b = vBlocks[nBlock];
+		di.pos = b.pos.get() + b.nUsed;
+		di.uv = b.uv.get() + b.nUsed;
+		di.w = b.w.get() + b.nUsed;
+		di.tint = b.tint.get() + b.nUsed;
+		di.points = nPoints;
+		b.nUsed += nPoints;
+	}
+
+	void DecalArena::Reset()
+	{
+		for (auto& b : vBlocks) b.nUsed = 0;
+		nBlock = 0;
+	}
+
 	// O------------------------------------------------------------------------------O
 	// | olc::ResourcePack IMPLEMENTATION                                             |
 	// O------------------------------------------------------------------------------O
@@ -1957,9 +2377,10 @@ namespace olc
 	{}
 
 
-	olc::rcode PixelGameEngine::Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h, bool full_screen, bool vsync, bool cohesion)
+	olc::rcode PixelGameEngine::Construct(int32_t screen_w, int32_t screen_h, int32_t pixel_w, int32_t pixel_h, bool full_screen, bool vsync, bool cohesion, bool pipelined)
 	{
 		bPixelCohesion = cohesion;
+		bPipelined = pipelined;
 		vScreenSize = { screen_w, screen_h };
 		vInvScreenSize = { 1.0f / float(screen_w), 1.0f / float(screen_h) };
 		vPixelSize = { pixel_w, pixel_h };
@@ -2122,6 +2543,41 @@ namespace olc
 	float PixelGameEngine::GetElapsedTime() const
 	{ return fLastElapsed; }
 
+	const olc::FrameStats& PixelGameEngine::GetFrameStats() const
+	{ return frameStats; }
+
+	void PixelGameEngine::ReadFrame(olc::Sprite* pSprite)
+	{
+		pSprite->width = vWindowSize.x;
+		pSprite->height = vWindowSize.y;
+		pSprite->pColData.resize(size_t(vWindowSize.x) * size_t(vWindowSize.y));
+		renderer->ReadFrame(pSprite);
+
+		// OpenGL reads bottom row first
+		for (int32_t y = 0; y < pSprite->height / 2; y++)
+		{
+			olc::Pixel* pTop = pSprite->GetData() + size_t(y) * size_t(pSprite->width);
+			olc::Pixel* pBottom = pSprite->GetData() + size_t(pSprite->height - 1 - y) * size_t(pSprite->width);
+			std::swap_ranges(pTop, pTop + pSprite->width, pBottom);
+		}
+	}
+
+	const std::vector<olc::InputEvent>& PixelGameEngine::GetInputEvents() const
+	{ return vInputEvents; }
+
+	void PixelGameEngine::SetFrameRateLimit(float fFramesPerSecond)
+	{
+		fFrameRateLimit = std::max(fFramesPerSecond, 0.0f);
+		tpFrameDeadline = std::chrono::steady_clock::now();
+	}
+
+	void PixelGameEngine::SetFrameTimeSmoothing(uint32_t nFrames)
+	{
+		vFrameTimes.assign(std::max(nFrames, 1u), 0.0f);
+		nFrameTimeIndex = 0;
+		nFrameTimeCount = 0;
+	}
+
 	const olc::vi2d& PixelGameEngine::GetWindowSize() const
 	{ return vWindowSize; }
 
@@ -2447,7 +2903,22 @@ namespace olc
 	// https://www.avrfreaks.net/sites/default/files/triangles.c
 	void PixelGameEngine::FillTriangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3, Pixel p)
 	{
-		auto drawline = [&](int sx, int ex, int ny) { for (int i = sx; i <= ex; i++) Draw(i, ny, p); };
+		if (!pDrawTarget) return;
+		const int32_t nTargetW = pDrawTarget->width, nTargetH = pDrawTarget->height;
+		if (std::max({ x1, x2, x3 }) < 0 || std::min({ x1, x2, x3 }) >= nTargetW ||
+			std::max({ y1, y2, y3 }) < 0 || std::min({ y1, y2, y3 }) >= nTargetH) return;
+
+		// Spans are clipped once, and written straight into the target when no blending is involved
+		auto drawline = [&](int sx, int ex, int ny)
+		{
+			if (ny < 0 || ny >= nTargetH) return;
+			sx = std::max(sx, 0); ex = std::min(ex, nTargetW - 1);
+			if (sx > ex) return;
+			if (nPixelMode == Pixel::NORMAL)
+				std::fill_n(pDrawTarget->GetData() + size_t(ny) * size_t(nTargetW) + size_t(sx), size_t(ex - sx + 1), p);
+			else
+				for (int i = sx; i <= ex; i++) Draw(i, ny, p);
+		};
 
 		int t1x, t2x, y, minx, maxx, t1xp, t2xp;
 		bool changed1 = false;
@@ -2580,118 +3051,182 @@ namespace olc
 		}
 	}
 
-	void PixelGameEngine::FillTexturedTriangle(const std::vector<olc::vf2d>& vPoints, std::vector<olc::vf2d> vTex, std::vector<olc::Pixel> vColour, olc::Sprite* sprTex)
+	void PixelGameEngine::FillTexturedTriangle(const std::vector<olc::vf2d>& vPoints, const std::vector<olc::vf2d>& vTex, const std::vector<olc::Pixel>& vColour, olc::Sprite* sprTex)
 	{
-		olc::vi2d p1 = vPoints[0];
-		olc::vi2d p2 = vPoints[1];
-		olc::vi2d p3 = vPoints[2];
+		if (vPoints.size() < 3 || vTex.size() < 3 || vColour.size() < 3)
+			return;
+		RasterTriangle(vPoints.data(), vTex.data(), vColour.data(), sprTex);
+	}
 
-		if (p2.y < p1.y){std::swap(p1.y, p2.y); std::swap(p1.x, p2.x); std::swap(vTex[0].x, vTex[1].x); std::swap(vTex[0].y, vTex[1].y); std::swap(vColour[0], vColour[1]);}
-		if (p3.y < p1.y){std::swap(p1.y, p3.y); std::swap(p1.x, p3.x); std::swap(vTex[0].x, vTex[2].x); std::swap(vTex[0].y, vTex[2].y); std::swap(vColour[0], vColour[2]);}
-		if (p3.y < p2.y){std::swap(p2.y, p3.y); std::swap(p2.x, p3.x); std::swap(vTex[1].x, vTex[2].x); std::swap(vTex[1].y, vTex[2].y); std::swap(vColour[1], vColour[2]);}
+	// Pixel centres inside all three edges are filled, as a GPU would. Edges are evaluated
+	// in 28.4 fixed point, which makes the coverage of each row an exact span - no pixel is
+	// tested individually - and the top-left rule means triangles sharing an edge never both
+	// fill it. Attributes are planes across the triangle, stepped once per pixel
+	void PixelGameEngine::RasterTriangle(const olc::vf2d* pPos, const olc::vf2d* pTex, const olc::Pixel* pCol, const olc::Sprite* sprTex)
+	{
+		if (!pDrawTarget) return;
+		const int32_t nTargetW = pDrawTarget->width, nTargetH = pDrawTarget->height;
 
-		olc::vi2d dPos1 = p2 - p1;
-		olc::vf2d dTex1 = vTex[1] - vTex[0];
-		int dcr1 = vColour[1].r - vColour[0].r;
-		int dcg1 = vColour[1].g - vColour[0].g;
-		int dcb1 = vColour[1].b - vColour[0].b;
-		int dca1 = vColour[1].a - vColour[0].a;
+		// Beyond 2^24 pixels out (or NaN) the products below could overflow, so nothing is drawn
+		int64_t vx[3], vy[3];
+		for (int i = 0; i < 3; i++)
+		{
+			if (!(std::abs(pPos[i].x) < 16777216.0f && std::abs(pPos[i].y) < 16777216.0f)) return;
+			vx[i] = std::llround(double(pPos[i].x) * 16.0);
+			vy[i] = std::llround(double(pPos[i].y) * 16.0);
+		}
 
-		olc::vi2d dPos2 = p3 - p1;
-		olc::vf2d dTex2 = vTex[2] - vTex[0];
-		int dcr2 = vColour[2].r - vColour[0].r;
-		int dcg2 = vColour[2].g - vColour[0].g;
-		int dcb2 = vColour[2].b - vColour[0].b;
-		int dca2 = vColour[2].a - vColour[0].a;
+		// Wound so the inside of every edge is positive; degenerate triangles cover nothing
+		int v[3] = { 0, 1, 2 };
+		int64_t nArea = (vx[1] - vx[0]) * (vy[2] - vy[0]) - (vy[1] - vy[0]) * (vx[2] - vx[0]);
+		if (nArea == 0) return;
+		if (nArea < 0) { std::swap(v[1], v[2]); nArea = -nArea; }
 
-		float dax_step = 0, dbx_step = 0, dcr1_step = 0, dcr2_step = 0,	dcg1_step = 0, dcg2_step = 0, dcb1_step = 0, dcb2_step = 0,	dca1_step = 0, dca2_step = 0;
-		olc::vf2d vTex1Step, vTex2Step;
+		const int64_t nMinY = std::min({ vy[0], vy[1], vy[2] }), nMaxY = std::max({ vy[0], vy[1], vy[2] });
+		const int64_t nMinX = std::min({ vx[0], vx[1], vx[2] }), nMaxX = std::max({ vx[0], vx[1], vx[2] });
+		auto floordiv = [](int64_t n, int64_t d) { return n / d - ((n % d != 0) && ((n < 0) != (d < 0))); };
 
-		if (dPos1.y)
-		{
-			dax_step = dPos1.x / (float)abs(dPos1.y);
-			vTex1Step = dTex1 / (float)abs(dPos1.y);
-			dcr1_step = dcr1 / (float)abs(dPos1.y);
-			dcg1_step = dcg1 / (float)abs(dPos1.y);
-			dcb1_step = dcb1 / (float)abs(dPos1.y);
-			dca1_step = dca1 / (float)abs(dPos1.y);
-		}
+		// Rows and columns whose pixel centres the triangle's bounds could reach, on the target
+		const int32_t nRow0 = int32_t(std::max<int64_t>(0, -floordiv(8 - nMinY, 16)));
+		const int32_t nRow1 = int32_t(std::min<int64_t>(nTargetH - 1, floordiv(nMaxY - 8, 16)));
+		const int32_t nCol0 = int32_t(std::max<int64_t>(0, -floordiv(8 - nMinX, 16)));
+		const int32_t nCol1 = int32_t(std::min<int64_t>(nTargetW - 1, floordiv(nMaxX - 8, 16)));
+		if (nRow0 > nRow1 || nCol0 > nCol1) return;
 
-		if (dPos2.y)
+		// Edge e is opposite vertex v[e]. At column X of row Y its function is nStep * X + nBase + nRowStep * Y,
+		// and the pixel is inside when that is >= 0. Edges that are neither top nor left are biased
+		// by -1 so pixel centres lying exactly on them are left to the neighbouring triangle
+		struct Edge { int64_t nStep, nBase, nRowStep; } edge[3];
+		for (int e = 0; e < 3; e++)
 		{
-			dbx_step = dPos2.x / (float)abs(dPos2.y);
-			vTex2Step = dTex2 / (float)abs(dPos2.y);
-			dcr2_step = dcr2 / (float)abs(dPos2.y);
-			dcg2_step = dcg2 / (float)abs(dPos2.y);
-			dcb2_step = dcb2 / (float)abs(dPos2.y);
-			dca2_step = dca2 / (float)abs(dPos2.y);
+			const int a = v[(e + 1) % 3], b = v[(e + 2) % 3];
+			const int64_t dx = vx[b] - vx[a], dy = vy[b] - vy[a];
+			const bool bTopLeft = dy < 0 || (dy == 0 && dx > 0);
+			edge[e].nStep = -dy * 16;
+			edge[e].nRowStep = dx * 16;
+			edge[e].nBase = -dy * (8 - vx[a]) + dx * (8 - vy[a]) - (bTopLeft ? 0 : 1);
 		}
 
-		olc::vi2d vStart;
-		olc::vi2d vEnd;
-		int vStartIdx;
-
-		for (int pass = 0; pass < 2; pass++)
+		// Columns [nLeft, nRight] of row Y inside all three edges
+		auto span = [&](int32_t y, int32_t& nLeft, int32_t& nRight)
 		{
-			if (pass == 0)
+			int64_t l = nCol0, r = nCol1;
+			for (int e = 0; e < 3; e++)
 			{
-				vStart = p1; vEnd = p2;	vStartIdx = 0;
+				const int64_t k = edge[e].nBase + edge[e].nRowStep * y;
+				if (edge[e].nStep > 0) l = std::max(l, -floordiv(k, edge[e].nStep));
+				else if (edge[e].nStep < 0) r = std::min(r, floordiv(k, -edge[e].nStep));
+				else if (k < 0) return false;
 			}
-			else
-			{
-				dPos1 = p3 - p2;
-				dTex1 = vTex[2] - vTex[1];
-				dcr1 = vColour[2].r - vColour[1].r;
-				dcg1 = vColour[2].g - vColour[1].g;
-				dcb1 = vColour[2].b - vColour[1].b;
-				dca1 = vColour[2].a - vColour[1].a;
-				dcr1_step = 0; dcg1_step = 0; dcb1_step = 0; dca1_step = 0;
-
-				if (dPos2.y) dbx_step = dPos2.x / (float)abs(dPos2.y);
-				if (dPos1.y)
-				{
-					dax_step = dPos1.x / (float)abs(dPos1.y);
-					vTex1Step = dTex1 / (float)abs(dPos1.y);
-					dcr1_step = dcr1 / (float)abs(dPos1.y);
-					dcg1_step = dcg1 / (float)abs(dPos1.y);
-					dcb1_step = dcb1 / (float)abs(dPos1.y);
-					dca1_step = dca1 / (float)abs(dPos1.y);
-				}
+			nLeft = int32_t(l); nRight = int32_t(r);
+			return l <= r;
+		};
 
-				vStart = p2; vEnd = p3; vStartIdx = 1;
-			}
+		const bool bDirect = nPixelMode == Pixel::NORMAL;
+		olc::Pixel* pTarget = pDrawTarget->GetData();
 
-			if (dPos1.y)
+		// One colour and no texture: every span is a plain fill
+		if (sprTex == nullptr && pCol[0] == pCol[1] && pCol[1] == pCol[2])
+		{
+			const olc::Pixel p = pCol[0];
+			for (int32_t y = nRow0, l, r; y <= nRow1; y++)
 			{
-				for (int i = vStart.y; i <= vEnd.y; i++)
-				{
-					int ax = int(vStart.x + (float)(i - vStart.y) * dax_step);
-					int bx = int(p1.x + (float)(i - p1.y) * dbx_step);
-
-					olc::vf2d tex_s(vTex[vStartIdx].x + (float)(i - vStart.y) * vTex1Step.x, vTex[vStartIdx].y + (float)(i - vStart.y) * vTex1Step.y);
-					olc::vf2d tex_e(vTex[0].x + (float)(i - p1.y) * vTex2Step.x, vTex[0].y + (float)(i - p1.y) * vTex2Step.y);
-
-					olc::Pixel col_s(vColour[vStartIdx].r + uint8_t((float)(i - vStart.y) * dcr1_step), vColour[vStartIdx].g + uint8_t((float)(i - vStart.y) * dcg1_step),
-						vColour[vStartIdx].b + uint8_t((float)(i - vStart.y) * dcb1_step), vColour[vStartIdx].a + uint8_t((float)(i - vStart.y) * dca1_step));
+				if (!span(y, l, r)) continue;
+				if (bDirect)
+					std::fill_n(pTarget + size_t(y) * size_t(nTargetW) + size_t(l), size_t(r - l + 1), p);
+				else
+					for (int32_t x = l; x <= r; x++) Draw(x, y, p);
+			}
+			return;
+		}
 
-					olc::Pixel col_e(vColour[0].r + uint8_t((float)(i - p1.y) * dcr2_step), vColour[0].g + uint8_t((float)(i - p1.y) * dcg2_step),
-						vColour[0].b + uint8_t((float)(i - p1.y) * dcb2_step), vColour[0].a + uint8_t((float)(i - p1.y) * dca2_step));
+		// Texture coordinates in texels, then colour channels, as planes over the triangle
+		constexpr int nAttr = 6;
+		const float fTexW = sprTex != nullptr ? float(sprTex->width) : 0.0f;
+		const float fTexH = sprTex != nullptr ? float(sprTex->height) : 0.0f;
+		float fValue[3][nAttr];
+		for (int i = 0; i < 3; i++)
+		{
+			const olc::vf2d t = pTex[v[i]];
+			const olc::Pixel c = pCol[v[i]];
+			const float f[nAttr] = { t.x * fTexW, t.y * fTexH, float(c.r), float(c.g), float(c.b), float(c.a) };
+			std::copy(f, f + nAttr, fValue[i]);
+		}
 
-					if (ax > bx) { std::swap(ax, bx); std::swap(tex_s, tex_e); std::swap(col_s, col_e); }
+		// The barycentric weight of v[e] is edge e's function over the area, so each plane's
+		// gradient is the weighted sum of the edge gradients
+		const double dArea = double(nArea);
+		float fDx[nAttr], fDy[nAttr];
+		for (int k = 0; k < nAttr; k++)
+		{
+			double dx = 0.0, dy = 0.0;
+			for (int e = 0; e < 3; e++)
+			{
+				dx += fValue[e][k] * double(edge[e].nStep) / dArea;
+				dy += fValue[e][k] * double(edge[e].nRowStep) / dArea;
+			}
+			fDx[k] = float(dx); fDy[k] = float(dy);
+		}
+		const float fOriginX = float(vx[v[0]]) / 16.0f, fOriginY = float(vy[v[0]]) / 16.0f;
 
-					float tstep = 1.0f / ((float)(bx - ax));
-					float t = 0.0f;
+		// Each span starts from the planes, so rounding never accumulates beyond one row
+		auto raster = [&](auto fetch)
+		{
+			for (int32_t y = nRow0, l, r; y <= nRow1; y++)
+			{
+				if (!span(y, l, r)) continue;
+				const float fx = float(l) + 0.5f - fOriginX, fy = float(y) + 0.5f - fOriginY;
+				float a[nAttr];
+				for (int k = 0; k < nAttr; k++) a[k] = fValue[0][k] + fDx[k] * fx + fDy[k] * fy;
 
-					for (int j = ax; j < bx; j++)
-					{
-						olc::Pixel pixel = PixelLerp(col_s, col_e, t);
-						if (sprTex != nullptr) pixel *= sprTex->Sample(tex_s.lerp(tex_e, t));
-						Draw(j, i, pixel);
-						t += tstep;
-					}
+				olc::Pixel* pRow = pTarget + size_t(y) * size_t(nTargetW);
+				for (int32_t x = l; x <= r; x++)
+				{
+					const olc::Pixel t = fetch(a[0], a[1]);
+					const olc::Pixel p(
+						uint8_t(std::clamp(a[2], 0.0f, 255.0f) * float(t.r) * (1.0f / 255.0f)),
+						uint8_t(std::clamp(a[3], 0.0f, 255.0f) * float(t.g) * (1.0f / 255.0f)),
+						uint8_t(std::clamp(a[4], 0.0f, 255.0f) * float(t.b) * (1.0f / 255.0f)),
+						uint8_t(std::clamp(a[5], 0.0f, 255.0f) * float(t.a) * (1.0f / 255.0f)));
+					if (bDirect) pRow[x] = p; else Draw(x, y, p);
+					for (int k = 0; k < nAttr; k++) a[k] += fDx[k];
 				}
 			}
-		}			
+		};
+
+		if (sprTex == nullptr)
+		{
+			raster([](float, float) { return olc::WHITE; });
+			return;
+		}
+
+		// Sprite::Sample(), with its sampling mode decided once per triangle rather than per pixel
+		const olc::Pixel* pTexels = sprTex->pColData.data();
+		const int32_t nTexW = sprTex->width, nTexH = sprTex->height;
+		switch (sprTex->modeSample)
+		{
+		case olc::Sprite::Mode::PERIODIC:
+			raster([=](float u, float v)
+				{
+					const int32_t sx = std::min(int32_t(u), nTexW - 1), sy = std::min(int32_t(v), nTexH - 1);
+					return pTexels[abs(sy % nTexH) * nTexW + abs(sx % nTexW)];
+				});
+			break;
+		case olc::Sprite::Mode::CLAMP:
+			raster([=](float u, float v)
+				{
+					const int32_t sx = std::clamp(int32_t(u), 0, nTexW - 1), sy = std::clamp(int32_t(v), 0, nTexH - 1);
+					return pTexels[sy * nTexW + sx];
+				});
+			break;
+		default:
+			raster([=](float u, float v)
+				{
+					const int32_t sx = std::min(int32_t(u), nTexW - 1), sy = std::min(int32_t(v), nTexH - 1);
+					return (sx >= 0 && sy >= 0) ? pTexels[sy * nTexW + sx] : olc::Pixel(0, 0, 0, 0);
+				});
+			break;
+		}
 	}
 
 	void PixelGameEngine::FillTexturedPolygon(const std::vector<olc::vf2d>& vPoints, const std::vector<olc::vf2d>& vTex, const std::vector<olc::Pixel>& vColour, olc::Sprite* sprTex, olc::DecalStructure structure)
@@ -2701,41 +3236,31 @@ namespace olc
 			return; // Meaningless, so do nothing
 		}
 
-		if (vPoints.size() < 3 || vTex.size() < 3 || vColour.size() < 3)
+		if (vPoints.size() < 3 || vTex.size() < vPoints.size() || vColour.size() < vPoints.size())
 			return;
 
 		if (structure == olc::DecalStructure::LIST)
 		{			
-			for (int tri = 0; tri < vPoints.size() / 3; tri++)
-			{
-				std::vector<olc::vf2d> vP = { vPoints[tri * 3 + 0], vPoints[tri * 3 + 1], vPoints[tri * 3 + 2] };
-				std::vector<olc::vf2d> vT = { vTex[tri * 3 + 0], vTex[tri * 3 + 1], vTex[tri * 3 + 2] };
-				std::vector<olc::Pixel> vC = { vColour[tri * 3 + 0], vColour[tri * 3 + 1], vColour[tri * 3 + 2] };
-				FillTexturedTriangle(vP, vT, vC, sprTex);
-			}
+			for (size_t tri = 0; tri < vPoints.size() / 3; tri++)
+				RasterTriangle(&vPoints[tri * 3], &vTex[tri * 3], &vColour[tri * 3], sprTex);
 			return;
 		}
 
 		if (structure == olc::DecalStructure::STRIP)
 		{
-			for (int tri = 2; tri < vPoints.size(); tri++)
-			{
-				std::vector<olc::vf2d> vP = { vPoints[tri - 2], vPoints[tri-1], vPoints[tri] };
-				std::vector<olc::vf2d> vT = { vTex[tri - 2], vTex[tri - 1], vTex[tri] };
-				std::vector<olc::Pixel> vC = { vColour[tri - 2], vColour[tri - 1], vColour[tri] };
-				FillTexturedTriangle(vP, vT, vC, sprTex);
-			}
+			for (size_t tri = 2; tri < vPoints.size(); tri++)
+				RasterTriangle(&vPoints[tri - 2], &vTex[tri - 2], &vColour[tri - 2], sprTex);
 			return;
 		}
 
 		if (structure == olc::DecalStructure::FAN)
 		{
-			for (int tri = 2; tri < vPoints.size(); tri++)
+			for (size_t tri = 2; tri < vPoints.size(); tri++)
 			{
-				std::vector<olc::vf2d> vP = { vPoints[0], vPoints[tri - 1], vPoints[tri] };
-				std::vector<olc::vf2d> vT = { vTex[0], vTex[tri - 1], vTex[tri] };
-				std::vector<olc::Pixel> vC = { vColour[0], vColour[tri - 1], vColour[tri] };
-				FillTexturedTriangle(vP, vT, vC, sprTex);
+				const olc::vf2d vP[3] = { vPoints[0], vPoints[tri - 1], vPoints[tri] };
+				const olc::vf2d vT[3] = { vTex[0], vTex[tri - 1], vTex[tri] };
+				const olc::Pixel vC[3] = { vColour[0], vColour[tri - 1], vColour[tri] };
+				RasterTriangle(vP, vT, vC, sprTex);
 			}
 			return;
 		}
@@ -2822,6 +3347,18 @@ namespace olc
 	void PixelGameEngine::SetDecalStructure(const olc::DecalStructure& structure)
 	{ nDecalStructure = structure; }
 
+	olc::DecalInstance& PixelGameEngine::NewDecalInstance(olc::Decal* decal, const uint32_t nPoints)
+	{
+		LayerDesc& layer = vLayers[nTargetLayer];
+		layer.vecDecalInstance.emplace_back();
+		DecalInstance& di = layer.vecDecalInstance.back();
+		layer.decalArena.Allocate(di, nPoints);
+		di.decal = decal;
+		di.mode = nDecalMode;
+		di.structure = nDecalStructure;
+		return di;
+	}
+
 	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
 		olc::vf2d vScreenSpacePos =
@@ -2841,18 +3378,12 @@ namespace olc
 		olc::vf2d vQuantisedPos = ((vScreenSpacePos * vWindow) + olc::vf2d(0.5f, 0.5f)).floor() / vWindow;
 		olc::vf2d vQuantisedDim = ((vScreenSpaceDim * vWindow) + olc::vf2d(0.5f, -0.5f)).ceil() / vWindow;
 
-		DecalInstance di;
-		di.points = 4;
-		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.pos = { { vQuantisedPos.x, vQuantisedPos.y }, { vQuantisedPos.x, vQuantisedDim.y }, { vQuantisedDim.x, vQuantisedDim.y }, { vQuantisedDim.x, vQuantisedPos.y } };
+		DecalInstance& di = NewDecalInstance(decal, 4);
+		di.pos[0] = { vQuantisedPos.x, vQuantisedPos.y }; di.pos[1] = { vQuantisedPos.x, vQuantisedDim.y }; di.pos[2] = { vQuantisedDim.x, vQuantisedDim.y }; di.pos[3] = { vQuantisedDim.x, vQuantisedPos.y };
 		olc::vf2d uvtl = (source_pos + olc::vf2d(0.0001f, 0.0001f)) * decal->vUVScale;
 		olc::vf2d uvbr = (source_pos + source_size - olc::vf2d(0.0001f, 0.0001f)) * decal->vUVScale;
-		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
-		di.w = { 1,1,1,1 };
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y }; di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+		for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
 	}
 
 	void PixelGameEngine::DrawPartialDecal(const olc::vf2d& pos, const olc::vf2d& size, olc::Decal* decal, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
@@ -2869,18 +3400,12 @@ namespace olc
 			vScreenSpacePos.y - (2.0f * size.y * vInvScreenSize.y)
 		};
 
-		DecalInstance di;
-		di.points = 4;
-		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.pos = { { vScreenSpacePos.x, vScreenSpacePos.y }, { vScreenSpacePos.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpacePos.y } };
+		DecalInstance& di = NewDecalInstance(decal, 4);
+		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y }; di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y }; di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y }; di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
 		olc::vf2d uvtl = (source_pos) * decal->vUVScale;
 		olc::vf2d uvbr = uvtl + ((source_size) * decal->vUVScale);
-		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
-		di.w = { 1,1,1,1 };
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y }; di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
+		for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
 	}
 
 
@@ -2898,27 +3423,15 @@ namespace olc
 			vScreenSpacePos.y - (2.0f * (float(decal->sprite->height) * vInvScreenSize.y)) * scale.y
 		};
 
-		DecalInstance di;
-		di.decal = decal;
-		di.points = 4;
-		di.tint = { tint, tint, tint, tint };
-		di.pos = { { vScreenSpacePos.x, vScreenSpacePos.y }, { vScreenSpacePos.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpaceDim.y }, { vScreenSpaceDim.x, vScreenSpacePos.y } };
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
-		di.w = { 1, 1, 1, 1 };
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		DecalInstance& di = NewDecalInstance(decal, 4);
+		di.pos[0] = { vScreenSpacePos.x, vScreenSpacePos.y }; di.pos[1] = { vScreenSpacePos.x, vScreenSpaceDim.y }; di.pos[2] = { vScreenSpaceDim.x, vScreenSpaceDim.y }; di.pos[3] = { vScreenSpaceDim.x, vScreenSpacePos.y };
+		di.uv[0] = { 0.0f, 0.0f }; di.uv[1] = { 0.0f, 1.0f }; di.uv[2] = { 1.0f, 1.0f }; di.uv[3] = { 1.0f, 0.0f };
+		for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
 	}
 
 	void PixelGameEngine::DrawExplicitDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d* uv, const olc::Pixel* col, uint32_t elements)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.pos.resize(elements);
-		di.uv.resize(elements);
-		di.w.resize(elements);
-		di.tint.resize(elements);
-		di.points = elements;
+		DecalInstance& di = NewDecalInstance(decal, elements);
 		for (uint32_t i = 0; i < elements; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2926,20 +3439,11 @@ namespace olc
 			di.tint[i] = col[i];
 			di.w[i] = 1.0f;
 		}
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const olc::Pixel tint)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		DecalInstance& di = NewDecalInstance(decal, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2947,20 +3451,11 @@ namespace olc
 			di.tint[i] = tint;
 			di.w[i] = 1.0f;
 		}
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const std::vector<olc::Pixel> &tint)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		DecalInstance& di = NewDecalInstance(decal, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2968,29 +3463,24 @@ namespace olc
 			di.tint[i] = tint[i];
 			di.w[i] = 1.0f;
 		}
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<olc::vf2d>& uv, const std::vector<olc::Pixel>& colours, const olc::Pixel tint)
 	{
-		std::vector<olc::Pixel> newColours(colours.size(), olc::WHITE);
-		std::transform(colours.begin(), colours.end(), newColours.begin(),
-			[&tint](const olc::Pixel pin) {	return pin * tint; });
-		DrawPolygonDecal(decal, pos, uv, newColours);
+		DecalInstance& di = NewDecalInstance(decal, uint32_t(pos.size()));
+		for (uint32_t i = 0; i < di.points; i++)
+		{
+			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
+			di.uv[i] = uv[i];
+			di.tint[i] = colours[i] * tint;
+			di.w[i] = 1.0f;
+		}
 	}
 
 
 	void PixelGameEngine::DrawPolygonDecal(olc::Decal* decal, const std::vector<olc::vf2d>& pos, const std::vector<float>& depth, const std::vector<olc::vf2d>& uv, const olc::Pixel tint)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		DecalInstance& di = NewDecalInstance(decal, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
@@ -2998,22 +3488,13 @@ namespace olc
 			di.tint[i] = tint;
 			di.w[i] = 1.0f;
 		}
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 #ifdef OLC_ENABLE_EXPERIMENTAL
 	// Lightweight 3D
 	void PixelGameEngine::LW3D_DrawTriangles(olc::Decal* decal, const std::vector<std::array<float, 3>>& pos, const std::vector<olc::vf2d>& tex, const std::vector<olc::Pixel>& col)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.points = uint32_t(pos.size());
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
+		DecalInstance& di = NewDecalInstance(decal, uint32_t(pos.size()));
 		for (uint32_t i = 0; i < di.points; i++)
 		{
 			di.pos[i] = { pos[i][0], pos[i][1] };
@@ -3022,35 +3503,19 @@ namespace olc
 			di.tint[i] = col[i];			
 		}
 		di.mode = DecalMode::MODEL3D;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		di.structure = DecalStructure::FAN;
 	}
 #endif
 
 	void PixelGameEngine::DrawLineDecal(const olc::vf2d& pos1, const olc::vf2d& pos2, Pixel p)
 	{
+		std::array<olc::vf2d, 2> points = { { pos1, pos2 } };
+		std::array<olc::vf2d, 2> uvs = { { {0,0}, {0,0} } };
+		std::array<olc::Pixel, 2> cols = { { p, p } };
 		auto m = nDecalMode;
 		nDecalMode = olc::DecalMode::WIREFRAME;
-		DrawPolygonDecal(nullptr, { pos1, pos2 }, { {0, 0}, {0,0} }, p);
+		DrawExplicitDecal(nullptr, points.data(), uvs.data(), cols.data(), 2);
 		nDecalMode = m;
-
-		/*DecalInstance di;
-		di.decal = nullptr;
-		di.points = uint32_t(2);
-		di.pos.resize(di.points);
-		di.uv.resize(di.points);
-		di.w.resize(di.points);
-		di.tint.resize(di.points);
-		di.pos[0] = { (pos1.x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos1.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
-		di.uv[0] = { 0.0f, 0.0f };
-		di.tint[0] = p;
-		di.w[0] = 1.0f;
-		di.pos[1] = { (pos2.x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos2.y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
-		di.uv[1] = { 0.0f, 0.0f };
-		di.tint[1] = p;
-		di.w[1] = 1.0f;
-		di.mode = olc::DecalMode::WIREFRAME;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);*/
 	}
 
 	void PixelGameEngine::DrawRectDecal(const olc::vf2d& pos, const olc::vf2d& size, const olc::Pixel col)
@@ -3085,13 +3550,9 @@ namespace olc
 
 	void PixelGameEngine::DrawRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.pos.resize(4);
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
-		di.w = { 1, 1, 1, 1 };
-		di.tint = { tint, tint, tint, tint };
-		di.points = 4;
+		DecalInstance& di = NewDecalInstance(decal, 4);
+		di.uv[0] = { 0.0f, 0.0f }; di.uv[1] = { 0.0f, 1.0f }; di.uv[2] = { 1.0f, 1.0f }; di.uv[3] = { 1.0f, 0.0f };
+		for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
 		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
 		di.pos[1] = (olc::vf2d(0.0f, float(decal->sprite->height)) - center) * scale;
 		di.pos[2] = (olc::vf2d(float(decal->sprite->width), float(decal->sprite->height)) - center) * scale;
@@ -3102,22 +3563,14 @@ namespace olc
 			di.pos[i] = pos + olc::vf2d(di.pos[i].x * c - di.pos[i].y * s, di.pos[i].x * s + di.pos[i].y * c);
 			di.pos[i] = di.pos[i] * vInvScreenSize * 2.0f - olc::vf2d(1.0f, 1.0f);
 			di.pos[i].y *= -1.0f;
-			di.w[i] = 1;
 		}
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 	}
 
 
 	void PixelGameEngine::DrawPartialRotatedDecal(const olc::vf2d& pos, olc::Decal* decal, const float fAngle, const olc::vf2d& center, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::vf2d& scale, const olc::Pixel& tint)
 	{
-		DecalInstance di;
-		di.decal = decal;
-		di.points = 4;
-		di.tint = { tint, tint, tint, tint };
-		di.w = { 1, 1, 1, 1 };
-		di.pos.resize(4);
+		DecalInstance& di = NewDecalInstance(decal, 4);
+		for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
 		di.pos[0] = (olc::vf2d(0.0f, 0.0f) - center) * scale;
 		di.pos[1] = (olc::vf2d(0.0f, source_size.y) - center) * scale;
 		di.pos[2] = (olc::vf2d(source_size.x, source_size.y) - center) * scale;
@@ -3132,28 +3585,20 @@ namespace olc
 
 		olc::vf2d uvtl = source_pos * decal->vUVScale;
 		olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-		di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
-		di.mode = nDecalMode;
-		di.structure = nDecalStructure;
-		vLayers[nTargetLayer].vecDecalInstance.push_back(di);
+		di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y }; di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
 	}
 
 	void PixelGameEngine::DrawPartialWarpedDecal(olc::Decal* decal, const olc::vf2d* pos, const olc::vf2d& source_pos, const olc::vf2d& source_size, const olc::Pixel& tint)
 	{
-		DecalInstance di;
-		di.points = 4;
-		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.w = { 1, 1, 1, 1 };
-		di.pos.resize(4);
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
 		olc::vf2d center;
 		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
 		if (rd != 0)
 		{
+			DecalInstance& di = NewDecalInstance(decal, 4);
+			for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
 			olc::vf2d uvtl = source_pos * decal->vUVScale;
 			olc::vf2d uvbr = uvtl + (source_size * decal->vUVScale);
-			di.uv = { { uvtl.x, uvtl.y }, { uvtl.x, uvbr.y }, { uvbr.x, uvbr.y }, { uvbr.x, uvtl.y } };
+			di.uv[0] = { uvtl.x, uvtl.y }; di.uv[1] = { uvtl.x, uvbr.y }; di.uv[2] = { uvbr.x, uvbr.y }; di.uv[3] = { uvbr.x, uvtl.y };
 
 			rd = 1.0f / rd;
 			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
@@ -3166,9 +3611,6 @@ namespace olc
 				di.uv[i] *= q; di.w[i] *= q;
 				di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
 			}
-			di.mode = nDecalMode;
-			di.structure = nDecalStructure;
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 		}
 	}
 
@@ -3176,17 +3618,13 @@ namespace olc
 	{
 		// Thanks Nathan Reed, a brilliant article explaining whats going on here
 		// http://www.reedbeta.com/blog/quadrilateral-interpolation-part-1/
-		DecalInstance di;
-		di.points = 4;
-		di.decal = decal;
-		di.tint = { tint, tint, tint, tint };
-		di.w = { 1, 1, 1, 1 };
-		di.pos.resize(4);
-		di.uv = { { 0.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, 0.0f} };
 		olc::vf2d center;
 		float rd = ((pos[2].x - pos[0].x) * (pos[3].y - pos[1].y) - (pos[3].x - pos[1].x) * (pos[2].y - pos[0].y));
 		if (rd != 0)
 		{
+			DecalInstance& di = NewDecalInstance(decal, 4);
+			for (int i = 0; i < 4; i++) { di.w[i] = 1.0f; di.tint[i] = tint; }
+			di.uv[0] = { 0.0f, 0.0f }; di.uv[1] = { 0.0f, 1.0f }; di.uv[2] = { 1.0f, 1.0f }; di.uv[3] = { 1.0f, 0.0f };
 			rd = 1.0f / rd;
 			float rn = ((pos[3].x - pos[1].x) * (pos[0].y - pos[1].y) - (pos[3].y - pos[1].y) * (pos[0].x - pos[1].x)) * rd;
 			float sn = ((pos[2].x - pos[0].x) * (pos[0].y - pos[1].y) - (pos[2].y - pos[0].y) * (pos[0].x - pos[1].x)) * rd;
@@ -3198,9 +3636,6 @@ namespace olc
 				di.uv[i] *= q; di.w[i] *= q;
 				di.pos[i] = { (pos[i].x * vInvScreenSize.x) * 2.0f - 1.0f, ((pos[i].y * vInvScreenSize.y) * 2.0f - 1.0f) * -1.0f };
 			}
-			di.mode = nDecalMode;
-			di.structure = nDecalStructure;
-			vLayers[nTargetLayer].vecDecalInstance.push_back(di);
 		}
 	}
 
@@ -3714,10 +4149,20 @@ namespace olc
 		olc_UpdateViewport();
 	}
 
-	void PixelGameEngine::olc_UpdateMouseWheel(int32_t delta)
-	{ nMouseWheelDeltaCache += delta; }
+	void PixelGameEngine::PushInputEvent(olc::InputEvent e, std::chrono::steady_clock::time_point tp)
+	{
+		e.tp = tp == std::chrono::steady_clock::time_point() ? std::chrono::steady_clock::now() : tp;
+		std::lock_guard<std::mutex> lock(muxInputEvents);
+		vInputEventsCache.push_back(e);
+	}
+
+	void PixelGameEngine::olc_UpdateMouseWheel(int32_t delta, std::chrono::steady_clock::time_point tp)
+	{
+		nMouseWheelDeltaCache += delta;
+		PushInputEvent({ InputEvent::Type::MOUSE_WHEEL, delta }, tp);
+	}
 
-	void PixelGameEngine::olc_UpdateMouse(int32_t x, int32_t y)
+	void PixelGameEngine::olc_UpdateMouse(int32_t x, int32_t y, std::chrono::steady_clock::time_point tp)
 	{
 		// Mouse coords come in screen space
 		// But leave in pixel space
@@ -3732,13 +4177,24 @@ namespace olc
 		if (vMousePosCache.y >= (int32_t)vScreenSize.y)	vMousePosCache.y = vScreenSize.y - 1;
 		if (vMousePosCache.x < 0) vMousePosCache.x = 0;
 		if (vMousePosCache.y < 0) vMousePosCache.y = 0;
+		PushInputEvent({ InputEvent::Type::MOUSE_MOVE, 0, false, vMousePosCache }, tp);
 	}
 
-	void PixelGameEngine::olc_UpdateMouseState(int32_t button, bool state)
-	{ pMouseNewState[button] = state; }
+	void PixelGameEngine::olc_UpdateMouseState(int32_t button, bool state, std::chrono::steady_clock::time_point tp)
+	{
+		if (pMouseNewState[button] == state) return;
+		pMouseNewState[button] = state;
+		if (pMouseToggles[button] < 255) pMouseToggles[button]++;
+		PushInputEvent({ InputEvent::Type::MOUSE_BUTTON, button, state }, tp);
+	}
 
-	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state)
-	{ pKeyNewState[key] = state; }
+	void PixelGameEngine::olc_UpdateKeyState(int32_t key, bool state, std::chrono::steady_clock::time_point tp)
+	{
+		if (pKeyNewState[key] == state) return;
+		pKeyNewState[key] = state;
+		if (pKeyToggles[key] < 255) pKeyToggles[key]++;
+		if (key != olc::Key::NONE) PushInputEvent({ InputEvent::Type::KEY, key, state }, tp);
+	}
 
 	void PixelGameEngine::olc_UpdateMouseFocus(bool state)
 	{ bHasMouseFocus = state; }
@@ -3768,13 +4224,314 @@ namespace olc
 	void PixelGameEngine::olc_Terminate()
 	{ bAtomActive = false; }
 
-	void PixelGameEngine::EngineThread()
+	// O------------------------------------------------------------------------------O
+	// | olc::Renderer_Pipelined - lends the renderer to a render thread              |
+	// O------------------------------------------------------------------------------O
+	// Stands in for the real renderer while its context is current on the render thread.
+	// Calls made there go straight through; calls from any other thread wait for the frames
+	// already submitted to be drawn, then run on the render thread, so a texture is never
+	// deleted or changed under a frame that still uses it
+	class Renderer_Pipelined : public olc::Renderer
 	{
-		// Allow platform to do stuff here if needed, since its now in the
-		// context of this thread
-		if (platform->ThreadStartUp() == olc::FAIL)	return;
+	public:
+		// Everything the render thread needs to draw one frame, see PixelGameEngine::SubmitFrame()
+		struct Frame
+		{
+			struct Layer
+			{
+				bool bShow = false;
+				bool bUpdate = false;
+				olc::vf2d vOffset = { 0, 0 };
+				olc::vf2d vScale = { 1, 1 };
+				olc::Pixel tint = olc::WHITE;
+				uint32_t nResID = 0;
+				std::function<void()> funcHook = nullptr;
+				// A copy of the layer's pixels, valid if bUpdate
+				std::unique_ptr<olc::Sprite> pPixels;
+				std::vector<DecalInstance> vecDecalInstance;
+				DecalArena decalArena;
+			};
 
-		// Do engine context specific initialisation
+			olc::vi2d vViewPos = { 0, 0 };
+			olc::vi2d vViewSize = { 0, 0 };
+			std::vector<Layer> vLayers;
+		};
+
+	public:
+		Renderer_Pipelined(std::unique_ptr<olc::Renderer> pDevice) : device(std::move(pDevice)) {}
+		~Renderer_Pipelined() { if (thread.joinable()) Release(); }
+
+		// Moves the context from the calling thread to a new render thread
+		bool Start()
+		{
+			if (!device->MakeCurrent(false)) return false;
+			thread = std::thread(&Renderer_Pipelined::RenderThread, this);
+			std::unique_lock<std::mutex> lock(mux);
+			cvGame.wait(lock, [&] { return bStarted; });
+			return bRunning;
+		}
+
+		// Draws whatever is still pending, stops the render thread and returns the
+		// real renderer, its context current on the calling thread again
+		std::unique_ptr<olc::Renderer> Release()
+		{
+			if (thread.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lock(mux);
+					bQuit = true;
+				}
+				cvRender.notify_all();
+				thread.join();
+			}
+			device->MakeCurrent(true);
+			return std::move(device);
+		}
+
+		// The frame to fill in. Waits only while the previous one is yet to be picked up
+		Frame& BeginFrame()
+		{
+			std::unique_lock<std::mutex> lock(mux);
+			cvGame.wait(lock, [&] { return !bFramePending; });
+			return vFrames[nFill];
+		}
+
+		void EndFrame()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mux);
+				bFramePending = true;
+			}
+			cvRender.notify_all();
+		}
+
+	public:
+		void PrepareDevice() override { Run([&] { device->PrepareDevice(); }); }
+		olc::rcode CreateDevice(std::vector<void*> params, bool bFullScreen, bool bVSYNC) override
+		{ olc::rcode r = olc::FAIL; Run([&] { r = device->CreateDevice(params, bFullScreen, bVSYNC); }); return r; }
+		olc::rcode DestroyDevice() override
+		{ olc::rcode r = olc::FAIL; Run([&] { r = device->DestroyDevice(); }); return r; }
+		void DisplayFrame() override { Run([&] { device->DisplayFrame(); }); }
+		void PrepareDrawing() override { Run([&] { device->PrepareDrawing(); }); }
+		void SetDecalMode(const olc::DecalMode& mode) override { Run([&] { device->SetDecalMode(mode); }); }
+		void DrawLayerQuad(const olc::vf2d& offset, const olc::vf2d& scale, const olc::Pixel tint) override
+		{ Run([&] { device->DrawLayerQuad(offset, scale, tint); }); }
+		void DrawDecal(const olc::DecalInstance& decal) override { Run([&] { device->DrawDecal(decal); }); }
+		uint32_t CreateTexture(const uint32_t width, const uint32_t height, const bool filtered, const bool clamp) override
+		{ uint32_t id = 0; Run([&] { id = device->CreateTexture(width, height, filtered, clamp); }); return id; }
+		uint32_t DeleteTexture(const uint32_t id) override
+		{ uint32_t r = 0; Run([&] { r = device->DeleteTexture(id); }); return r; }
+		void UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) override { Run([&] { device->UpdateViewport(pos, size); }); }
+		void ClearBuffer(olc::Pixel p, bool bDepth) override { Run([&] { device->ClearBuffer(p, bDepth); }); }
+
+		// A frame can be drawn between two calls from the game thread, so a binding made
+		// there would not last; uploads and reads from it bind their own texture instead
+		void ApplyTexture(uint32_t id) override
+		{
+			if (OnRenderThread()) device->ApplyTexture(id);
+		}
+
+		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			if (OnRenderThread()) device->UpdateTexture(id, spr);
+			else Run([&] { device->ApplyTexture(id); device->UpdateTexture(id, spr); });
+		}
+
+		void ReadTexture(uint32_t id, olc::Sprite* spr) override
+		{
+			if (OnRenderThread()) device->ReadTexture(id, spr);
+			else Run([&] { device->ApplyTexture(id); device->ReadTexture(id, spr); });
+		}
+
+		void ReadFrame(olc::Sprite* spr) override
+		{
+			if (OnRenderThread()) device->ReadFrame(spr);
+			else Run([&] { device->ReadFrame(spr); });
+		}
+
+		// The render thread owns the context until Release()
+		bool MakeCurrent(const bool bCurrent) override { UNUSED(bCurrent); return false; }
+
+	private:
+		bool OnRenderThread() const { return std::this_thread::get_id() == idRender; }
+
+		void Run(const std::function<void()>& func)
+		{
+			if (OnRenderThread()) { func(); return; }
+
+			std::unique_lock<std::mutex> lock(mux);
+			bool bDone = false;
+			qCommands.push_back({ &func, &bDone });
+			cvRender.notify_all();
+			cvGame.wait(lock, [&] { return bDone; });
+		}
+
+		void RenderThread()
+		{
+			const bool bCurrent = device->MakeCurrent(true);
+
+			std::unique_lock<std::mutex> lock(mux);
+			idRender = std::this_thread::get_id();
+			bStarted = true;
+			bRunning = bCurrent;
+			cvGame.notify_all();
+			if (!bCurrent) return;
+
+			while (true)
+			{
+				cvRender.wait(lock, [&] { return bFramePending || !qCommands.empty() || bQuit; });
+
+				if (bFramePending)
+				{
+					// Frames first, so commands only ever run once the frames submitted
+					// before them are done with their textures
+					const size_t nDraw = nFill;
+					nFill ^= 1;
+					bFramePending = false;
+					cvGame.notify_all();
+
+					lock.unlock();
+					Draw(vFrames[nDraw]);
+					lock.lock();
+				}
+				else if (!qCommands.empty())
+				{
+					Command cmd = qCommands.front();
+					qCommands.pop_front();
+
+					lock.unlock();
+					(*cmd.pFunc)();
+					lock.lock();
+
+					*cmd.pDone = true;
+					cvGame.notify_all();
+				}
+				else
+					break;
+			}
+
+			lock.unlock();
+			device->MakeCurrent(false);
+		}
+
+		void Draw(Frame& frame)
+		{
+			device->UpdateViewport(frame.vViewPos, frame.vViewSize);
+			device->ClearBuffer(olc::BLACK, true);
+			device->PrepareDrawing();
+
+			for (auto layer = frame.vLayers.rbegin(); layer != frame.vLayers.rend(); ++layer)
+			{
+				if (!layer->bShow) continue;
+
+				if (layer->funcHook == nullptr)
+				{
+					device->ApplyTexture(layer->nResID);
+					if (layer->bUpdate) device->UpdateTexture(layer->nResID, layer->pPixels.get());
+
+					device->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
+
+					for (auto& decal : layer->vecDecalInstance)
+						device->DrawDecal(decal);
+					layer->vecDecalInstance.clear();
+					layer->decalArena.Reset();
+				}
+				else
+					layer->funcHook();
+			}
+
+			device->DisplayFrame();
+		}
+
+	private:
+		struct Command
+		{
+			const std::function<void()>* pFunc;
+			bool* pDone;
+		};
+
+		std::unique_ptr<olc::Renderer> device;
+		std::thread thread;
+		std::thread::id idRender;
+		std::mutex mux;
+		std::condition_variable cvRender;
+		std::condition_variable cvGame;
+		std::deque<Command> qCommands;
+		Frame vFrames[2];
+		size_t nFill = 0;
+		bool bFramePending = false;
+		bool bStarted = false;
+		bool bRunning = false;
+		bool bQuit = false;
+	};
+
+	void PixelGameEngine::RunPipelined()
+	{
+		auto pipeline = std::make_unique<olc::Renderer_Pipelined>(std::move(renderer));
+		if (!pipeline->Start())
+		{
+			// This renderer's context can't change threads, so run as usual
+			renderer = pipeline->Release();
+			while (bAtomActive) { olc_CoreUpdate(); }
+			return;
+		}
+
+		pPipeline = pipeline.get();
+		renderer = std::move(pipeline);
+		while (bAtomActive) { olc_CoreUpdate(); }
+
+		// OnUserDestroy() and the platform expect the context back on this thread
+		renderer = pPipeline->Release();
+		pPipeline = nullptr;
+	}
+
+	void PixelGameEngine::SubmitFrame()
+	{
+		olc::Renderer_Pipelined::Frame& frame = pPipeline->BeginFrame();
+		frame.vViewPos = vViewPos;
+		frame.vViewSize = vViewSize;
+		frame.vLayers.resize(vLayers.size());
+
+		for (size_t i = 0; i < vLayers.size(); i++)
+		{
+			LayerDesc& layer = vLayers[i];
+			auto& copy = frame.vLayers[i];
+			copy.bShow = layer.bShow;
+			if (!layer.bShow) continue;
+
+			copy.funcHook = layer.funcHook;
+			if (layer.funcHook != nullptr) continue;
+
+			copy.vOffset = layer.vOffset;
+			copy.vScale = layer.vScale;
+			copy.tint = layer.tint;
+			copy.nResID = layer.pDrawTarget.Decal()->id;
+			copy.bUpdate = !bSuspendTextureTransfer && layer.bUpdate;
+			if (copy.bUpdate)
+			{
+				const olc::Sprite* pSource = layer.pDrawTarget.Sprite();
+				if (!copy.pPixels) copy.pPixels = std::make_unique<olc::Sprite>();
+				copy.pPixels->width = pSource->width;
+				copy.pPixels->height = pSource->height;
+				copy.pPixels->pColData = pSource->pColData;
+				layer.bUpdate = false;
+			}
+
+			// The frame's emptied lists come back, so neither side allocates once warmed up
+			std::swap(copy.vecDecalInstance, layer.vecDecalInstance);
+			std::swap(copy.decalArena, layer.decalArena);
+		}
+
+		pPipeline->EndFrame();
+	}
+
+	void PixelGameEngine::EngineThread()
+	{
+		// Allow platform to do stuff here if needed, since its now in the
+		// context of this thread
+		if (platform->ThreadStartUp() == olc::FAIL)	return;
+
+		// Do engine context specific initialisation
 		olc_PrepareEngine();
 
 		// Create user resources as part of this thread
@@ -3785,7 +4542,10 @@ namespace olc
 		while (bAtomActive)
 		{
 			// Run as fast as possible
-			while (bAtomActive) { olc_CoreUpdate(); }
+			if (bPipelined)
+				RunPipelined();
+			else
+				while (bAtomActive) { olc_CoreUpdate(); }
 
 			// Allow the user to free resources if they have overrided the destroy function
 			if (!OnUserDestroy())
@@ -3812,30 +4572,88 @@ namespace olc
 		vLayers[0].bShow = true;
 		SetDrawTarget(nullptr);
 
-		m_tp1 = std::chrono::system_clock::now();
-		m_tp2 = std::chrono::system_clock::now();
+		m_tp1 = std::chrono::steady_clock::now();
+		m_tp2 = m_tp1;
+		tpFrameDeadline = m_tp1;
+	}
+
+	void PixelGameEngine::PaceFrame()
+	{
+		using clock = std::chrono::steady_clock;
+		bFrameLate = false;
+		if (fFrameRateLimit <= 0.0f) return;
+
+		const auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / double(fFrameRateLimit)));
+		tpFrameDeadline += period;
+
+		clock::time_point now = clock::now();
+		if (now >= tpFrameDeadline)
+		{
+			// A frame or more behind is not caught up by rushing the next ones
+			bFrameLate = true;
+			if (now - tpFrameDeadline > period) tpFrameDeadline = now;
+			return;
+		}
+
+		// Sleep for all but the margin the scheduler tends to oversleep by, then spin
+		const std::chrono::duration<float> remaining = tpFrameDeadline - now;
+		if (remaining.count() > fSleepMargin)
+		{
+			const std::chrono::duration<float> sleep(remaining.count() - fSleepMargin);
+			std::this_thread::sleep_for(sleep);
+			const std::chrono::duration<float> slept = clock::now() - now;
+
+			// The margin follows the worst recent oversleep, and relaxes slowly
+			const float fOversleep = slept.count() - sleep.count();
+			fSleepMargin = std::clamp(std::max(fOversleep * 1.25f, fSleepMargin * 0.99f), 0.0002f, 0.02f);
+		}
+
+		while (clock::now() < tpFrameDeadline)
+			std::this_thread::yield();
 	}
 
 
 	void PixelGameEngine::olc_CoreUpdate()
 	{
 		// Handle Timing
-		m_tp2 = std::chrono::system_clock::now();
+		PaceFrame();
+		m_tp2 = std::chrono::steady_clock::now();
 		std::chrono::duration<float> elapsedTime = m_tp2 - m_tp1;
 		m_tp1 = m_tp2;
-
-		// Our time per frame coefficient
-		float fElapsedTime = elapsedTime.count();
+		const float fFrameTime = elapsedTime.count();
+
+		// Our time per frame coefficient, averaged over the smoothing window
+		vFrameTimes[nFrameTimeIndex] = fFrameTime;
+		nFrameTimeIndex = (nFrameTimeIndex + 1) % vFrameTimes.size();
+		nFrameTimeCount = std::min(nFrameTimeCount + 1, vFrameTimes.size());
+		float fElapsedTime = 0.0f;
+		for (size_t i = 0; i < nFrameTimeCount; i++) fElapsedTime += vFrameTimes[i];
+		fElapsedTime /= float(nFrameTimeCount);
 		fLastElapsed = fElapsedTime;
 
+		fStatMin = nStatFrames == 0 ? fFrameTime : std::min(fStatMin, fFrameTime);
+		fStatMax = nStatFrames == 0 ? fFrameTime : std::max(fStatMax, fFrameTime);
+		dStatSum += fFrameTime;
+		dStatSumSq += double(fFrameTime) * double(fFrameTime);
+		nStatLate += bFrameLate ? 1 : 0;
+		nStatFrames++;
+
 		if (bConsoleSuspendTime)
 			fElapsedTime = 0.0f;
 
 		// Some platforms will need to check for events
 		platform->HandleSystemEvent();
 
+		{
+			std::lock_guard<std::mutex> lock(muxInputEvents);
+			std::swap(vInputEvents, vInputEventsCache);
+			vInputEventsCache.clear();
+		}
+		for (auto& e : vInputEvents)
+			e.fAge = std::max(std::chrono::duration<float>(m_tp2 - e.tp).count(), 0.0f);
+
 		// Compare hardware input states from previous frame
-		auto ScanHardware = [&](HWButton* pKeys, bool* pStateOld, bool* pStateNew, uint32_t nKeyCount)
+		auto ScanHardware = [&](HWButton* pKeys, bool* pStateOld, bool* pStateNew, uint8_t* pToggles, uint32_t nKeyCount)
 		{
 			for (uint32_t i = 0; i < nKeyCount; i++)
 			{
@@ -3854,12 +4672,19 @@ namespace olc
 						pKeys[i].bHeld = false;
 					}
 				}
+				else if (pToggles[i] >= 2)
+				{
+					// Went and came back within the frame: a tap, or a release and re-press
+					pKeys[i].bPressed = true;
+					pKeys[i].bReleased = true;
+				}
 				pStateOld[i] = pStateNew[i];
+				pToggles[i] = 0;
 			}
 		};
 
-		ScanHardware(pKeyboardState, pKeyOldState, pKeyNewState, 256);
-		ScanHardware(pMouseState, pMouseOldState, pMouseNewState, nMouseButtons);
+		ScanHardware(pKeyboardState, pKeyOldState, pKeyNewState, pKeyToggles, 256);
+		ScanHardware(pMouseState, pMouseOldState, pMouseNewState, pMouseToggles, nMouseButtons);
 
 		// Cache mouse coordinates so they remain consistent during frame
 		vMousePos = vMousePosCache;
@@ -3893,48 +4718,55 @@ namespace olc
 
 		
 
-		// Display Frame
-		renderer->UpdateViewport(vViewPos, vViewSize);
-		renderer->ClearBuffer(olc::BLACK, true);
-
 		// Layer 0 must always exist
 		vLayers[0].bUpdate = true;
 		vLayers[0].bShow = true;
 		SetDecalMode(DecalMode::NORMAL);
-		renderer->PrepareDrawing();
 
-		for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
+		if (pPipeline != nullptr)
 		{
-			if (layer->bShow)
+			// The render thread draws and presents it while the next frame runs
+			SubmitFrame();
+		}
+		else
+		{
+			// Display Frame
+			renderer->UpdateViewport(vViewPos, vViewSize);
+			renderer->ClearBuffer(olc::BLACK, true);
+			renderer->PrepareDrawing();
+
+			for (auto layer = vLayers.rbegin(); layer != vLayers.rend(); ++layer)
 			{
-				if (layer->funcHook == nullptr)
+				if (layer->bShow)
 				{
-					renderer->ApplyTexture(layer->pDrawTarget.Decal()->id);
-					if (!bSuspendTextureTransfer && layer->bUpdate)
+					if (layer->funcHook == nullptr)
 					{
-						layer->pDrawTarget.Decal()->Update();
-						layer->bUpdate = false;
+						renderer->ApplyTexture(layer->pDrawTarget.Decal()->id);
+						if (!bSuspendTextureTransfer && layer->bUpdate)
+						{
+							layer->pDrawTarget.Decal()->Update();
+							layer->bUpdate = false;
+						}
+
+						renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
+
+						// Display Decals in order for this layer
+						for (auto& decal : layer->vecDecalInstance)
+							renderer->DrawDecal(decal);
+						layer->vecDecalInstance.clear();
+						layer->decalArena.Reset();
+					}
+					else
+					{
+						// Mwa ha ha.... Have Fun!!!
+						layer->funcHook();
 					}
-
-					renderer->DrawLayerQuad(layer->vOffset, layer->vScale, layer->tint);
-
-					// Display Decals in order for this layer
-					for (auto& decal : layer->vecDecalInstance)
-						renderer->DrawDecal(decal);
-					layer->vecDecalInstance.clear();
-				}
-				else
-				{
-					// Mwa ha ha.... Have Fun!!!
-					layer->funcHook();
 				}
 			}
-		}
-
-		
 
-		// Present Graphics to screen
-		renderer->DisplayFrame();
+			// Present Graphics to screen
+			renderer->DisplayFrame();
+		}
 
 		// Update Title Bar
 		fFrameTimer += fElapsedTime;
@@ -3943,6 +4775,19 @@ namespace olc
 		{
 			nLastFPS = nFrameCount;
 			fFrameTimer -= 1.0f;
+
+			const double dMean = dStatSum / double(nStatFrames);
+			frameStats.nFrames = nStatFrames;
+			frameStats.fMean = float(dMean);
+			frameStats.fJitter = float(std::sqrt(std::max(dStatSumSq / double(nStatFrames) - dMean * dMean, 0.0)));
+			frameStats.fMin = fStatMin;
+			frameStats.fMax = fStatMax;
+			frameStats.nLate = nStatLate;
+			nStatFrames = 0;
+			nStatLate = 0;
+			dStatSum = 0.0;
+			dStatSumSq = 0.0;
+
 			std::string sTitle = "OneLoneCoder.com - Pixel Game Engine - " + sAppName + " - FPS: " + std::to_string(nFrameCount);
 			platform->SetWindowTitle(sTitle);
 			nFrameCount = 0;
@@ -4074,18 +4919,28 @@ namespace olc
 		virtual void       ApplyTexture(uint32_t id) {}
 		virtual void       UpdateViewport(const olc::vi2d& pos, const olc::vi2d& size) {}
 		virtual void       ClearBuffer(olc::Pixel p, bool bDepth) {}
+		virtual bool       MakeCurrent(const bool bCurrent) { return true; }
 	};
 #endif
 #if defined(OLC_PLATFORM_HEADLESS)
 	class Platform_Headless : public olc::Platform
 	{
+	private:
+		// What a window would measure, for renderers that draw offscreen
+		olc::vi2d vSurfaceSize = { 1, 1 };
+
 	public:
 		virtual olc::rcode ApplicationStartUp() { return olc::rcode::OK; }
 		virtual olc::rcode ApplicationCleanUp() { return olc::rcode::OK; }
 		virtual olc::rcode ThreadStartUp() { return olc::rcode::OK; }
-		virtual olc::rcode ThreadCleanUp() { return olc::rcode::OK; }
-		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize) { return olc::rcode::OK; }
-		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) { return olc::rcode::OK; }
+		virtual olc::rcode ThreadCleanUp() { return renderer->DestroyDevice(); }
+		virtual olc::rcode CreateGraphics(bool bFullScreen, bool bEnableVSYNC, const olc::vi2d& vViewPos, const olc::vi2d& vViewSize)
+		{
+			if (renderer->CreateDevice({ &vSurfaceSize }, bFullScreen, bEnableVSYNC) != olc::rcode::OK) return olc::rcode::FAIL;
+			renderer->UpdateViewport(vViewPos, vViewSize);
+			return olc::rcode::OK;
+		}
+		virtual olc::rcode CreateWindowPane(const olc::vi2d& vWindowPos, olc::vi2d& vWindowSize, bool bFullScreen) { vSurfaceSize = vWindowSize; return olc::rcode::OK; }
 		virtual olc::rcode SetWindowTitle(const std::string& s) { return olc::rcode::OK; }
 		virtual olc::rcode StartSystemEventLoop() { return olc::rcode::OK; }
 		virtual olc::rcode HandleSystemEvent() { return olc::rcode::OK; }
@@ -4151,8 +5006,12 @@ namespace olc
 
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
-			return olc::rcode::OK;
+			// Not supported, nothing is written
+			return olc::rcode::FAIL;
 		}
+
+		std::unique_ptr<olc::ImageLoader> Clone() const override
+		{ return std::make_unique<ImageLoader_STB>(); }
 	};
 }
 #endif
@@ -4219,6 +5078,15 @@ namespace olc
 
 		bool bSync = false;
 		olc::DecalMode nDecalMode = olc::DecalMode(-1); // Thanks Gusgo & Bispoo
+		// Last texture bound, so consecutive decals from one texture (an atlas page, say) skip the rebind
+		uint32_t nBoundTexture = uint32_t(-1);
+
+		void BindTexture(const uint32_t id)
+		{
+			if (id == nBoundTexture) return;
+			glBindTexture(GL_TEXTURE_2D, id);
+			nBoundTexture = id;
+		}
 		olc::DecalStructure nDecalStructure = olc::DecalStructure(-1);
 #if defined(OLC_PLATFORM_X11)
 		X11::Display* olc_Display = nullptr;
@@ -4333,6 +5201,21 @@ namespace olc
 			return olc::rcode::OK;
 		}
 
+		bool MakeCurrent(const bool bCurrent) override
+		{
+#if defined(OLC_PLATFORM_WINAPI)
+			if (bCurrent) return wglMakeCurrent(glDeviceContext, glRenderContext) == TRUE;
+			return wglMakeCurrent(NULL, NULL) == TRUE;
+#elif defined(OLC_PLATFORM_X11)
+			if (bCurrent) return glXMakeCurrent(olc_Display, *olc_Window, glDeviceContext) == True;
+			return glXMakeCurrent(olc_Display, None, NULL) == True;
+#else
+			// GLUT and Emscripten keep the context on the thread that made it
+			UNUSED(bCurrent);
+			return false;
+#endif
+		}
+
 		void DisplayFrame() override
 		{
 #if defined(OLC_PLATFORM_WINAPI)
@@ -4357,6 +5240,8 @@ namespace olc
 			nDecalMode = DecalMode::NORMAL;
 			nDecalStructure = DecalStructure::FAN;
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			// Anything outside the renderer may have bound a texture since last frame
+			nBoundTexture = uint32_t(-1);
 		}
 
 		void SetDecalMode(const olc::DecalMode& mode)
@@ -4410,9 +5295,9 @@ namespace olc
 			SetDecalMode(decal.mode);
 
 			if (decal.decal == nullptr)
-				glBindTexture(GL_TEXTURE_2D, 0);
+				BindTexture(0);
 			else
-				glBindTexture(GL_TEXTURE_2D, decal.decal->id);
+				BindTexture(decal.decal->id);
 			
 			if (nDecalMode == DecalMode::MODEL3D)
 			{
@@ -4488,7 +5373,7 @@ namespace olc
 			UNUSED(height);
 			uint32_t id = 0;
 			glGenTextures(1, &id);
-			glBindTexture(GL_TEXTURE_2D, id);
+			BindTexture(id);
 			if (filtered)
 			{
 				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -4517,6 +5402,8 @@ namespace olc
 
 		uint32_t DeleteTexture(const uint32_t id) override
 		{
+			// Deleting the bound texture unbinds it, and its name may be handed out again
+			if (id == nBoundTexture) nBoundTexture = uint32_t(-1);
 			glDeleteTextures(1, &id);
 			return id;
 		}
@@ -4532,9 +5419,14 @@ namespace olc
 			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		void ReadFrame(olc::Sprite* spr) override
+		{
+			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+		}
+
 		void ApplyTexture(uint32_t id) override
 		{
-			glBindTexture(GL_TEXTURE_2D, id);
+			BindTexture(id);
 		}
 
 		void ClearBuffer(olc::Pixel p, bool bDepth) override
@@ -4610,6 +5502,13 @@ namespace olc
 	#define OGL_LOAD(t, n) n;
 #endif
 
+#if defined(OLC_PLATFORM_HEADLESS)
+	#if !defined(EGL_PLATFORM_SURFACELESS_MESA)
+		#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+	#endif
+	#define OGL_LOAD(t, n) (t*)eglGetProcAddress(#n)
+#endif
+
 namespace olc
 {
 //	typedef char GLchar;
@@ -4653,7 +5552,7 @@ namespace olc
 	class Renderer_OGL33 : public olc::Renderer
 	{
 	private:
-#if defined(OLC_PLATFORM_EMSCRIPTEN)
+#if defined(OLC_PLATFORM_EMSCRIPTEN) || defined(OLC_PLATFORM_HEADLESS)
 		EGLDisplay olc_Display;
 		EGLConfig olc_Config;
 		EGLContext olc_Context;
@@ -4663,19 +5562,112 @@ namespace olc
 #if defined(OLC_PLATFORM_GLUT)
 		bool mFullScreen = false;
 #else
-	#if !defined(OLC_PLATFORM_EMSCRIPTEN)
+	#if !defined(OLC_PLATFORM_EMSCRIPTEN) && !defined(OLC_PLATFORM_HEADLESS)
 		glDeviceContext_t glDeviceContext = 0;
 		glRenderContext_t glRenderContext = 0;
 	#endif
 #endif
 		bool bSync = false;
 		olc::DecalMode nDecalMode = olc::DecalMode(-1); // Thanks Gusgo & Bispoo
+		// Last texture bound, so consecutive decals from one texture (an atlas page, say) skip the rebind
+		uint32_t nBoundTexture = uint32_t(-1);
+
+		void BindTexture(const uint32_t id)
+		{
+			if (id == nBoundTexture) return;
+			glBindTexture(GL_TEXTURE_2D, id);
+			nBoundTexture = id;
+		}
 #if defined(OLC_PLATFORM_X11)
 		X11::Display* olc_Display = nullptr;
 		X11::Window* olc_Window = nullptr;
 		X11::XVisualInfo* olc_VisualInfo = nullptr;
 #endif
 
+		// Streaming needs mapped buffers and fences (GL 3.2 or ARB_sync), and persistent
+		// mapping needs ARB_buffer_storage (GL 4.4). WebGL has neither
+		void PrepareStreaming()
+		{
+#if defined(OLC_PLATFORM_X11)
+			using namespace X11;
+#endif
+#if !defined(OLC_PLATFORM_EMSCRIPTEN)
+			locDeleteBuffers = OGL_LOAD(locDeleteBuffers_t, glDeleteBuffers);
+			locBufferStorage = OGL_LOAD(locBufferStorage_t, glBufferStorage);
+			locMapBufferRange = OGL_LOAD(locMapBufferRange_t, glMapBufferRange);
+			locUnmapBuffer = OGL_LOAD(locUnmapBuffer_t, glUnmapBuffer);
+			locFenceSync = OGL_LOAD(locFenceSync_t, glFenceSync);
+			locClientWaitSync = OGL_LOAD(locClientWaitSync_t, glClientWaitSync);
+			locDeleteSync = OGL_LOAD(locDeleteSync_t, glDeleteSync);
+
+			const char* sVersion = (const char*)glGetString(GL_VERSION);
+			const char* sExtensions = (const char*)glGetString(GL_EXTENSIONS);
+			if (sVersion == nullptr) return;
+			while (*sVersion != '\0' && !std::isdigit((unsigned char)*sVersion)) sVersion++;
+			const int nVersion = std::atoi(sVersion) * 10 + (std::strchr(sVersion, '.') ? std::atoi(std::strchr(sVersion, '.') + 1) : 0);
+			auto HasExtension = [&](const char* sName) { return sExtensions != nullptr && std::strstr(sExtensions, sName) != nullptr; };
+
+			bStreaming = (nVersion >= 32 || HasExtension("GL_ARB_sync")) && locDeleteBuffers && locMapBufferRange
+				&& locUnmapBuffer && locFenceSync && locClientWaitSync && locDeleteSync;
+			bStreamPersistent = bStreaming && (nVersion >= 44 || HasExtension("GL_ARB_buffer_storage")) && locBufferStorage;
+#endif
+		}
+
+		// Copies spr into the next pixel buffer and uploads from there. False if no buffer
+		// could be mapped, leaving the caller to upload directly
+		bool StreamTexture(olc::Sprite* spr, const size_t nBytes)
+		{
+			locStreamBuffer& buf = vStream[nStream];
+			nStream = (nStream + 1) % vStream.size();
+
+			// The GPU may still be copying out of this buffer from a few uploads ago
+			if (buf.fence != nullptr)
+			{
+				while (locClientWaitSync(buf.fence, 0x00000001, 1000000000) == 0x911B) {}
+				locDeleteSync(buf.fence);
+				buf.fence = nullptr;
+			}
+
+			if (buf.nSize < nBytes)
+			{
+				// Immutable storage can't be resized, so grow by starting afresh
+				if (buf.pMapped != nullptr) { locBindBuffer(0x88EC, buf.id); locUnmapBuffer(0x88EC); }
+				if (buf.id != 0) locDeleteBuffers(1, &buf.id);
+				buf = locStreamBuffer();
+				locGenBuffers(1, &buf.id);
+				locBindBuffer(0x88EC, buf.id);
+				if (bStreamPersistent)
+				{
+					// Write | Persistent | Coherent
+					locBufferStorage(0x88EC, GLsizeiptr(nBytes), nullptr, 0x0002 | 0x0040 | 0x0080);
+					buf.pMapped = (uint8_t*)locMapBufferRange(0x88EC, 0, GLsizeiptr(nBytes), 0x0002 | 0x0040 | 0x0080);
+				}
+				else
+					locBufferData(0x88EC, GLsizeiptr(nBytes), nullptr, 0x88E0);
+				buf.nSize = nBytes;
+			}
+			else
+				locBindBuffer(0x88EC, buf.id);
+
+			// Write | Invalidate Buffer | Unsynchronized - the fence already did the waiting
+			uint8_t* pDst = buf.pMapped != nullptr ? buf.pMapped
+				: (uint8_t*)locMapBufferRange(0x88EC, 0, GLsizeiptr(nBytes), 0x0002 | 0x0008 | 0x0020);
+			if (pDst == nullptr)
+			{
+				locBindBuffer(0x88EC, 0);
+				return false;
+			}
+
+			std::memcpy(pDst, spr->GetData(), nBytes);
+			if (buf.pMapped == nullptr) locUnmapBuffer(0x88EC);
+
+			// With a buffer bound, the data pointer is an offset into it
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			locBindBuffer(0x88EC, 0);
+			buf.fence = locFenceSync(0x9117, 0);
+			return true;
+		}
+
 	private:
 		locCreateShader_t* locCreateShader = nullptr;
 		locShaderSource_t* locShaderSource = nullptr;
@@ -4695,6 +5687,33 @@ namespace olc
 		locGenVertexArrays_t* locGenVertexArrays = nullptr;
 		locSwapInterval_t* locSwapInterval = nullptr;
 		locGetShaderInfoLog_t* locGetShaderInfoLog = nullptr;
+		locDeleteBuffers_t* locDeleteBuffers = nullptr;
+		locBufferStorage_t* locBufferStorage = nullptr;
+		locMapBufferRange_t* locMapBufferRange = nullptr;
+		locUnmapBuffer_t* locUnmapBuffer = nullptr;
+		locFenceSync_t* locFenceSync = nullptr;
+		locClientWaitSync_t* locClientWaitSync = nullptr;
+		locDeleteSync_t* locDeleteSync = nullptr;
+
+		// Size each texture was last given, so an update of the same size replaces the
+		// pixels rather than reallocating the texture
+		std::vector<olc::vi2d> vTextureSize;
+
+		// Uploads of this many bytes or more stream through a ring of pixel buffers. The
+		// CPU fills one while the GPU may still be copying from the others, and with
+		// persistent mapping the buffers stay mapped for good
+		static constexpr size_t nStreamMinBytes = 256 * 1024;
+		struct locStreamBuffer
+		{
+			GLuint id = 0;
+			size_t nSize = 0;
+			uint8_t* pMapped = nullptr;
+			locSync_t fence = nullptr;
+		};
+		std::array<locStreamBuffer, 3> vStream;
+		size_t nStream = 0;
+		bool bStreaming = false;
+		bool bStreamPersistent = false;
 
 		uint32_t m_nFS = 0;
 		uint32_t m_nVS = 0;
@@ -4804,6 +5823,35 @@ namespace olc
 			locSwapInterval(olc_Display, bVSYNC ? 1 : 0);
 #endif
 
+#if defined(OLC_PLATFORM_HEADLESS)
+			// Mesa's surfaceless platform needs no display server at all; failing that,
+			// whatever the default display is
+			auto GetPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			olc_Display = GetPlatformDisplay ? GetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY;
+			if (olc_Display == EGL_NO_DISPLAY || !eglInitialize(olc_Display, nullptr, nullptr))
+			{
+				olc_Display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+				if (olc_Display == EGL_NO_DISPLAY || !eglInitialize(olc_Display, nullptr, nullptr)) return olc::FAIL;
+			}
+
+			EGLint const attribute_list[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8, EGL_NONE };
+			EGLint num_config = 0;
+			if (!eglChooseConfig(olc_Display, attribute_list, &olc_Config, 1, &num_config) || num_config == 0) return olc::FAIL;
+
+			// A pbuffer the size the window would have been stands in for it
+			const olc::vi2d vSize = params.empty() ? olc::vi2d(1, 1) : *(olc::vi2d*)params[0];
+			EGLint const surface_attribs[] = { EGL_WIDTH, vSize.x, EGL_HEIGHT, vSize.y, EGL_NONE };
+			olc_Surface = eglCreatePbufferSurface(olc_Display, olc_Config, surface_attribs);
+
+			eglBindAPI(EGL_OPENGL_API);
+			olc_Context = eglCreateContext(olc_Display, olc_Config, EGL_NO_CONTEXT, nullptr);
+			if (olc_Surface == EGL_NO_SURFACE || olc_Context == EGL_NO_CONTEXT) return olc::FAIL;
+			eglMakeCurrent(olc_Display, olc_Surface, olc_Surface, olc_Context);
+			glViewport(0, 0, vSize.x, vSize.y);
+			bSync = bVSYNC;
+#endif
+
 #if defined(OLC_PLATFORM_GLUT)
 			mFullScreen = bFullScreen;
 			if (!bVSYNC)
@@ -4843,6 +5891,7 @@ namespace olc
 			locBindVertexArray = glBindVertexArrayOES;
 			locGenVertexArrays = glGenVertexArraysOES;
 #endif
+			PrepareStreaming();
 
 			// Load & Compile Quad Shader - assumes no errors
 			m_nFS = locCreateShader(0x8B30);
@@ -4900,6 +5949,19 @@ namespace olc
 
 		olc::rcode DestroyDevice() override
 		{
+			if (bStreaming)
+			{
+				for (auto& buf : vStream)
+				{
+					if (buf.fence != nullptr) locDeleteSync(buf.fence);
+					if (buf.pMapped != nullptr) { locBindBuffer(0x88EC, buf.id); locUnmapBuffer(0x88EC); }
+					if (buf.id != 0) locDeleteBuffers(1, &buf.id);
+					buf = locStreamBuffer();
+				}
+				locBindBuffer(0x88EC, 0);
+			}
+			vTextureSize.clear();
+
 #if defined(OLC_PLATFORM_WINAPI)
 			wglDeleteContext(glRenderContext);
 #endif
@@ -4913,7 +5975,7 @@ namespace olc
 			glutDestroyWindow(glutGetWindow());
 #endif
 
-#if defined(OLC_PLATFORM_EMSCRIPTEN)
+#if defined(OLC_PLATFORM_EMSCRIPTEN) || defined(OLC_PLATFORM_HEADLESS)
 			eglMakeCurrent(olc_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
 			eglDestroyContext(olc_Display, olc_Context);
 			eglDestroySurface(olc_Display, olc_Surface);
@@ -4925,6 +5987,24 @@ namespace olc
 			return olc::rcode::OK;
 		}
 
+		bool MakeCurrent(const bool bCurrent) override
+		{
+#if defined(OLC_PLATFORM_WINAPI)
+			if (bCurrent) return wglMakeCurrent(glDeviceContext, glRenderContext) == TRUE;
+			return wglMakeCurrent(NULL, NULL) == TRUE;
+#elif defined(OLC_PLATFORM_X11)
+			if (bCurrent) return glXMakeCurrent(olc_Display, *olc_Window, glDeviceContext) == True;
+			return glXMakeCurrent(olc_Display, None, NULL) == True;
+#elif defined(OLC_PLATFORM_HEADLESS)
+			if (bCurrent) return eglMakeCurrent(olc_Display, olc_Surface, olc_Surface, olc_Context) == EGL_TRUE;
+			return eglMakeCurrent(olc_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT) == EGL_TRUE;
+#else
+			// GLUT and Emscripten keep the context on the thread that made it
+			UNUSED(bCurrent);
+			return false;
+#endif
+		}
+
 		void DisplayFrame() override
 		{
 #if defined(OLC_PLATFORM_WINAPI)
@@ -4943,12 +6023,19 @@ namespace olc
 #if defined(OLC_PLATFORM_EMSCRIPTEN)
 			eglSwapBuffers(olc_Display, olc_Surface);
 #endif
+
+#if defined(OLC_PLATFORM_HEADLESS)
+			// A pbuffer has nothing to swap, and keeps the frame for reading back. Waiting
+			// for the GPU here keeps frame times honest, as a swap would with VSYNC
+			glFinish();
+#endif
 		}
 
 		void PrepareDrawing() override
 		{
 			glEnable(GL_BLEND);
 			nDecalMode = DecalMode::NORMAL;
+			nBoundTexture = uint32_t(-1);
 			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 			locUseProgram(m_nQuadShader);
 			locBindVertexArray(m_vaQuad);
@@ -4996,9 +6083,9 @@ namespace olc
 		{
 			SetDecalMode(decal.mode);
 			if (decal.decal == nullptr)
-				glBindTexture(GL_TEXTURE_2D, rendBlankQuad.Decal()->id);
+				BindTexture(rendBlankQuad.Decal()->id);
 			else
-				glBindTexture(GL_TEXTURE_2D, decal.decal->id);
+				BindTexture(decal.decal->id);
 
 			locBindBuffer(0x8892, m_vbQuad);
 
@@ -5026,7 +6113,7 @@ namespace olc
 			UNUSED(height);
 			uint32_t id = 0;
 			glGenTextures(1, &id);
-			glBindTexture(GL_TEXTURE_2D, id);
+			BindTexture(id);
 
 			if (filtered)
 			{
@@ -5057,14 +6144,27 @@ namespace olc
 
 		uint32_t DeleteTexture(const uint32_t id) override
 		{
+			// Deleting the bound texture unbinds it, and its name may be handed out again
+			if (id == nBoundTexture) nBoundTexture = uint32_t(-1);
+			if (id < vTextureSize.size()) vTextureSize[id] = { 0, 0 };
 			glDeleteTextures(1, &id);
 			return id;
 		}
 
 		void UpdateTexture(uint32_t id, olc::Sprite* spr) override
 		{
-			UNUSED(id);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+			// Uploads go to the bound texture, which is expected to be id
+			if (id >= vTextureSize.size()) vTextureSize.resize(size_t(id) + 1, { 0, 0 });
+			if (vTextureSize[id] != spr->Size())
+			{
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, spr->width, spr->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+				vTextureSize[id] = spr->Size();
+				return;
+			}
+
+			const size_t nBytes = size_t(spr->width) * size_t(spr->height) * sizeof(olc::Pixel);
+			if (bStreaming && nBytes >= nStreamMinBytes && StreamTexture(spr, nBytes)) return;
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
 		void ReadTexture(uint32_t id, olc::Sprite* spr) override
@@ -5072,9 +6172,14 @@ namespace olc
 			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
 		}
 
+		void ReadFrame(olc::Sprite* spr) override
+		{
+			glReadPixels(0, 0, spr->width, spr->height, GL_RGBA, GL_UNSIGNED_BYTE, spr->GetData());
+		}
+
 		void ApplyTexture(uint32_t id) override
 		{
-			glBindTexture(GL_TEXTURE_2D, id);
+			BindTexture(id);
 		}
 
 		void ClearBuffer(olc::Pixel p, bool bDepth) override
@@ -5096,9 +6201,12 @@ namespace olc
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
+#endif // Headless
+
 // O------------------------------------------------------------------------------O
 // | olcPixelGameEngine Image loaders                                             |
 // O------------------------------------------------------------------------------O
+// Image loaders need no window, so stay available to headless builds (e.g. tools)
 
 #pragma region image_gdi
 // O------------------------------------------------------------------------------O
@@ -5211,7 +6319,8 @@ namespace olc
 
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
-			return olc::rcode::OK;
+			// Not supported, nothing is written
+			return olc::rcode::FAIL;
 		}
 	};
 }
@@ -5253,15 +6362,18 @@ namespace olc
 			// https://gist.github.com/niw/5963798
 			// Also reading png from streams
 			// http://www.piko3d.net/tutorials/libpng-tutorial-loading-png-files-from-streams/
-			png_structp png;
-			png_infop info;
+			png_structp png = nullptr;
+			png_infop info = nullptr;
+
+			// Declared ahead of setjmp(), so libpng bailing out never skips their cleanup
+			FILE* f = nullptr;
+			std::vector<png_bytep> vRows;
 
 			auto loadPNG = [&]()
 			{
 				png_read_info(png, info);
 				png_byte color_type;
 				png_byte bit_depth;
-				png_bytep* row_pointers;
 				spr->width = png_get_image_width(png, info);
 				spr->height = png_get_image_height(png, info);
 				color_type = png_get_color_type(png, info);
@@ -5274,32 +6386,26 @@ namespace olc
 					png_set_filler(png, 0xFF, PNG_FILLER_AFTER);
 				if (color_type == PNG_COLOR_TYPE_GRAY || color_type == PNG_COLOR_TYPE_GRAY_ALPHA)
 					png_set_gray_to_rgb(png);
+				png_set_interlace_handling(png);
 				png_read_update_info(png, info);
-				row_pointers = (png_bytep*)malloc(sizeof(png_bytep) * spr->height);
-				for (int y = 0; y < spr->height; y++) {
-					row_pointers[y] = (png_byte*)malloc(png_get_rowbytes(png, info));
-				}
-				png_read_image(png, row_pointers);
-				////////////////////////////////////////////////////////////////////////////
-				// Create sprite array
-				spr->pColData.resize(spr->width * spr->height);
-				// Iterate through image rows, converting into sprite format
-				for (int y = 0; y < spr->height; y++)
-				{
-					png_bytep row = row_pointers[y];
-					for (int x = 0; x < spr->width; x++)
-					{
-						png_bytep px = &(row[x * 4]);
-						spr->SetPixel(x, y, Pixel(px[0], px[1], px[2], px[3]));
-					}
-				}
 
-				for (int y = 0; y < spr->height; y++) // Thanks maksym33
-					free(row_pointers[y]);
-				free(row_pointers);
-				png_destroy_read_struct(&png, &info, nullptr);
+				// Every format is now RGBA8, the byte order of olc::Pixel, so libpng
+				// decodes each row straight into its place in the sprite
+				if (png_get_rowbytes(png, info) != size_t(spr->width) * sizeof(olc::Pixel))
+					png_error(png, "unexpected row size");
+				spr->pColData.resize(size_t(spr->width) * size_t(spr->height));
+				vRows.resize(spr->height);
+				for (int y = 0; y < spr->height; y++)
+					vRows[y] = reinterpret_cast<png_bytep>(spr->pColData.data() + size_t(y) * size_t(spr->width));
+				png_read_image(png, vRows.data());
 			};
 
+			if (pack == nullptr)
+			{
+				f = fopen(sImageFile.c_str(), "rb");
+				if (!f) return olc::rcode::NO_FILE;
+			}
+
 			png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
 			if (!png) goto fail_load;
 
@@ -5310,8 +6416,6 @@ namespace olc
 
 			if (pack == nullptr)
 			{
-				FILE* f = fopen(sImageFile.c_str(), "rb");
-				if (!f) return olc::rcode::NO_FILE;
 				png_init_io(png, f);
 				loadPNG();
 				fclose(f);
@@ -5324,9 +6428,12 @@ namespace olc
 				loadPNG();
 			}
 
+			png_destroy_read_struct(&png, &info, nullptr);
 			return olc::rcode::OK;
 
 		fail_load:
+			if (f) fclose(f);
+			if (png) png_destroy_read_struct(&png, info ? &info : nullptr, nullptr);
 			spr->width = 0;
 			spr->height = 0;
 			spr->pColData.clear();
@@ -5335,8 +6442,47 @@ namespace olc
 
 		olc::rcode SaveImageResource(olc::Sprite* spr, const std::string& sImageFile) override
 		{
-			return olc::rcode::OK;
+			if (spr == nullptr || spr->width <= 0 || spr->height <= 0) return olc::rcode::FAIL;
+
+			png_structp png = nullptr;
+			png_infop info = nullptr;
+			std::vector<png_bytep> vRows(spr->height);
+
+			FILE* f = fopen(sImageFile.c_str(), "wb");
+			if (!f) return olc::rcode::NO_FILE;
+
+			png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+			if (!png) goto fail_save;
+
+			info = png_create_info_struct(png);
+			if (!info) goto fail_save;
+
+			if (setjmp(png_jmpbuf(png))) goto fail_save;
+
+			png_init_io(png, f);
+			png_set_IHDR(png, info, spr->width, spr->height, 8, PNG_COLOR_TYPE_RGBA,
+				PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+			// Saving is usually screenshots and captured frames, where speed beats size
+			png_set_compression_level(png, 1);
+			png_write_info(png, info);
+
+			// olc::Pixel is already RGBA8, so rows go straight from the sprite
+			for (int y = 0; y < spr->height; y++)
+				vRows[y] = reinterpret_cast<png_bytep>(spr->pColData.data() + size_t(y) * size_t(spr->width));
+			png_write_image(png, vRows.data());
+			png_write_end(png, nullptr);
+
+			png_destroy_write_struct(&png, &info);
+			return fclose(f) == 0 ? olc::rcode::OK : olc::rcode::FAIL;
+
+		fail_save:
+			fclose(f);
+			if (png) png_destroy_write_struct(&png, info ? &info : nullptr);
+			return olc::rcode::FAIL;
 		}
+
+		std::unique_ptr<olc::ImageLoader> Clone() const override
+		{ return std::make_unique<ImageLoader_LibPNG>(); }
 	};
 }
 #endif
@@ -5345,6 +6491,8 @@ namespace olc
 // O------------------------------------------------------------------------------O
 #pragma endregion
 
+#if !defined(OLC_PGE_HEADLESS)
+
 
 // O------------------------------------------------------------------------------O
 // | olcPixelGameEngine Platforms                                                 |
@@ -5621,6 +6769,26 @@ namespace olc
 		X11::Colormap                olc_ColourMap;
 		X11::XSetWindowAttributes    olc_SetWindowAttribs;
 
+		// Offset from the X server's millisecond clock to steady_clock
+		std::chrono::steady_clock::duration dServerClock{};
+		bool bServerClock = false;
+
+		// When an event really happened, rather than when this frame got round to it. An event
+		// arrives some time after its timestamp, so the smallest gap seen is the best guess
+		// at the clock offset. A gap over a second bigger means the 32-bit clock wrapped
+		std::chrono::steady_clock::time_point EventTime(X11::Time t)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			const auto server = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::milliseconds(uint32_t(t)));
+			const auto offset = now.time_since_epoch() - server;
+			if (!bServerClock || offset < dServerClock || offset - dServerClock > std::chrono::seconds(1))
+			{
+				dServerClock = offset;
+				bServerClock = true;
+			}
+			return std::min(std::chrono::steady_clock::time_point(server + dServerClock), now);
+		}
+
 	public:
 		virtual olc::rcode ApplicationStartUp() override
 		{
@@ -5686,6 +6854,9 @@ namespace olc
 			XMapWindow(olc_Display, olc_Window);
 			XStoreName(olc_Display, olc_Window, "OneLoneCoder.com - Pixel Game Engine");
 
+			// Held keys repeat as presses only, not release/press pairs that look like taps
+			XkbSetDetectableAutoRepeat(olc_Display, True, nullptr);
+
 			if (bFullScreen) // Thanks DragonEye, again :D
 			{
 				Atom wm_state;
@@ -5792,45 +6963,49 @@ namespace olc
 				}
 				else if (xev.type == KeyPress)
 				{
+					const auto tp = EventTime(xev.xkey.time);
 					KeySym sym = XLookupKeysym(&xev.xkey, 0);
-					ptrPGE->olc_UpdateKeyState(mapKeys[sym], true);
+					ptrPGE->olc_UpdateKeyState(mapKeys[sym], true, tp);
 					XKeyEvent* e = (XKeyEvent*)&xev; // Because DragonEye loves numpads
 					XLookupString(e, NULL, 0, &sym, NULL);
-					ptrPGE->olc_UpdateKeyState(mapKeys[sym], true);
+					ptrPGE->olc_UpdateKeyState(mapKeys[sym], true, tp);
 				}
 				else if (xev.type == KeyRelease)
 				{
+					const auto tp = EventTime(xev.xkey.time);
 					KeySym sym = XLookupKeysym(&xev.xkey, 0);
-					ptrPGE->olc_UpdateKeyState(mapKeys[sym], false);
+					ptrPGE->olc_UpdateKeyState(mapKeys[sym], false, tp);
 					XKeyEvent* e = (XKeyEvent*)&xev;
 					XLookupString(e, NULL, 0, &sym, NULL);
-					ptrPGE->olc_UpdateKeyState(mapKeys[sym], false);
+					ptrPGE->olc_UpdateKeyState(mapKeys[sym], false, tp);
 				}
 				else if (xev.type == ButtonPress)
 				{
+					const auto tp = EventTime(xev.xbutton.time);
 					switch (xev.xbutton.button)
 					{
-					case 1:	ptrPGE->olc_UpdateMouseState(0, true); break;
-					case 2:	ptrPGE->olc_UpdateMouseState(2, true); break;
-					case 3:	ptrPGE->olc_UpdateMouseState(1, true); break;
-					case 4:	ptrPGE->olc_UpdateMouseWheel(120); break;
-					case 5:	ptrPGE->olc_UpdateMouseWheel(-120); break;
+					case 1:	ptrPGE->olc_UpdateMouseState(0, true, tp); break;
+					case 2:	ptrPGE->olc_UpdateMouseState(2, true, tp); break;
+					case 3:	ptrPGE->olc_UpdateMouseState(1, true, tp); break;
+					case 4:	ptrPGE->olc_UpdateMouseWheel(120, tp); break;
+					case 5:	ptrPGE->olc_UpdateMouseWheel(-120, tp); break;
 					default: break;
 					}
 				}
 				else if (xev.type == ButtonRelease)
 				{
+					const auto tp = EventTime(xev.xbutton.time);
 					switch (xev.xbutton.button)
 					{
-					case 1:	ptrPGE->olc_UpdateMouseState(0, false); break;
-					case 2:	ptrPGE->olc_UpdateMouseState(2, false); break;
-					case 3:	ptrPGE->olc_UpdateMouseState(1, false); break;
+					case 1:	ptrPGE->olc_UpdateMouseState(0, false, tp); break;
+					case 2:	ptrPGE->olc_UpdateMouseState(2, false, tp); break;
+					case 3:	ptrPGE->olc_UpdateMouseState(1, false, tp); break;
 					default: break;
 					}
 				}
 				else if (xev.type == MotionNotify)
 				{
-					ptrPGE->olc_UpdateMouse(xev.xmotion.x, xev.xmotion.y);
+					ptrPGE->olc_UpdateMouse(xev.xmotion.x, xev.xmotion.y, EventTime(xev.xmotion.time));
 				}
 				else if (xev.type == FocusIn)
 				{
@@ -112,7 +112,7 @@
 	1) Include the header file "olcSoundWaveEngine.h" from a .cpp file in your project.
 	2) Build with the following command:
 
-		g++ olcSoundWaveEngineExample.cpp -o olcSoundWaveEngineExample -lpulse -lpulse-simple -std=c++17
+		g++ olcSoundWaveEngineExample.cpp -o olcSoundWaveEngineExample -lpulse -std=c++17
 
 	3) That's it!
 	
@@ -170,12 +170,22 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <initializer_list>
+
+#include "olcMappedFile.h"
 
 // Compiler/System Sensitivity
 #if !defined(SOUNDWAVE_USING_WINMM) && !defined(SOUNDWAVE_USING_WASAPI) &&  \
     !defined(SOUNDWAVE_USING_XAUDIO) && !defined(SOUNDWAVE_USING_OPENAL) && \
     !defined(SOUNDWAVE_USING_ALSA) && !defined(SOUNDWAVE_USING_SDLMIXER) && \
-    !defined(SOUNDWAVE_USING_PULSE)                                         \
+    !defined(SOUNDWAVE_USING_PULSE) && !defined(SOUNDWAVE_USING_OFFLINE)    \
 
 	#if defined(_WIN32)
 		#define SOUNDWAVE_USING_WINMM
@@ -192,11 +202,60 @@
 
 #endif
 
+// Vector instructions for sample format conversion
+#if !defined(SOUNDWAVE_NO_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define SOUNDWAVE_SIMD_SSE2
+		#include <emmintrin.h>
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define SOUNDWAVE_SIMD_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
 namespace olc::sound
 {
 
 	namespace wave
 	{
+	// Writes a canonical RIFF/WAVE header. 32-bit samples are written as IEEE float,
+	// everything else as integer PCM. Float files carry the "fact" chunk they require,
+	// but not the optional cbSize, which keeps the audio data 8-byte aligned so
+	// LoadFile() can use it in place. Returns the offset of the audio data
+	inline size_t WriteHeader(std::ostream& os, const size_t nChannels, const size_t nSampleRate, const size_t nSampleSize, const size_t nSamples)
+	{
+		const bool bFloat = nSampleSize == 4;
+		const uint32_t nDataBytes = uint32_t(nSamples * nChannels * nSampleSize);
+		const uint32_t nHeaderBytes = bFloat ? 56 : 44;
+
+		auto Write16 = [&](uint16_t n) { os.write(reinterpret_cast<const char*>(&n), sizeof(n)); };
+		auto Write32 = [&](uint32_t n) { os.write(reinterpret_cast<const char*>(&n), sizeof(n)); };
+
+		os.write("RIFF", 4);
+		Write32(nHeaderBytes - 8 + nDataBytes);
+		os.write("WAVE", 4);
+
+		os.write("fmt ", 4);
+		Write32(16);
+		Write16(bFloat ? 0x0003 : 0x0001);
+		Write16(uint16_t(nChannels));
+		Write32(uint32_t(nSampleRate));
+		Write32(uint32_t(nSampleRate * nChannels * nSampleSize));
+		Write16(uint16_t(nChannels * nSampleSize));
+		Write16(uint16_t(nSampleSize * 8));
+
+		if (bFloat)
+		{
+			os.write("fact", 4);
+			Write32(4);
+			Write32(uint32_t(nSamples));
+		}
+
+		os.write("data", 4);
+		Write32(nDataBytes);
+		return nHeaderBytes;
+	}
+
 	// Physically represents a .WAV file, but the data is stored
 	// as normalised floating point values
 	template<class T = float>
@@ -215,12 +274,19 @@ namespace olc::sound
 			m_dDurationInSamples = double(m_nSamples);
 
 			m_pRawData = std::make_unique<T[]>(m_nSamples * m_nChannels);
+			m_pData = m_pRawData.get();
 		}
 
 	public:
 		T* data() const
 		{
-			return m_pRawData.get();
+			return m_pData;
+		}
+
+		// True if the sample data is referenced directly from a memory mapped file
+		bool mapped() const
+		{
+			return m_pMapping != nullptr;
 		}
 
 		size_t samples() const
@@ -255,10 +321,19 @@ namespace olc::sound
 
 		bool LoadFile(const std::string& sFilename)
 		{
-			std::ifstream ifs(sFilename, std::ios::binary);
-			if (!ifs.is_open())
+			m_pMapping.reset();
+			m_pRawData.reset();
+			m_pData = nullptr;
+
+			// The file is memory mapped rather than streamed, so raw float32 data
+			// chunks can be used in place without any copying at all
+			std::shared_ptr<olc::MappedFile> pFile = olc::MappedFile::Open(sFilename);
+			if (!pFile)
 				return false;
 
+			const uint8_t* pBytes = pFile->data();
+			const size_t nBytes = pFile->size();
+
 			struct WaveFormatHeader
 			{
 				uint16_t wFormatTag;         /* format type */
@@ -269,102 +344,237 @@ namespace olc::sound
 				uint16_t wBitsPerSample;     /* number of bits per sample of mono data */
 			};
 
+			constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+			constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
 			WaveFormatHeader header{ 0 };
+			uint16_t wSubFormatTag = 0;
+			bool bHaveFormat = false;
 
-			m_pRawData.reset();
+			if (nBytes < 12 || strncmp((const char*)pBytes, "RIFF", 4) != 0 || strncmp((const char*)pBytes + 8, "WAVE", 4) != 0)
+				return false;
+
+			// Walk the chunks, looking for the format description and the audio data
+			size_t nOffset = 12;
+			while (nOffset + 8 <= nBytes)
+			{
+				const char* sChunkID = (const char*)pBytes + nOffset;
+				uint32_t nChunksize = 0;
+				std::memcpy(&nChunksize, pBytes + nOffset + 4, sizeof(uint32_t));
+				nOffset += 8;
 
-			char dump[4];
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read "RIFF"
-			if (strncmp(dump, "RIFF", 4) != 0) return false;
+				if (strncmp(sChunkID, "fmt ", 4) == 0 && nOffset + sizeof(WaveFormatHeader) <= nBytes)
+				{
+					std::memcpy(&header, pBytes + nOffset, sizeof(WaveFormatHeader));
+					// WAVEFORMATEXTENSIBLE keeps the real format tag at the start of its SubFormat GUID
+					if (header.wFormatTag == WAVE_FORMAT_EXTENSIBLE && nChunksize >= 26 && nOffset + 26 <= nBytes)
+						std::memcpy(&wSubFormatTag, pBytes + nOffset + 24, sizeof(uint16_t));
+					bHaveFormat = true;
+				}
+				else if (strncmp(sChunkID, "data", 4) == 0)
+				{
+					if (!bHaveFormat || header.nChannels == 0 || header.wBitsPerSample < 8)
+						return false;
 
-			ifs.read(dump, sizeof(uint8_t) * 4); // Not Interested
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read "WAVE"
-			if (strncmp(dump, "WAVE", 4) != 0) return false;
+					// Tolerate truncated files, and "streaming" sizes of 0xFFFFFFFF
+					size_t nDataBytes = std::min(size_t(nChunksize), nBytes - nOffset);
 
-			// Read Wave description chunk
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read "fmt "
-			ifs.read(dump, sizeof(uint8_t) * 4); // Not Interested
-			ifs.read((char*)&header, sizeof(WaveFormatHeader)); // Read Wave Format Structure chunk
+					m_nSampleSize = header.wBitsPerSample >> 3;
+					m_nChannels = header.nChannels;
+					m_nSamples = nDataBytes / (m_nChannels * m_nSampleSize);
+					m_nSampleRate = header.nSamplesPerSec;
+					m_dDuration = double(m_nSamples) / double(m_nSampleRate);
+					m_dDurationInSamples = double(m_nSamples);
 
-			// Search for audio data chunk
-			int32_t nChunksize = 0;
-			ifs.read(dump, sizeof(uint8_t) * 4); // Read chunk header
-			ifs.read((char*)&nChunksize, sizeof(uint32_t)); // Read chunk size
+					const uint8_t* pData = pBytes + nOffset;
+					const bool bFloat = header.wFormatTag == WAVE_FORMAT_IEEE_FLOAT || wSubFormatTag == WAVE_FORMAT_IEEE_FLOAT;
 
-			while (strncmp(dump, "data", 4) != 0)
-			{
-				// Not audio data, so just skip it
-				ifs.seekg(nChunksize, std::ios::cur);
-				ifs.read(dump, sizeof(uint8_t) * 4); // Read next chunk header
-				ifs.read((char*)&nChunksize, sizeof(uint32_t)); // Read next chunk size
+					if constexpr (std::is_same_v<T, float>)
+					{
+						// Float data is already in our native format, so just point at it
+						if (bFloat && m_nSampleSize == sizeof(float) && (reinterpret_cast<uintptr_t>(pData) % alignof(float)) == 0)
+						{
+							m_pMapping = pFile;
+							m_pData = reinterpret_cast<T*>(pFile->data() + nOffset);
+							return true;
+						}
+					}
+
+					m_pRawData = std::make_unique<T[]>(m_nSamples * m_nChannels);
+					m_pData = m_pRawData.get();
+					Decode(pData, bFloat);
+					return true;
+				}
+
+				// Chunks are word aligned
+				nOffset += size_t(nChunksize) + (nChunksize & 1);
 			}
 
-			// Finally got to data, so read it all in and convert to float samples
-			m_nSampleSize = header.wBitsPerSample >> 3;
-			m_nSamples = nChunksize / (header.nChannels * m_nSampleSize);
-			m_nChannels = header.nChannels;
-			m_nSampleRate = header.nSamplesPerSec;
-			m_pRawData = std::make_unique<T[]>(m_nSamples * m_nChannels);			
-			m_dDuration =  double(m_nSamples) / double(m_nSampleRate);
+			return false;
+		}
+
+		// Uses nSamples frames of interleaved float32 data nOffset bytes into an existing
+		// mapping, such as an asset bundle. Float waves reference it in place, anything
+		// else gets a converted copy
+		bool MapData(std::shared_ptr<olc::MappedFile> pFile, const size_t nOffset, const size_t nChannels, const size_t nSampleRate, const size_t nSamples)
+		{
+			if (!pFile || nChannels == 0 || nOffset > pFile->size() || nChannels * nSamples * sizeof(float) > pFile->size() - nOffset)
+				return false;
+
+			m_pMapping.reset();
+			m_pRawData.reset();
+			m_nChannels = nChannels;
+			m_nSampleSize = sizeof(float);
+			m_nSampleRate = nSampleRate;
+			m_nSamples = nSamples;
+			m_dDuration = double(m_nSamples) / double(m_nSampleRate);
 			m_dDurationInSamples = double(m_nSamples);
 
-			T* pSample = m_pRawData.get();
+			const uint8_t* pData = pFile->data() + nOffset;
+			if constexpr (std::is_same_v<T, float>)
+			{
+				if ((reinterpret_cast<uintptr_t>(pData) % alignof(float)) == 0)
+				{
+					m_pMapping = pFile;
+					m_pData = reinterpret_cast<T*>(pFile->data() + nOffset);
+					return true;
+				}
+			}
+
+			m_pRawData = std::make_unique<T[]>(m_nSamples * m_nChannels);
+			m_pData = m_pRawData.get();
+			Decode(pData, true);
+			return true;
+		}
+
+		// Writes the file in its original sample size. 32-bit data is always written as
+		// IEEE float, which LoadFile() can then use in place without decoding
+		bool SaveFile(const std::string& sFilename)
+		{
+			if (m_pData == nullptr || m_nSampleSize < 1 || m_nSampleSize > 4)
+				return false;
+
+			std::ofstream ofs(sFilename, std::ios::binary);
+			if (!ofs.is_open())
+				return false;
+
+			WriteHeader(ofs, m_nChannels, m_nSampleRate, m_nSampleSize, m_nSamples);
+
+			// Encode in chunks to keep the scratch space small
+			constexpr size_t nChunk = 4096;
+			std::vector<uint8_t> vBuffer(nChunk * m_nSampleSize);
+			const size_t nValues = m_nSamples * m_nChannels;
 
-			// Read in audio data and normalise
-			for (long i = 0; i < m_nSamples; i++)
+			for (size_t nStart = 0; nStart < nValues; nStart += nChunk)
 			{
-				for (int c = 0; c < m_nChannels; c++)
+				const size_t nCount = std::min(nChunk, nValues - nStart);
+				uint8_t* pOut = vBuffer.data();
+				for (size_t i = 0; i < nCount; i++)
 				{
+					const double d = std::clamp(double(m_pData[nStart + i]), -1.0, 1.0);
 					switch (m_nSampleSize)
 					{
 					case 1:
 					{
-						int8_t s = 0;
-						ifs.read((char*)&s, sizeof(int8_t));
-						*pSample = T(s) / T(std::numeric_limits<int8_t>::max());
+						uint8_t n = uint8_t(std::lrint(d * 127.0) + 128);
+						std::memcpy(pOut, &n, 1);
 					}
 					break;
 
 					case 2:
 					{
-						int16_t s = 0;
-						ifs.read((char*)&s, sizeof(int16_t));
-						*pSample = T(s) / T(std::numeric_limits<int16_t>::max());
+						int16_t n = int16_t(std::lrint(d * double(std::numeric_limits<int16_t>::max())));
+						std::memcpy(pOut, &n, 2);
 					}
 					break;
 
-					case 3: // 24-bit
+					case 3:
 					{
-						int32_t s = 0;
-						ifs.read((char*)&s, 3);
-						if (s & (1 << 23)) s |= 0xFF000000;
-						*pSample = T(s) / T(std::pow(2, 23)-1);
+						int32_t n = int32_t(std::lrint(d * (std::pow(2, 23) - 1)));
+						std::memcpy(pOut, &n, 3); // Little endian, so the low three bytes
 					}
 					break;
 
 					case 4:
 					{
-						int32_t s = 0;
-						ifs.read((char*)&s, sizeof(int32_t));
-						*pSample = T(s) / T(std::numeric_limits<int32_t>::max());
+						float f = float(m_pData[nStart + i]);
+						std::memcpy(pOut, &f, 4);
 					}
 					break;
 					}
-
-					pSample++;
+					pOut += m_nSampleSize;
 				}
+				ofs.write(reinterpret_cast<const char*>(vBuffer.data()), nCount * m_nSampleSize);
 			}
-			return true;
+
+			return ofs.good();
 		}
 
-		bool SaveFile(const std::string& sFilename)
+
+	private:
+		// Convert interleaved audio data into normalised samples
+		void Decode(const uint8_t* pData, const bool bFloat)
 		{
-			return false;
-		}
+			T* pSample = m_pData;
+			const size_t nValues = m_nSamples * m_nChannels;
+
+			for (size_t i = 0; i < nValues; i++)
+			{
+				switch (m_nSampleSize)
+				{
+				case 1: // 8-bit wave data is unsigned
+				{
+					uint8_t s = 0;
+					std::memcpy(&s, pData, sizeof(uint8_t));
+					*pSample = T(int(s) - 128) / T(std::numeric_limits<int8_t>::max());
+				}
+				break;
+
+				case 2:
+				{
+					int16_t s = 0;
+					std::memcpy(&s, pData, sizeof(int16_t));
+					*pSample = T(s) / T(std::numeric_limits<int16_t>::max());
+				}
+				break;
+
+				case 3: // 24-bit
+				{
+					int32_t s = 0;
+					std::memcpy(&s, pData, 3);
+					if (s & (1 << 23)) s |= 0xFF000000;
+					*pSample = T(s) / T(std::pow(2, 23)-1);
+				}
+				break;
+
+				case 4:
+				{
+					if (bFloat)
+					{
+						float s = 0.0f;
+						std::memcpy(&s, pData, sizeof(float));
+						*pSample = T(s);
+					}
+					else
+					{
+						int32_t s = 0;
+						std::memcpy(&s, pData, sizeof(int32_t));
+						*pSample = T(s) / T(std::numeric_limits<int32_t>::max());
+					}
+				}
+				break;
+				}
 
+				pData += m_nSampleSize;
+				pSample++;
+			}
+		}
 
 	protected:
+		// Points either into m_pRawData, or directly into m_pMapping
+		T* m_pData = nullptr;
 		std::unique_ptr<T[]> m_pRawData;
+		std::shared_ptr<olc::MappedFile> m_pMapping;
 		size_t m_nSamples = 0;
 		size_t m_nChannels = 0;
 		size_t m_nSampleRate = 0;
@@ -449,8 +659,116 @@ namespace olc::sound
 		size_t m_nStride = 1;
 		size_t m_nOffset = 0;
 	};
+
+	// Converts a whole file to a new sample rate using a polyphase windowed-sinc
+	// (Kaiser) filter. This is far too slow to run per voice in the mixer, so it is
+	// intended to be run once, when a wave is loaded or first played.
+	template<class T>
+	File<T> Resample(const File<T>& src, const size_t nNewSampleRate)
+	{
+		// Zero crossings of the sinc either side of centre, and the window shape
+		constexpr int nZeroCrossings = 16;
+		constexpr int nTaps = nZeroCrossings * 2;
+		constexpr double dKaiserBeta = 8.6;
+		// Ratios such as 11025 -> 48000 need hundreds of phases, so past this the
+		// filter bank is interpolated rather than being built exactly
+		constexpr size_t nMaxPhases = 1024;
+
+		const size_t nOldSampleRate = src.samplerate();
+		const size_t nDivisor = std::gcd(nOldSampleRate, nNewSampleRate);
+		const size_t L = nNewSampleRate / nDivisor; // Upsample factor
+		const size_t M = nOldSampleRate / nDivisor; // Downsample factor
+
+		const size_t nNewSamples = size_t((uint64_t(src.samples()) * L + M - 1) / M);
+		File<T> dst(src.channels(), src.samplesize(), nNewSampleRate, nNewSamples);
+
+		// Modified Bessel function of the first kind, order 0
+		auto I0 = [](double x)
+		{
+			double dSum = 1.0, dTerm = 1.0;
+			for (int k = 1; k < 32; k++)
+			{
+				dTerm *= (x * 0.5 / k) * (x * 0.5 / k);
+				dSum += dTerm;
+			}
+			return dSum;
+		};
+
+		// When downsampling, the cutoff falls to the new Nyquist to prevent aliasing
+		const double dCutoff = std::min(1.0, double(L) / double(M)) * 0.97;
+		const size_t nPhases = std::min(L, nMaxPhases);
+
+		// Build the filter bank, one row per fractional position between input samples. An
+		// extra row at fraction 1.0 allows the rows to be interpolated for awkward ratios
+		std::vector<float> vBank((nPhases + 1) * nTaps);
+		for (size_t p = 0; p <= nPhases; p++)
+		{
+			const double dFraction = double(p) / double(nPhases);
+			float* pRow = &vBank[p * nTaps];
+			double dGain = 0.0;
+			for (int k = 0; k < nTaps; k++)
+			{
+				const double x = double(k - nZeroCrossings + 1) - dFraction;
+				const double dSinc = x == 0.0 ? 1.0 : std::sin(3.14159265358979323846 * dCutoff * x) / (3.14159265358979323846 * dCutoff * x);
+				const double r = x / double(nZeroCrossings);
+				const double dWindow = std::abs(r) >= 1.0 ? 0.0 : I0(dKaiserBeta * std::sqrt(1.0 - r * r)) / I0(dKaiserBeta);
+				pRow[k] = float(dSinc * dWindow);
+				dGain += pRow[k];
+			}
+
+			// Normalise each phase to unity DC gain, so there is no phase dependent ripple
+			for (int k = 0; k < nTaps; k++)
+				pRow[k] = float(pRow[k] / dGain);
+		}
+
+		const size_t nChannels = src.channels();
+		const int64_t nOldSamples = int64_t(src.samples());
+		const T* pSrc = src.data();
+		T* pDst = dst.data();
+		std::vector<float> vRow(nTaps);
+
+		for (size_t n = 0; n < nNewSamples; n++)
+		{
+			// Position of this output sample in the input, as integer + phase
+			const uint64_t nPos = uint64_t(n) * M;
+			const int64_t nBase = int64_t(nPos / L);
+			const size_t nPhase = size_t(nPos % L);
+
+			const float* pRow = nullptr;
+			if (L == nPhases)
+			{
+				pRow = &vBank[nPhase * nTaps];
+			}
+			else
+			{
+				const double dRow = double(nPhase) * double(nPhases) / double(L);
+				const size_t r = size_t(dRow);
+				const float t = float(dRow - double(r));
+				for (int k = 0; k < nTaps; k++)
+					vRow[k] = vBank[r * nTaps + k] + t * (vBank[(r + 1) * nTaps + k] - vBank[r * nTaps + k]);
+				pRow = vRow.data();
+			}
+
+			const int64_t nFirst = nBase - nZeroCrossings + 1;
+			for (size_t c = 0; c < nChannels; c++)
+			{
+				float fAcc = 0.0f;
+				for (int k = 0; k < nTaps; k++)
+				{
+					const int64_t i = nFirst + k;
+					if (i >= 0 && i < nOldSamples)
+						fAcc += pRow[k] * float(pSrc[size_t(i) * nChannels + c]);
+				}
+				pDst[n * nChannels + c] = T(fAcc);
+			}
+		}
+
+		return dst;
+	}
 	}
 
+	class WaveEngine;
+
 	template<typename T = float>
 	class Wave_generic
 	{
@@ -488,11 +806,75 @@ namespace olc::sound
 
 		
 
+		// Takes over sample data that has already been loaded, e.g. from an asset bundle
+		bool LoadAudioWaveform(wave::File<T>&& f)
+		{
+			vChannelView.clear();
+			file = std::move(f);
+			if (file.data() == nullptr || file.channels() == 0)
+				return false;
+
+			vChannelView.resize(file.channels());
+			for (uint32_t c = 0; c < file.channels(); c++)
+				vChannelView[c].SetData(file.data(), file.samples(), file.channels(), c);
+			return true;
+		}
+
 		bool LoadAudioWaveform(std::istream& sStream) { return false; }
 		bool LoadAudioWaveform(const char* pData, const size_t nBytes) { return false; }
 
+		// Returns this waveform at nSampleRate. The conversion is done once, the first
+		// time a rate is requested, and the result is cached for the life of the wave.
+		// The cache is a plain std::map, so only one thread may use it: a loader thread
+		// may convert a wave before handing it over, after that only the thread that
+		// plays waveforms may call this.
+		Wave_generic* Resampled(const size_t nSampleRate)
+		{
+			if (file.samplerate() == nSampleRate || file.samples() == 0)
+				return this;
+
+			auto& pResampled = m_mapResampled[nSampleRate];
+			if (!pResampled)
+			{
+				pResampled = std::make_unique<Wave_generic>();
+				pResampled->file = wave::Resample(file, nSampleRate);
+				pResampled->vChannelView.resize(pResampled->file.channels());
+				for (uint32_t c = 0; c < pResampled->file.channels(); c++)
+					pResampled->vChannelView[c].SetData(pResampled->file.data(), pResampled->file.samples(), pResampled->file.channels(), c);
+			}
+
+			return pResampled.get();
+		}
+
+		// True while a voice is playing this waveform, or a resampled copy of it. A wave that
+		// isn't playing can be freed, provided nothing is about to play it. Call from the
+		// thread that plays waveforms
+		bool IsPlaying() const
+		{
+			if (m_voices.n.load(std::memory_order_acquire) > 0) return true;
+			for (const auto& r : m_mapResampled)
+				if (r.second->IsPlaying()) return true;
+			return false;
+		}
+
 		std::vector<wave::View<T>> vChannelView;
 		wave::File<T> file;
+
+	private:
+		friend class WaveEngine;
+
+		// Voices playing this wave, counted up by PlayWaveform() and down by the audio thread
+		// as they finish. A moved or copied wave isn't playing, so starts again from zero
+		struct VoiceCount
+		{
+			VoiceCount() = default;
+			VoiceCount(const VoiceCount&) {}
+			VoiceCount& operator=(const VoiceCount&) { return *this; }
+			std::atomic<uint32_t> n{ 0 };
+		};
+		VoiceCount m_voices;
+
+		std::map<size_t, std::unique_ptr<Wave_generic>> m_mapResampled;
 	};
 
 	typedef Wave_generic<float> Wave;
@@ -506,9 +888,97 @@ namespace olc::sound
 		bool bFinished = false;
 		bool bLoop = false;
 		bool bFlagForStop = false;
+		// Wave is at the device rate and unmodified speed, so no interpolation is needed
+		bool bNativeRate = false;
+	};
+
+	// Fixed size slots, carved from one allocation up front, for memory the audio thread
+	// would otherwise hand back to the heap - a free() can take a lock, or worse. Slots are
+	// taken by one thread (the one playing waves) and returned by another (the audio
+	// thread), so a lock-free stack is enough: with only one thread popping, ABA can't
+	// happen. If the slots run out, the heap is used instead
+	class AudioArena
+	{
+	public:
+		static constexpr size_t nSlotSize = 128;
+
+	public:
+		AudioArena(const size_t nSlots);
+		AudioArena(const AudioArena&) = delete;
+		AudioArena& operator=(const AudioArena&) = delete;
+
+	public:
+		void* Allocate(const size_t nBytes);
+		void Deallocate(void* p, const size_t nBytes);
+		// Slots in use right now
+		size_t InUse() const;
+		const void* data() const;
+		size_t size() const;
+
+	private:
+		struct Slot { Slot* pNext; };
+		std::unique_ptr<uint8_t[]> m_pMemory;
+		size_t m_nSlots = 0;
+		std::atomic<Slot*> m_pFree{ nullptr };
+		std::atomic<size_t> m_nInUse{ 0 };
+	};
+
+	template<class T>
+	struct ArenaAllocator
+	{
+		using value_type = T;
+		AudioArena* pArena = nullptr;
+
+		ArenaAllocator(AudioArena* pArena) : pArena(pArena) {}
+		template<class U> ArenaAllocator(const ArenaAllocator<U>& other) : pArena(other.pArena) {}
+
+		T* allocate(const size_t n)
+		{
+			static_assert(alignof(T) <= alignof(std::max_align_t), "ArenaAllocator: over-aligned type");
+			return static_cast<T*>(pArena->Allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* p, const size_t n)
+		{
+			pArena->Deallocate(p, n * sizeof(T));
+		}
+
+		template<class U> bool operator ==(const ArenaAllocator<U>& other) const { return pArena == other.pArena; }
+		template<class U> bool operator !=(const ArenaAllocator<U>& other) const { return pArena != other.pArena; }
 	};
 
-	typedef std::list<WaveInstance>::iterator PlayingWave;
+	typedef std::list<WaveInstance, ArenaAllocator<WaveInstance>> WaveInstanceList;
+	typedef WaveInstanceList::iterator PlayingWave;
+
+	// Snapshot of how the audio thread is coping. Callback times are measured around
+	// the mixing of each block, and compared against the time the block lasts for
+	struct AudioStats
+	{
+		// Bucket n counts blocks mixed in [n*10%, (n+1)*10%) of the block period,
+		// the final bucket collects everything slower than that
+		static constexpr size_t nHistogramBuckets = 16;
+
+		uint64_t nBlocks = 0;
+		// Blocks that took longer to mix than they take to play
+		uint64_t nDeadlineMisses = 0;
+		// Times the device ran dry (as reported by the driver, where it can)
+		uint64_t nUnderruns = 0;
+		uint32_t nPeakVoices = 0;
+		double dBlockPeriod = 0.0;
+		double dWorstCallback = 0.0;
+		double dMeanCallback = 0.0;
+		// Time from a sample being mixed to it being heard, see WaveEngine::GetOutputLatency()
+		double dOutputLatency = 0.0;
+		// An audio thread got realtime scheduling, see WaveEngine::UseRealtimeAudio()
+		bool bRealtime = false;
+		// Heap use while mixing - only counted when built with SOUNDWAVE_DEBUG_ALLOCATIONS
+		uint64_t nMixerAllocations = 0;
+		std::array<uint64_t, nHistogramBuckets> vHistogram{};
+
+		// Approximate fraction of the block period that fPercentile (0 - 1) of
+		// blocks were mixed within, e.g. Percentile(0.99f)
+		double Percentile(const float fPercentile) const;
+	};
 
 	namespace driver
 	{
@@ -543,28 +1013,60 @@ namespace olc::sound
 		// Specify a device for audio input prior to calling InitialiseAudio()
 		void UseInputDevice(const std::string& sDeviceOut);
 
+		// Opt in prior to calling InitialiseAudio(). Audio threads ask for realtime scheduling
+		// (SCHED_FIFO, falling back to a raised priority if not permitted). Once the driver
+		// has started, everything mapped by then - its buffers and thread stacks included -
+		// is locked into RAM, along with waves passed to PrepareWaveform() later, so neither
+		// CPU load nor paging can make the mixer miss a deadline
+		void UseRealtimeAudio(const bool bRealtime = true);
+
 
 		void SetCallBack_NewSample(std::function<void(double)> func);
 		void SetCallBack_SynthFunction(std::function<float(uint32_t, double)> func);
 		void SetCallBack_FilterFunction(std::function<float(uint32_t, double, float)> func);
+		// As SetCallBack_SynthFunction(), but a whole block of a channel at a time - func(nChannel,
+		// dTime, nSamples, pBuffer) adds its output to pBuffer. Suits synth::ModularSynth
+		void SetCallBack_SynthBlockFunction(std::function<void(uint32_t, double, uint32_t, float*)> func);
 
 	public:
 		void SetOutputVolume(const float fVolume);
 
 
 
+		// driver::Offline only - mixes dSeconds of audio straight away, on the calling thread,
+		// as fast as the mixer can go (rounded up to whole blocks). Returns false if the
+		// driver in use plays in real time. The offline driver has no clock of its own, so
+		// nothing is mixed and the engine's time stands still until this is called: voices
+		// played in the meantime don't start, let alone finish, and just accumulate
+		bool RenderOffline(const double dSeconds);
+
+		// Audio thread telemetry, safe to call from any thread
+		AudioStats GetAudioStats() const;
+		// Seconds between a sample being mixed and it leaving the speakers. Measured by the
+		// device where the driver can, otherwise the length of the block queue
+		double GetOutputLatency() const;
+		void ResetAudioStats();
+
+		// Converts a waveform to the device sample rate ahead of time, so playing it
+		// for the first time doesn't have to. Call after InitialiseAudio(), from the
+		// thread that plays waveforms
+		void PrepareWaveform(Wave* pWave);
 		PlayingWave PlayWaveform(Wave* pWave, bool bLoop = false, double dSpeed = 1.0);
 		void StopWaveform(const PlayingWave& w);
 		void StopAll();
 
 	private:
-		uint32_t FillOutputBuffer(std::vector<float>& vBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples);
+		uint32_t FillOutputBuffer(float* pBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples);
+		void RecordBlockTiming(const std::chrono::nanoseconds& tCallback);
+		void RecordUnderrun();
 
 	private:
 		std::unique_ptr<driver::Base> m_driver;
 		std::function<void(double)> m_funcNewSample;
 		std::function<float(uint32_t, double)> m_funcUserSynth;
 		std::function<float(uint32_t, double, float)> m_funcUserFilter;
+		std::function<void(uint32_t, double, uint32_t, float*)> m_funcUserSynthBlock;
+		std::vector<float> m_vSynthBlock;
 
 
 	private:
@@ -581,7 +1083,24 @@ namespace olc::sound
 		std::string m_sOutputDevice;
 
 	private:
-		std::list<WaveInstance> m_listWaves;
+		// Declared before the list, which allocates from it
+		AudioArena m_arenaVoices{ 512 };
+		WaveInstanceList m_listWaves{ ArenaAllocator<WaveInstance>(&m_arenaVoices) };
+		bool m_bRealtimeRequested = false;
+		std::atomic<bool> m_bRealtimeActive{ false };
+
+	private:
+		// Written only by the audio thread, read by anyone
+		struct
+		{
+			std::atomic<uint64_t> nBlocks{ 0 };
+			std::atomic<uint64_t> nDeadlineMisses{ 0 };
+			std::atomic<uint64_t> nUnderruns{ 0 };
+			std::atomic<uint64_t> nTotalNanoseconds{ 0 };
+			std::atomic<uint64_t> nWorstNanoseconds{ 0 };
+			std::atomic<uint32_t> nPeakVoices{ 0 };
+			std::array<std::atomic<uint64_t>, AudioStats::nHistogramBuckets> vHistogram{};
+		} m_stats;
 
 	public:
 		uint32_t GetSampleRate() const;
@@ -598,6 +1117,22 @@ namespace olc::sound
 
 	namespace driver
 	{
+	// Sample formats a device can be fed with. S24 is 24-bit audio held in the low
+	// three bytes of a 32-bit little endian word (ALSA's S24_LE)
+	enum class SampleFormat
+	{
+		Float32,
+		S16,
+		S24,
+	};
+
+	// Size in bytes of one sample, of one channel, in the given format
+	size_t SampleFormatSize(const SampleFormat format);
+
+	// Saturating conversions from normalised float, vectorised where the platform allows
+	void ConvertFloatToS16(const float* pIn, int16_t* pOut, const size_t nSamples);
+	void ConvertFloatToS24(const float* pIn, int32_t* pOut, const size_t nSamples);
+
 	// DRIVER DEVELOPERS ONLY!!!
 	//
 	// This interface allows SoundWave to exchange data with OS audio systems. It 
@@ -621,23 +1156,159 @@ namespace olc::sound
 		virtual std::vector<std::string> EnumerateOutputDevices();
 		virtual std::vector<std::string> EnumerateInputDevices();
 
+		// [IMPLEMENT IF OFFLINE] Produce nBlocks of audio immediately, returns false
+		// if the driver is driven by a real time device instead
+		virtual bool Render(const uint32_t nBlocks);
+
+		// The format agreed with the device in Open()
+		SampleFormat GetSampleFormat() const;
+
+		// [IMPLEMENT IF POSSIBLE] Seconds from mixing a sample to it being played. Safe
+		// to call from any thread. Defaults to the time taken to play every block
+		virtual double GetOutputLatency() const;
+
 	protected:
+		// [CALL FROM Open()] Provide the formats the device accepts, most preferred first,
+		// and the format to use is returned. Float32 is always chosen if it is accepted, as
+		// the mixer already works in float and no conversion pass is needed at all
+		SampleFormat NegotiateFormat(const std::vector<SampleFormat>& vDeviceFormats);
+
 		// [IMPLEMENT IF REQUIRED] Called by driver to exchange data with SoundWave System. Your
-		// implementation will call this function providing a "DAC" buffer to be filled by
-		// SoundWave from a buffer of floats filled by the user.		
-		void ProcessOutputBlock(std::vector<float>& vFloatBuffer, std::vector<short>& vDACBuffer);
+		// implementation will call this function providing a "DAC" buffer, of one block in the
+		// negotiated format, to be filled by SoundWave. vFloatBuffer is scratch space used only
+		// if a conversion is needed - Float32 devices are mixed into directly.
+		void ProcessOutputBlock(std::vector<float>& vFloatBuffer, void* pDACBuffer);
 
 		// [IMPLEMENT IF REQUIRED] Called by driver to exchange data with SoundWave System.
 		void GetFullOutputBlock(std::vector<float>& vFloatBuffer);
+		void GetFullOutputBlock(float* pFloatBuffer);
+
+		// [CALL IF POSSIBLE] Tell SoundWave the device ran out of audio to play
+		void ReportUnderrun();
+
+		// [CALL FROM AUDIO THREADS] Raises the calling thread to realtime priority if the
+		// user asked for it, once per thread. Threads that mix are raised automatically
+		void PromoteAudioThread();
 
 		// Handle to SoundWave, to interrogate optons, and get user data
 		WaveEngine* m_pHost = nullptr;
+
+		// Format the device is fed with
+		SampleFormat m_nSampleFormat = SampleFormat::Float32;
+	};
+
+
+	// A ring of fixed size blocks, handed from exactly one producer thread to exactly
+	// one consumer thread without locks. Neither side ever waits on the other: a full or
+	// empty ring just returns nullptr. The two indices live on separate cache lines, and
+	// each side keeps a cached copy of the other's, so the line holding the other index
+	// is only pulled across when the ring looks full (or empty) from the cached value
+	template<typename T>
+	class RingBuffer
+	{
+	public:
+		RingBuffer()
+		{ }
+
+		// Not thread-safe, call before either side starts
+		void Resize(unsigned int bufnum = 0, unsigned int buflen = 0)
+		{
+			m_vStorage.assign(size_t(bufnum) * buflen, T(0));
+			m_nBlocks = bufnum;
+			m_nBlockLength = buflen;
+			m_nHead.store(0, std::memory_order_relaxed);
+			m_nTail.store(0, std::memory_order_relaxed);
+			m_nProducerHead = 0;
+			m_nConsumerTail = 0;
+		}
+
+		size_t BlockLength() const
+		{
+			return m_nBlockLength;
+		}
+
+		// Producer - the next free block, or nullptr if full. Fill it, then EndWrite()
+		T* BeginWrite()
+		{
+			const size_t nTail = m_nTail.load(std::memory_order_relaxed);
+			if (nTail - m_nProducerHead >= m_nBlocks)
+			{
+				m_nProducerHead = m_nHead.load(std::memory_order_acquire);
+				if (nTail - m_nProducerHead >= m_nBlocks)
+					return nullptr;
+			}
+			return m_vStorage.data() + (nTail % m_nBlocks) * m_nBlockLength;
+		}
+
+		void EndWrite()
+		{
+			m_nTail.store(m_nTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Consumer - the oldest full block, or nullptr if empty. Use it, then EndRead()
+		const T* BeginRead()
+		{
+			const size_t nHead = m_nHead.load(std::memory_order_relaxed);
+			if (nHead == m_nConsumerTail)
+			{
+				m_nConsumerTail = m_nTail.load(std::memory_order_acquire);
+				if (nHead == m_nConsumerTail)
+					return nullptr;
+			}
+			return m_vStorage.data() + (nHead % m_nBlocks) * m_nBlockLength;
+		}
+
+		void EndRead()
+		{
+			m_nHead.store(m_nHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Safe from either side, though only a snapshot
+		bool IsEmpty() const
+		{
+			return m_nHead.load(std::memory_order_acquire) == m_nTail.load(std::memory_order_acquire);
+		}
+
+		bool IsFull() const
+		{
+			return m_nTail.load(std::memory_order_acquire) - m_nHead.load(std::memory_order_acquire) >= m_nBlocks;
+		}
+
+	private:
+		static constexpr size_t nCacheLine = 64;
+
+		std::vector<T> m_vStorage;
+		size_t m_nBlocks = 1;
+		size_t m_nBlockLength = 0;
+
+		// Blocks read - written by the consumer only
+		alignas(nCacheLine) std::atomic<size_t> m_nHead{ 0 };
+		size_t m_nConsumerTail = 0;
+
+		// Blocks written - written by the producer only
+		alignas(nCacheLine) std::atomic<size_t> m_nTail{ 0 };
+		size_t m_nProducerHead = 0;
+
+		// Keep whatever follows off the producer's line
+		alignas(nCacheLine) uint8_t m_nPadding = 0;
 	};
 	}
 
 
 	namespace synth
 	{
+		// sin(2 pi t) for any t, from a polynomial - within 4e-6 of std::sin
+		float FastSine(const float t);
+		// Eight lanes of FastSine at once, vectorised where the platform allows
+		void FastSine8(const float* t, float* pOut);
+		// The correction that band-limits a unit step at t == 0, for a phase t in [0, 1)
+		// advancing dt per sample. Subtract it from naive saw, square and pulse waves
+		float PolyBLEP(const float t, const float dt);
+
+		// A port on a module. Inputs read a block of samples through operator[], which
+		// either aliases the output buffer they are patched to, or holds "value" ramped
+		// at block rate, so changing it from another thread doesn't click. Outputs write
+		// a block through write(), and "value" holds the last sample written
 		class Property
 		{
 		public:
@@ -648,7 +1319,23 @@ namespace olc::sound
 			Property(double f);
 
 		public:
-			Property& operator =(const double f);			
+			Property& operator =(const double f);
+
+		public:
+			float operator[](const size_t n) const { return m_pBlock[n]; }
+			const float* data() const { return m_pBlock; }
+			float* write() { return m_vBuffer.data(); }
+
+		private:
+			// What is read this block - m_vBuffer, or the buffer of a patched output
+			const float* m_pBlock = nullptr;
+			std::vector<float> m_vBuffer;
+			// Set when patched from a property no module in the synth owns
+			const Property* m_pControl = nullptr;
+			float m_fSmoothed = 0.0f;
+			size_t m_nSettled = 0;
+
+			friend class ModularSynth;
 		};
 
 
@@ -661,29 +1348,67 @@ namespace olc::sound
 		class Module
 		{
 		public:
-			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep) = 0;
+			virtual ~Module() = default;
+
+		public:
+			// Fill a block of nSamples on every output, from the same block on the inputs
+			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples) = 0;
+
+		protected:
+			// Ports must be declared (usually by the constructor) for ModularSynth to route
+			// patches to them and work out the order modules must run in
+			void AddInputs(std::initializer_list<Property*> ports);
+			void AddOutputs(std::initializer_list<Property*> ports);
+
+		private:
+			std::vector<Property*> m_vInputs;
+			std::vector<Property*> m_vOutputs;
+
+			friend class ModularSynth;
 		};
 
 
+		// Modules and patches form a graph, which is compiled into a fixed running order
+		// whenever it changes, so every module reads inputs produced this block. Patches
+		// then cost nothing - an input simply reads the buffer of the output it's patched
+		// to. Modules in a feedback loop can't be ordered, and hear the output of the
+		// previous Update() instead. Not thread-safe: edit the graph from the thread that
+		// calls Update(), or call Compile() before audio starts
 		class ModularSynth
 		{
 		public:
-			ModularSynth();
+			ModularSynth(const uint32_t nMaxBlockSamples = 512);
 
 		public:
 			bool AddModule(Module* pModule);
 			bool RemoveModule(Module* pModule);
+			// Connects the output pInput to the input pOutput. An input takes one patch, the
+			// most recent. Patching from a property no module owns forwards its value instead
 			bool AddPatch(Property* pInput, Property* pOutput);
 			bool RemovePatch(Property* pInput, Property* pOutput);
 
 
 		public:
-			void UpdatePatches();
-			void Update(uint32_t nChannel, double dTime, double dTimeStep);
+			// Orders the modules and resolves patches. Update() does this if it has to, but
+			// it allocates, so it's best done ahead of the audio thread
+			void Compile();
+			// Runs every module once, in order, for a block of nSamples
+			void Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples);
+
+		private:
+			void PrepareInputs(const uint32_t nSamples, const bool bNewBlock);
 
 		protected:
 			std::vector<Module*> m_vModules;
 			std::vector<std::pair<Property*, Property*>> m_vPatches;
+
+		private:
+			std::vector<Module*> m_vRunOrder;
+			// Inputs that are not patched to an output, and need ramping every block
+			std::vector<Property*> m_vSmoothed;
+			uint32_t m_nMaxBlockSamples = 512;
+			double m_dBlockTime = -1.0;
+			bool m_bCompiled = false;
 		};
 
 
@@ -703,6 +1428,9 @@ namespace olc::sound
 				Noise,
 			};
 
+		public:
+			Oscillator();
+
 		public:
 			// Primary frequency of oscillation
 			Property frequency = 0.0f;
@@ -720,7 +1448,8 @@ namespace olc::sound
 			Wave* pWave = nullptr;
 
 		private:
-			double phase_acc = 0.0f;
+			// Per channel, so a stereo synth doesn't run at twice the pitch
+			std::array<double, 8> phase_acc{};
 			double max_frequency = 20000.0;
 			uint32_t random_seed = 0xB00B1E5;
 
@@ -729,10 +1458,61 @@ namespace olc::sound
 			
 
 		public:
-			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep) override;
+			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples) override;
 
 		};
-	}
+
+
+		// Many oscillators of one waveform, summed into a single output. Oscillators are
+		// processed eight at a time, one per lane, so dense sound effects (engines, lasers,
+		// crowds of chirps) cost a fraction of what the same number of Oscillators would.
+		// The bank is mono - every channel of a block hears the same output
+		class OscillatorBank : public Module
+		{
+		public:
+			using Type = Oscillator::Type;
+			static constexpr size_t nLanes = 8;
+
+		public:
+			OscillatorBank(const size_t nOscillators = nLanes, const Type waveform = Type::Sine);
+
+		public:
+			// Scales the sum of all the oscillators
+			Property amplitude = 1.0f;
+			// Sum of all oscillators
+			Property output;
+
+			// Sine, Saw, Square, Triangle, PWM and Noise - Wave is not supported in a bank
+			Type waveform = Type::Sine;
+
+		public:
+			size_t size() const;
+			// Frequency is in Hz. Amplitude changes are ramped across the next block
+			void SetFrequency(const size_t nOscillator, const double dFrequency);
+			void SetAmplitude(const size_t nOscillator, const double dAmplitude);
+			// Pulse width for PWM, from -1.0 to 1.0, as Oscillator::parameter
+			void SetParameter(const size_t nOscillator, const double dParameter);
+
+		public:
+			virtual void Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples) override;
+
+		private:
+			struct alignas(32) Lanes
+			{
+				float phase[nLanes]{};
+				float frequency[nLanes]{};
+				float amplitude[nLanes]{};
+				float target[nLanes]{};
+				float duty[nLanes]{};
+				uint32_t seed[nLanes]{};
+			};
+
+			std::vector<Lanes> m_vLanes;
+			std::vector<float> m_vMix;
+			size_t m_nOscillators = 0;
+			double m_dBlockTime = -1.0;
+		};
+	}
 	}
 
 
@@ -765,7 +1545,7 @@ namespace olc::sound::driver
 		HWAVEOUT m_hwDevice = nullptr;
 		std::thread m_thDriverLoop;
 		std::atomic<bool> m_bDriverLoopActive{ false };
-		std::unique_ptr<std::vector<short>[]> m_pvBlockMemory;
+		std::unique_ptr<std::vector<uint8_t>[]> m_pvBlockMemory;
 		std::unique_ptr<WAVEHDR[]> m_pWaveHeaders;
 		std::atomic<unsigned int> m_nBlockFree = 0;
 		std::condition_variable m_cvBlockNotZero;
@@ -817,64 +1597,11 @@ namespace olc::sound::driver
 #if defined(SOUNDWAVE_USING_ALSA)
 #include <alsa/asoundlib.h>
 #include <poll.h>
+#include <cerrno>
 #include <iostream>
 
 namespace olc::sound::driver
 {
-	// Not thread-safe
-	template<typename T>
-	class RingBuffer
-	{
-	public:
-		RingBuffer()
-		{ }
-
-		void Resize(unsigned int bufnum = 0, unsigned int buflen = 0)
-		{
-			m_vBuffers.resize(bufnum);
-			for (auto &vBuffer : m_vBuffers)
-				vBuffer.resize(buflen);
-		}
-
-		std::vector<T>& GetFreeBuffer()
-		{
-			assert(!IsFull());
-
-			std::vector<T>& result = m_vBuffers[m_nTail];
-			m_nTail = Next(m_nTail);
-			return result;
-		}
-
-		std::vector<T>& GetFullBuffer()
-		{
-			assert(!IsEmpty());
-
-			std::vector<T>& result = m_vBuffers[m_nHead];
-			m_nHead = Next(m_nHead);
-			return result;
-		}
-
-		bool IsEmpty()
-		{
-			return m_nHead == m_nTail;
-		}
-
-		bool IsFull()
-		{
-			return m_nHead == Next(m_nTail);
-		}
-
-	private:
-		unsigned int Next(unsigned int current)
-		{
-			return (current + 1) % m_vBuffers.size();
-		}
-
-		std::vector<std::vector<T>> m_vBuffers;
-		unsigned int m_nHead = 0;
-		unsigned int m_nTail = 0;
-	};
-
 	class ALSA : public Base
 	{
 	public:
@@ -888,21 +1615,33 @@ namespace olc::sound::driver
 		void Close()	override;
 
 	private:
+		// Mixes ahead into m_rBuffers, so a slow block doesn't cost the device a deadline
+		void MixerLoop();
+		// Only copies from m_rBuffers to the device
 		void DriverLoop();
 
 		snd_pcm_t *m_pPCM;
-		RingBuffer<float> m_rBuffers;
+		RingBuffer<uint8_t> m_rBuffers;
 		std::atomic<bool> m_bDriverLoopActive{ false };
 		std::thread m_thDriverLoop;
+		std::thread m_thMixerLoop;
+
+		// Only for sleeping when there is nothing to do - the ring itself is lock-free
+		std::mutex m_muxWake;
+		std::condition_variable m_cvMixer;
+		std::condition_variable m_cvDriver;
 	};
 }
 #endif // SOUNDWAVE_USING_ALSA
 
 #if defined(SOUNDWAVE_USING_PULSE)
-#include <pulse/simple.h>
+#include <pulse/pulseaudio.h>
 
 namespace olc::sound::driver
 {
+	// Uses the asynchronous API, so the server is asked for a buffer of nBlocks blocks,
+	// rather than choosing one itself (often 100ms+), and it asks for audio a block at a
+	// time. Mixing happens in the stream's write callback, on PulseAudio's thread
 	class PulseAudio : public Base
 	{
 	public:
@@ -914,22 +1653,265 @@ namespace olc::sound::driver
 		bool Start() 	override;
 		void Stop()		override;
 		void Close()	override;
+		double GetOutputLatency() const override;
 
 	private:
-		void DriverLoop();
-
-		pa_simple *m_pPA;
-		std::atomic<bool> m_bDriverLoopActive{ false };
-		std::thread m_thDriverLoop;
+		static void ContextStateCallback(pa_context* pContext, void* pUser);
+		static void StreamStateCallback(pa_stream* pStream, void* pUser);
+		static void StreamWriteCallback(pa_stream* pStream, size_t nBytes, void* pUser);
+		static void StreamUnderflowCallback(pa_stream* pStream, void* pUser);
+		// Runs an operation to completion, called with the main loop locked
+		void Wait(pa_operation* pOperation);
+
+		pa_threaded_mainloop* m_pMainLoop = nullptr;
+		pa_context* m_pContext = nullptr;
+		pa_stream* m_pStream = nullptr;
+
+		std::vector<float> m_vFloatBuffer;
+		std::vector<uint8_t> m_vDeviceBuffer;
+		std::atomic<uint64_t> m_nLatencyMicroseconds{ 0 };
+		std::atomic<bool> m_bLatencyKnown{ false };
 	};
 }
 #endif // SOUNDWAVE_USING_PULSE
 
+#if defined(SOUNDWAVE_USING_OFFLINE)
+namespace olc::sound::driver
+{
+	// Renders to a .wav file rather than a device, as fast as the mixer can go, when
+	// asked to by WaveEngine::RenderOffline(). The output device name is the file to
+	// write. For benchmarking, headless testing, and pre-rendering audio
+	class Offline : public Base
+	{
+	public:
+		Offline(WaveEngine* pHost);
+		~Offline();
+
+	protected:
+		bool Open(const std::string& sOutputDevice, const std::string& sInputDevice) 	override;
+		bool Start() 	override;
+		void Stop()		override;
+		void Close()	override;
+		bool Render(const uint32_t nBlocks) override;
+
+	private:
+		std::ofstream m_ofsOutput;
+		std::vector<float> m_vFloatBuffer;
+		std::vector<uint8_t> m_vDeviceBuffer;
+		size_t m_nSamplesWritten = 0;
+		bool m_bRunning = false;
+	};
+}
+#endif // SOUNDWAVE_USING_OFFLINE
+
 #ifdef OLC_SOUNDWAVE
 #undef OLC_SOUNDWAVE
 
+// Thread priority and memory locking
+#if defined(_WIN32)
+	#if !defined(NOMINMAX)
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+	#define SOUNDWAVE_PLATFORM_POSIX
+	#include <pthread.h>
+	#include <sched.h>
+	#include <sys/mman.h>
+	#include <sys/resource.h>
+	#include <unistd.h>
+	#if defined(__linux__)
+		#include <sys/syscall.h>
+	#endif
+#endif
+
+#if defined(SOUNDWAVE_DEBUG_ALLOCATIONS)
+// Debug builds can catch the heap being used while mixing - it takes locks, and can
+// page fault, so any use is a potential glitch. The global operators are replaced,
+// so define this in one program at most, and never in a release build
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace olc::sound::debug
+{
+	thread_local bool bInMixer = false;
+	thread_local bool bReporting = false;
+	std::atomic<uint64_t> nMixerAllocations{ 0 };
+
+	// Says so the first time, after that AudioStats::nMixerAllocations keeps count
+	static void ReportAllocation(const char* sWhat)
+	{
+		if (nMixerAllocations.fetch_add(1, std::memory_order_relaxed) == 0 && !bReporting)
+		{
+			// stdio, not iostreams, which could allocate and land back here
+			bReporting = true;
+			std::fprintf(stderr, "olcSoundWaveEngine: heap %s while mixing - see AudioStats::nMixerAllocations\n", sWhat);
+			bReporting = false;
+		}
+	}
+}
+
+void* operator new(std::size_t nBytes)
+{
+	if (olc::sound::debug::bInMixer) olc::sound::debug::ReportAllocation("allocation");
+	void* p = std::malloc(nBytes > 0 ? nBytes : 1);
+	if (p == nullptr) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t nBytes)
+{
+	return operator new(nBytes);
+}
+
+void operator delete(void* p) noexcept
+{
+	if (p != nullptr && olc::sound::debug::bInMixer) olc::sound::debug::ReportAllocation("free");
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	operator delete(p);
+}
+#endif
+
 namespace olc::sound
 {	
+	AudioArena::AudioArena(const size_t nSlots) : m_nSlots(nSlots)
+	{
+		m_pMemory = std::make_unique<uint8_t[]>(nSlots * nSlotSize);
+		for (size_t i = nSlots; i > 0; i--)
+		{
+			Slot* pSlot = reinterpret_cast<Slot*>(m_pMemory.get() + (i - 1) * nSlotSize);
+			pSlot->pNext = m_pFree.load(std::memory_order_relaxed);
+			m_pFree.store(pSlot, std::memory_order_relaxed);
+		}
+	}
+
+	void* AudioArena::Allocate(const size_t nBytes)
+	{
+		if (nBytes <= nSlotSize)
+		{
+			Slot* pSlot = m_pFree.load(std::memory_order_acquire);
+			while (pSlot != nullptr && !m_pFree.compare_exchange_weak(pSlot, pSlot->pNext, std::memory_order_acquire))
+			{ }
+
+			if (pSlot != nullptr)
+			{
+				m_nInUse.fetch_add(1, std::memory_order_relaxed);
+				return pSlot;
+			}
+		}
+
+		return ::operator new(nBytes);
+	}
+
+	void AudioArena::Deallocate(void* p, const size_t nBytes)
+	{
+		uint8_t* pByte = static_cast<uint8_t*>(p);
+		if (pByte >= m_pMemory.get() && pByte < m_pMemory.get() + m_nSlots * nSlotSize)
+		{
+			Slot* pSlot = static_cast<Slot*>(p);
+			pSlot->pNext = m_pFree.load(std::memory_order_relaxed);
+			while (!m_pFree.compare_exchange_weak(pSlot->pNext, pSlot, std::memory_order_release))
+			{ }
+			m_nInUse.fetch_sub(1, std::memory_order_relaxed);
+		}
+		else
+			::operator delete(p, nBytes);
+	}
+
+	size_t AudioArena::InUse() const
+	{
+		return m_nInUse.load(std::memory_order_relaxed);
+	}
+
+	const void* AudioArena::data() const
+	{
+		return m_pMemory.get();
+	}
+
+	size_t AudioArena::size() const
+	{
+		return m_nSlots * nSlotSize;
+	}
+
+	namespace platform
+	{
+		// Realtime scheduling for the calling thread, or the best available instead
+		static bool PromoteThread()
+		{
+#if defined(_WIN32)
+			return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#elif defined(SOUNDWAVE_PLATFORM_POSIX)
+			sched_param param{};
+			param.sched_priority = std::min(sched_get_priority_min(SCHED_FIFO) + 70, sched_get_priority_max(SCHED_FIFO));
+			if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0)
+				return true;
+
+			// Not permitted (no CAP_SYS_NICE / rtprio limit), so settle for a lower nice value
+			static std::atomic<bool> bWarned{ false };
+			if (!bWarned.exchange(true))
+				std::cerr << "olcSoundWaveEngine: realtime scheduling not permitted, raising priority instead\n";
+	#if defined(__linux__)
+			setpriority(PRIO_PROCESS, pid_t(syscall(SYS_gettid)), -10);
+	#endif
+			return false;
+#else
+			return false;
+#endif
+		}
+
+		static bool LockMemory(const void* p, const size_t nBytes)
+		{
+#if defined(SOUNDWAVE_PLATFORM_POSIX)
+			return nBytes == 0 || mlock(p, nBytes) == 0;
+#else
+			return false;
+#endif
+		}
+
+		// The calling thread's stack, nBytes down from the caller's frame - as much as a
+		// mixing thread can be expected to use. Threads started after LockAllMemory() need it
+		static bool LockStack(const size_t nBytes)
+		{
+#if defined(SOUNDWAVE_PLATFORM_POSIX)
+			const uintptr_t nPage = uintptr_t(sysconf(_SC_PAGESIZE));
+			volatile char cHere = 0;
+			const uintptr_t nTop = (uintptr_t(&cHere) + nPage) & ~(nPage - 1);
+			return mlock(reinterpret_cast<const void*>(nTop - nBytes), nBytes) == 0;
+#else
+			(void)nBytes;
+			return false;
+#endif
+		}
+
+		// Everything currently mapped - code, heap, thread stacks, the driver's buffers and
+		// memory mapped waves. Not MCL_FUTURE, which makes ordinary allocations fail once
+		// over RLIMIT_MEMLOCK
+		static bool LockAllMemory()
+		{
+#if defined(SOUNDWAVE_PLATFORM_POSIX)
+			if (mlockall(MCL_CURRENT) == 0)
+				return true;
+			std::cerr << "olcSoundWaveEngine: could not lock memory (RLIMIT_MEMLOCK?)\n";
+#endif
+			return false;
+		}
+	}
+
 	WaveEngine::WaveEngine()
 	{
 		m_sInputDevice = "NONE";
@@ -962,6 +1944,10 @@ namespace olc::sound
 #if defined(SOUNDWAVE_USING_PULSE)
 		m_driver = std::make_unique<driver::PulseAudio>(this);
 #endif
+
+#if defined(SOUNDWAVE_USING_OFFLINE)
+		m_driver = std::make_unique<driver::Offline>(this);
+#endif
 	}
 
 	WaveEngine::~WaveEngine()
@@ -998,8 +1984,12 @@ namespace olc::sound
 		m_nBlockSamples = nBlockSamples;
 		m_dSamplePerTime = double(nSampleRate);
 		m_dTimePerSample = 1.0 / double(nSampleRate);
+		m_vSynthBlock.resize(size_t(nBlockSamples) * nChannels);
 		m_driver->Open(m_sOutputDevice, m_sInputDevice);
 		m_driver->Start();
+		// Only now do the driver's rings, scratch buffers and thread stacks exist to be locked
+		if (m_bRealtimeRequested)
+			platform::LockAllMemory();
 		return false;
 	}
 
@@ -1027,18 +2017,48 @@ namespace olc::sound
 		m_funcUserFilter = func;
 	}
 
+	void WaveEngine::SetCallBack_SynthBlockFunction(std::function<void(uint32_t, double, uint32_t, float*)> func)
+	{
+		m_funcUserSynthBlock = func;
+	}
+
 	PlayingWave WaveEngine::PlayWaveform(Wave* pWave, bool bLoop, double dSpeed)
 	{
+		// Play a copy at the device rate rather than resampling on every sample, of every
+		// voice, forever. Waves given to PrepareWaveform(), or resampled by their loader,
+		// have the copy already; anything else is converted here, once, when first played
+		pWave = pWave->Resampled(m_nSampleRate);
+
 		WaveInstance wi;
 		wi.bLoop = bLoop;
 		wi.pWave = pWave;
 		wi.dSpeedModifier = dSpeed * double(pWave->file.samplerate()) / m_dSamplePerTime;
+		wi.bNativeRate = wi.dSpeedModifier == 1.0;
 		wi.dDuration = pWave->file.duration() / dSpeed;
 		wi.dInstanceTime = m_dGlobalTime;
+		pWave->m_voices.n.fetch_add(1, std::memory_order_relaxed);
 		m_listWaves.push_back(wi);
 		return std::prev(m_listWaves.end());
 	}
 
+	bool WaveEngine::RenderOffline(const double dSeconds)
+	{
+		const double dBlocks = std::ceil(dSeconds * m_dSamplePerTime / double(m_nBlockSamples));
+		return m_driver->Render(uint32_t(std::max(dBlocks, 0.0)));
+	}
+
+	void WaveEngine::PrepareWaveform(Wave* pWave)
+	{
+		Wave* pPlayed = pWave->Resampled(m_nSampleRate);
+		if (m_bRealtimeRequested && pPlayed->file.data() != nullptr)
+			platform::LockMemory(pPlayed->file.data(), pPlayed->file.samples() * pPlayed->file.channels() * sizeof(float));
+	}
+
+	void WaveEngine::UseRealtimeAudio(const bool bRealtime)
+	{
+		m_bRealtimeRequested = bRealtime;
+	}
+
 	void WaveEngine::StopWaveform(const PlayingWave& w)
 	{
 		w->bFlagForStop = true;
@@ -1057,8 +2077,23 @@ namespace olc::sound
 		m_fOutputVolume = std::clamp(fVolume, 0.0f, 1.0f);
 	}
 
-	uint32_t WaveEngine::FillOutputBuffer(std::vector<float>& vBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples)
+	uint32_t WaveEngine::FillOutputBuffer(float* pBuffer, const uint32_t nBufferOffset, const uint32_t nRequiredSamples)
 	{
+		const uint32_t nVoices = uint32_t(m_listWaves.size());
+		if (nVoices > m_stats.nPeakVoices.load(std::memory_order_relaxed))
+			m_stats.nPeakVoices.store(nVoices, std::memory_order_relaxed);
+
+		// Block synthesis happens up front, one channel at a time
+		if (m_funcUserSynthBlock)
+		{
+			if (m_vSynthBlock.size() < size_t(nRequiredSamples) * m_nChannels)
+				m_vSynthBlock.resize(size_t(nRequiredSamples) * m_nChannels);
+
+			std::fill_n(m_vSynthBlock.begin(), size_t(nRequiredSamples) * m_nChannels, 0.0f);
+			for (uint32_t nChannel = 0; nChannel < m_nChannels; nChannel++)
+				m_funcUserSynthBlock(nChannel, m_dGlobalTime, nRequiredSamples, m_vSynthBlock.data() + size_t(nChannel) * nRequiredSamples);
+		}
+
 		for (uint32_t nSample = 0; nSample < nRequiredSamples; nSample++)
 		{
 			double dSampleTime = m_dGlobalTime + nSample * m_dTimePerSample;
@@ -1101,19 +2136,32 @@ namespace olc::sound
 						else
 						{
 							// OR, sample the waveform from the correct channel
-							fSample += float(wave.pWave->vChannelView[nChannel % wave.pWave->file.channels()].GetSample(dTimeOffset * m_dSamplePerTime * wave.dSpeedModifier));
+							const auto& view = wave.pWave->vChannelView[nChannel % wave.pWave->file.channels()];
+							if (wave.bNativeRate)
+								fSample += float(view.GetValue(size_t(std::llround(dTimeOffset * m_dSamplePerTime))));
+							else
+								fSample += float(view.GetSample(dTimeOffset * m_dSamplePerTime * wave.dSpeedModifier));
 						}
 					}
 				}
 
 				// Remove waveform instances that have finished
-				m_listWaves.remove_if([](const WaveInstance& wi) {return wi.bFinished; });
+				m_listWaves.remove_if([](const WaveInstance& wi)
+				{
+					if (!wi.bFinished) return false;
+					// Released, so whoever sees the wave idle also sees the mixer done with it
+					wi.pWave->m_voices.n.fetch_sub(1, std::memory_order_release);
+					return true;
+				});
 
 
 				// 2) If user is synthesizing, request sample
 				if (m_funcUserSynth)
 					fSample += m_funcUserSynth(nChannel, dSampleTime);
 
+				if (m_funcUserSynthBlock)
+					fSample += m_vSynthBlock[size_t(nChannel) * nRequiredSamples + nSample];
+
 				// 3) Apply global filters
 
 
@@ -1122,7 +2170,7 @@ namespace olc::sound
 					fSample = m_funcUserFilter(nChannel, dSampleTime, fSample);
 
 				// Place sample in buffer
-				vBuffer[nBufferOffset + nSample * m_nChannels + nChannel] = fSample * m_fOutputVolume;
+				pBuffer[nBufferOffset + nSample * m_nChannels + nChannel] = fSample * m_fOutputVolume;
 			}
 		}
 
@@ -1157,6 +2205,82 @@ namespace olc::sound
 		return m_dTimePerSample;
 	}
 
+	AudioStats WaveEngine::GetAudioStats() const
+	{
+		AudioStats stats;
+		stats.nBlocks = m_stats.nBlocks;
+		stats.nDeadlineMisses = m_stats.nDeadlineMisses;
+		stats.nUnderruns = m_stats.nUnderruns;
+		stats.nPeakVoices = m_stats.nPeakVoices;
+		stats.dBlockPeriod = double(m_nBlockSamples) / double(m_nSampleRate);
+		stats.dWorstCallback = double(m_stats.nWorstNanoseconds) * 1e-9;
+		stats.dMeanCallback = stats.nBlocks > 0 ? double(m_stats.nTotalNanoseconds) * 1e-9 / double(stats.nBlocks) : 0.0;
+		stats.dOutputLatency = GetOutputLatency();
+		stats.bRealtime = m_bRealtimeActive;
+#if defined(SOUNDWAVE_DEBUG_ALLOCATIONS)
+		stats.nMixerAllocations = debug::nMixerAllocations;
+#endif
+		for (size_t i = 0; i < AudioStats::nHistogramBuckets; i++)
+			stats.vHistogram[i] = m_stats.vHistogram[i];
+		return stats;
+	}
+
+	double WaveEngine::GetOutputLatency() const
+	{
+		return m_driver ? m_driver->GetOutputLatency() : 0.0;
+	}
+
+	void WaveEngine::ResetAudioStats()
+	{
+		m_stats.nBlocks = 0;
+		m_stats.nDeadlineMisses = 0;
+		m_stats.nUnderruns = 0;
+		m_stats.nTotalNanoseconds = 0;
+		m_stats.nWorstNanoseconds = 0;
+		m_stats.nPeakVoices = 0;
+		for (auto& n : m_stats.vHistogram) n = 0;
+	}
+
+	void WaveEngine::RecordBlockTiming(const std::chrono::nanoseconds& tCallback)
+	{
+		// Only the audio thread writes, so there is no need for compare-and-swap here
+		const uint64_t nNanoseconds = uint64_t(tCallback.count());
+		const double dPeriod = double(m_nBlockSamples) / double(m_nSampleRate);
+		const double dLoad = double(nNanoseconds) * 1e-9 / dPeriod;
+
+		m_stats.nBlocks.fetch_add(1, std::memory_order_relaxed);
+		m_stats.nTotalNanoseconds.fetch_add(nNanoseconds, std::memory_order_relaxed);
+		if (nNanoseconds > m_stats.nWorstNanoseconds.load(std::memory_order_relaxed))
+			m_stats.nWorstNanoseconds.store(nNanoseconds, std::memory_order_relaxed);
+		if (dLoad >= 1.0)
+			m_stats.nDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+
+		size_t nBucket = std::min(size_t(dLoad * 10.0), AudioStats::nHistogramBuckets - 1);
+		m_stats.vHistogram[nBucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void WaveEngine::RecordUnderrun()
+	{
+		m_stats.nUnderruns.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	double AudioStats::Percentile(const float fPercentile) const
+	{
+		uint64_t nTotal = 0;
+		for (auto n : vHistogram) nTotal += n;
+		if (nTotal == 0) return 0.0;
+
+		const double dTarget = double(fPercentile) * double(nTotal);
+		uint64_t nCount = 0;
+		for (size_t i = 0; i < nHistogramBuckets; i++)
+		{
+			nCount += vHistogram[i];
+			if (double(nCount) >= dTarget)
+				return double(i + 1) * 0.1;
+		}
+		return double(nHistogramBuckets) * 0.1;
+	}
+
 	namespace driver
 	{
 	Base::Base(olc::sound::WaveEngine* pHost) : m_pHost(pHost)
@@ -1193,51 +2317,309 @@ namespace olc::sound
 		return { "NONE" };
 	}
 
-	void Base::ProcessOutputBlock(std::vector<float>& vFloatBuffer, std::vector<short>& vDACBuffer)
+	bool Base::Render(const uint32_t nBlocks)
 	{
-		constexpr float fMaxSample = float(std::numeric_limits<short>::max());
-		constexpr float fMinSample = float(std::numeric_limits<short>::min());
+		(void)nBlocks;
+		return false;
+	}
 
-		// So... why not use vFloatBuffer.size()? Well with this implementation
-		// we can, but i suspect there may be some platforms that request a
-		// specific number of samples per "loop" rather than this block architecture
-		uint32_t nSamplesToProcess = m_pHost->GetBlockSampleCount();
-		uint32_t nSampleOffset = 0;
-		while (nSamplesToProcess > 0)
+	double Base::GetOutputLatency() const
+	{
+		return double(m_pHost->GetBlocks()) * double(m_pHost->GetBlockSampleCount()) / double(m_pHost->GetSampleRate());
+	}
+
+	SampleFormat Base::GetSampleFormat() const
+	{
+		return m_nSampleFormat;
+	}
+
+	SampleFormat Base::NegotiateFormat(const std::vector<SampleFormat>& vDeviceFormats)
+	{
+		if (std::find(vDeviceFormats.begin(), vDeviceFormats.end(), SampleFormat::Float32) != vDeviceFormats.end())
+			m_nSampleFormat = SampleFormat::Float32;
+		else if (!vDeviceFormats.empty())
+			m_nSampleFormat = vDeviceFormats.front();
+		else
+			m_nSampleFormat = SampleFormat::S16; // Everything does 16-bit, surely?
+
+		return m_nSampleFormat;
+	}
+
+	void Base::ProcessOutputBlock(std::vector<float>& vFloatBuffer, void* pDACBuffer)
+	{
+		// The mixer works in float32 anyway, so let it write straight to the device
+		if (m_nSampleFormat == SampleFormat::Float32)
 		{
-			uint32_t nSamplesGathered = m_pHost->FillOutputBuffer(vFloatBuffer, nSampleOffset, nSamplesToProcess);
+			GetFullOutputBlock(static_cast<float*>(pDACBuffer));
+			return;
+		}
 
-			// Vector is in float32 format, so convert to hardware required format
-			for (uint32_t n = 0; n < nSamplesGathered; n++)
-			{
-				for (uint32_t c = 0; c < m_pHost->GetChannels(); c++)
-				{
-					size_t nSampleID = nSampleOffset + (n * m_pHost->GetChannels() + c);
-					vDACBuffer[nSampleID] = short(std::clamp(vFloatBuffer[nSampleID] * fMaxSample, fMinSample, fMaxSample));
-				}
-			}
+		// Threads that allocate their own scratch may do so after InitialiseAudio() locked memory
+		thread_local const float* pLockedScratch = nullptr;
+		if (m_pHost->m_bRealtimeRequested && pLockedScratch != vFloatBuffer.data())
+		{
+			pLockedScratch = vFloatBuffer.data();
+			platform::LockMemory(vFloatBuffer.data(), vFloatBuffer.size() * sizeof(float));
+		}
 
-			nSampleOffset += nSamplesGathered;
-			nSamplesToProcess -= nSamplesGathered;
+		GetFullOutputBlock(vFloatBuffer.data());
+
+		// Buffer is in float32 format, so convert to hardware required format
+		const size_t nValues = size_t(m_pHost->GetBlockSampleCount()) * m_pHost->GetChannels();
+		switch (m_nSampleFormat)
+		{
+		case SampleFormat::S16:
+			ConvertFloatToS16(vFloatBuffer.data(), static_cast<int16_t*>(pDACBuffer), nValues);
+			break;
+		case SampleFormat::S24:
+			ConvertFloatToS24(vFloatBuffer.data(), static_cast<int32_t*>(pDACBuffer), nValues);
+			break;
+		default:
+			break;
 		}
 	}
 
 	void Base::GetFullOutputBlock(std::vector<float>& vFloatBuffer)
 	{
+		GetFullOutputBlock(vFloatBuffer.data());
+	}
+
+	void Base::GetFullOutputBlock(float* pFloatBuffer)
+	{
+		// So... why not just ask for the whole block? Well with this implementation
+		// we can, but i suspect there may be some platforms that request a
+		// specific number of samples per "loop" rather than this block architecture
+		PromoteAudioThread();
+		auto tStart = std::chrono::steady_clock::now();
+
+#if defined(SOUNDWAVE_DEBUG_ALLOCATIONS)
+		debug::bInMixer = true;
+#endif
+
 		uint32_t nSamplesToProcess = m_pHost->GetBlockSampleCount();
 		uint32_t nSampleOffset = 0;
 		while (nSamplesToProcess > 0)
 		{
-			uint32_t nSamplesGathered = m_pHost->FillOutputBuffer(vFloatBuffer, nSampleOffset, nSamplesToProcess);
+			uint32_t nSamplesGathered = m_pHost->FillOutputBuffer(pFloatBuffer, nSampleOffset * m_pHost->GetChannels(), nSamplesToProcess);
 
 			nSampleOffset += nSamplesGathered;
 			nSamplesToProcess -= nSamplesGathered;
 		}
+
+#if defined(SOUNDWAVE_DEBUG_ALLOCATIONS)
+		debug::bInMixer = false;
+#endif
+
+		m_pHost->RecordBlockTiming(std::chrono::steady_clock::now() - tStart);
+	}
+
+	void Base::PromoteAudioThread()
+	{
+		// Once per thread - drivers like PulseAudio and SDL own the thread we mix on
+		thread_local bool bPromoted = false;
+		if (bPromoted || !m_pHost->m_bRealtimeRequested)
+			return;
+
+		bPromoted = true;
+		if (platform::PromoteThread())
+			m_pHost->m_bRealtimeActive = true;
+
+		// Drivers may start their threads, or only grow their stacks, after InitialiseAudio()
+		// locked memory, so each audio thread locks the stack it is about to mix on
+		platform::LockStack(size_t(64) << 10);
+	}
+
+	void Base::ReportUnderrun()
+	{
+		m_pHost->RecordUnderrun();
+	}
+
+	size_t SampleFormatSize(const SampleFormat format)
+	{
+		switch (format)
+		{
+		case SampleFormat::S16: return sizeof(int16_t);
+		case SampleFormat::S24: return sizeof(int32_t);
+		default:                return sizeof(float);
+		}
+	}
+
+	void ConvertFloatToS16(const float* pIn, int16_t* pOut, const size_t nSamples)
+	{
+		constexpr float fScale = float(std::numeric_limits<int16_t>::max());
+		size_t n = 0;
+
+#if defined(SOUNDWAVE_SIMD_SSE2)
+		// Clamp first - out of range floats convert to INT_MIN, which would then "saturate" to
+		// full negative. The pack then does the narrowing, eight samples at a time
+		const __m128 mMax = _mm_set1_ps(1.0f), mMin = _mm_set1_ps(-1.0f), mScale = _mm_set1_ps(fScale);
+		for (; n + 8 <= nSamples; n += 8)
+		{
+			__m128 a = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(pIn + n), mMax), mMin), mScale);
+			__m128 b = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(pIn + n + 4), mMax), mMin), mScale);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + n), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+		}
+#elif defined(SOUNDWAVE_SIMD_NEON)
+		// NEON float->int conversion and narrowing both saturate, so no clamp is needed
+		const float32x4_t mScale = vdupq_n_f32(fScale);
+		for (; n + 8 <= nSamples; n += 8)
+		{
+			int32x4_t a = vcvtq_s32_f32(vmulq_f32(vld1q_f32(pIn + n), mScale));
+			int32x4_t b = vcvtq_s32_f32(vmulq_f32(vld1q_f32(pIn + n + 4), mScale));
+			vst1q_s16(pOut + n, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+		}
+#endif
+
+		for (; n < nSamples; n++)
+			pOut[n] = int16_t(std::lrint(std::clamp(pIn[n], -1.0f, 1.0f) * fScale));
+	}
+
+	void ConvertFloatToS24(const float* pIn, int32_t* pOut, const size_t nSamples)
+	{
+		constexpr float fScale = 8388607.0f; // 2^23 - 1
+		size_t n = 0;
+
+#if defined(SOUNDWAVE_SIMD_SSE2)
+		const __m128 mMax = _mm_set1_ps(1.0f), mMin = _mm_set1_ps(-1.0f), mScale = _mm_set1_ps(fScale);
+		for (; n + 4 <= nSamples; n += 4)
+		{
+			__m128 a = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(pIn + n), mMax), mMin), mScale);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + n), _mm_cvtps_epi32(a));
+		}
+#elif defined(SOUNDWAVE_SIMD_NEON)
+		const float32x4_t mMax = vdupq_n_f32(1.0f), mMin = vdupq_n_f32(-1.0f), mScale = vdupq_n_f32(fScale);
+		for (; n + 4 <= nSamples; n += 4)
+			vst1q_s32(pOut + n, vcvtq_s32_f32(vmulq_f32(vmaxq_f32(vminq_f32(vld1q_f32(pIn + n), mMax), mMin), mScale)));
+#endif
+
+		for (; n < nSamples; n++)
+			pOut[n] = int32_t(std::lrint(std::clamp(pIn[n], -1.0f, 1.0f) * fScale));
 	}
 	}	
 
 	namespace synth
 	{
+	// Odd polynomial for sin(2 pi x), x in [-0.25, 0.25] - the Taylor series to x^9
+	constexpr float fSineC1 = 6.28318531f, fSineC3 = -41.3417022f, fSineC5 = 81.6052492f, fSineC7 = -76.7058597f, fSineC9 = 42.0587743f;
+
+	float FastSine(const float t)
+	{
+		// Wrap to [-0.5, 0.5), then fold onto the quarter wave either side of zero
+		float x = t - std::floor(t + 0.5f);
+		x = std::max(std::min(x, 0.5f - x), -0.5f - x);
+		const float x2 = x * x;
+		return x * (fSineC1 + x2 * (fSineC3 + x2 * (fSineC5 + x2 * (fSineC7 + x2 * fSineC9))));
+	}
+
+	// Eight floats operated on together, in two SSE2 or NEON registers where available
+	struct Vec8
+	{
+#if defined(SOUNDWAVE_SIMD_SSE2)
+		__m128 a, b;
+		static Vec8 Load(const float* p) { return { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; }
+		static Vec8 Set(const float f) { return { _mm_set1_ps(f), _mm_set1_ps(f) }; }
+		void Store(float* p) const { _mm_storeu_ps(p, a); _mm_storeu_ps(p + 4, b); }
+		friend Vec8 operator +(const Vec8& x, const Vec8& y) { return { _mm_add_ps(x.a, y.a), _mm_add_ps(x.b, y.b) }; }
+		friend Vec8 operator -(const Vec8& x, const Vec8& y) { return { _mm_sub_ps(x.a, y.a), _mm_sub_ps(x.b, y.b) }; }
+		friend Vec8 operator *(const Vec8& x, const Vec8& y) { return { _mm_mul_ps(x.a, y.a), _mm_mul_ps(x.b, y.b) }; }
+		friend Vec8 Min(const Vec8& x, const Vec8& y) { return { _mm_min_ps(x.a, y.a), _mm_min_ps(x.b, y.b) }; }
+		friend Vec8 Max(const Vec8& x, const Vec8& y) { return { _mm_max_ps(x.a, y.a), _mm_max_ps(x.b, y.b) }; }
+		friend Vec8 Abs(const Vec8& x) { const __m128 m = _mm_set1_ps(-0.0f); return { _mm_andnot_ps(m, x.a), _mm_andnot_ps(m, x.b) }; }
+		// Lanes where x < y take t, the rest take f
+		friend Vec8 SelectLess(const Vec8& x, const Vec8& y, const Vec8& t, const Vec8& f)
+		{
+			const __m128 ma = _mm_cmplt_ps(x.a, y.a), mb = _mm_cmplt_ps(x.b, y.b);
+			return { _mm_or_ps(_mm_and_ps(ma, t.a), _mm_andnot_ps(ma, f.a)), _mm_or_ps(_mm_and_ps(mb, t.b), _mm_andnot_ps(mb, f.b)) };
+		}
+		// Truncation, corrected for negative values
+		friend Vec8 Floor(const Vec8& x)
+		{
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 ta = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.a)), tb = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.b));
+			return { _mm_sub_ps(ta, _mm_and_ps(_mm_cmpgt_ps(ta, x.a), one)), _mm_sub_ps(tb, _mm_and_ps(_mm_cmpgt_ps(tb, x.b), one)) };
+		}
+#elif defined(SOUNDWAVE_SIMD_NEON)
+		float32x4_t a, b;
+		static Vec8 Load(const float* p) { return { vld1q_f32(p), vld1q_f32(p + 4) }; }
+		static Vec8 Set(const float f) { return { vdupq_n_f32(f), vdupq_n_f32(f) }; }
+		void Store(float* p) const { vst1q_f32(p, a); vst1q_f32(p + 4, b); }
+		friend Vec8 operator +(const Vec8& x, const Vec8& y) { return { vaddq_f32(x.a, y.a), vaddq_f32(x.b, y.b) }; }
+		friend Vec8 operator -(const Vec8& x, const Vec8& y) { return { vsubq_f32(x.a, y.a), vsubq_f32(x.b, y.b) }; }
+		friend Vec8 operator *(const Vec8& x, const Vec8& y) { return { vmulq_f32(x.a, y.a), vmulq_f32(x.b, y.b) }; }
+		friend Vec8 Min(const Vec8& x, const Vec8& y) { return { vminq_f32(x.a, y.a), vminq_f32(x.b, y.b) }; }
+		friend Vec8 Max(const Vec8& x, const Vec8& y) { return { vmaxq_f32(x.a, y.a), vmaxq_f32(x.b, y.b) }; }
+		friend Vec8 Abs(const Vec8& x) { return { vabsq_f32(x.a), vabsq_f32(x.b) }; }
+		friend Vec8 SelectLess(const Vec8& x, const Vec8& y, const Vec8& t, const Vec8& f)
+		{
+			return { vbslq_f32(vcltq_f32(x.a, y.a), t.a, f.a), vbslq_f32(vcltq_f32(x.b, y.b), t.b, f.b) };
+		}
+		friend Vec8 Floor(const Vec8& x)
+		{
+			const float32x4_t one = vdupq_n_f32(1.0f);
+			const float32x4_t ta = vcvtq_f32_s32(vcvtq_s32_f32(x.a)), tb = vcvtq_f32_s32(vcvtq_s32_f32(x.b));
+			return { vsubq_f32(ta, vbslq_f32(vcgtq_f32(ta, x.a), one, vdupq_n_f32(0.0f))), vsubq_f32(tb, vbslq_f32(vcgtq_f32(tb, x.b), one, vdupq_n_f32(0.0f))) };
+		}
+#else
+		float v[8];
+		template<class F> static Vec8 Map(F&& f) { Vec8 r; for (size_t n = 0; n < 8; n++) r.v[n] = f(n); return r; }
+		static Vec8 Load(const float* p) { return Map([&](size_t n) { return p[n]; }); }
+		static Vec8 Set(const float f) { return Map([&](size_t) { return f; }); }
+		void Store(float* p) const { std::copy_n(v, 8, p); }
+		friend Vec8 operator +(const Vec8& x, const Vec8& y) { return Map([&](size_t n) { return x.v[n] + y.v[n]; }); }
+		friend Vec8 operator -(const Vec8& x, const Vec8& y) { return Map([&](size_t n) { return x.v[n] - y.v[n]; }); }
+		friend Vec8 operator *(const Vec8& x, const Vec8& y) { return Map([&](size_t n) { return x.v[n] * y.v[n]; }); }
+		friend Vec8 Min(const Vec8& x, const Vec8& y) { return Map([&](size_t n) { return std::min(x.v[n], y.v[n]); }); }
+		friend Vec8 Max(const Vec8& x, const Vec8& y) { return Map([&](size_t n) { return std::max(x.v[n], y.v[n]); }); }
+		friend Vec8 Abs(const Vec8& x) { return Map([&](size_t n) { return std::abs(x.v[n]); }); }
+		friend Vec8 SelectLess(const Vec8& x, const Vec8& y, const Vec8& t, const Vec8& f) { return Map([&](size_t n) { return x.v[n] < y.v[n] ? t.v[n] : f.v[n]; }); }
+		friend Vec8 Floor(const Vec8& x) { return Map([&](size_t n) { return std::floor(x.v[n]); }); }
+#endif
+	};
+
+	// The vector versions of FastSine() and PolyBLEP(), with the branches turned into selects
+	static inline Vec8 FastSine(const Vec8& t)
+	{
+		const Vec8 half = Vec8::Set(0.5f);
+		Vec8 x = t - Floor(t + half);
+		x = Max(Min(x, half - x), Vec8::Set(-0.5f) - x);
+		const Vec8 x2 = x * x;
+		Vec8 p = Vec8::Set(fSineC7) + x2 * Vec8::Set(fSineC9);
+		p = Vec8::Set(fSineC5) + x2 * p;
+		p = Vec8::Set(fSineC3) + x2 * p;
+		p = Vec8::Set(fSineC1) + x2 * p;
+		return x * p;
+	}
+
+	static inline Vec8 PolyBLEP(const Vec8& t, const Vec8& dt, const Vec8& rdt)
+	{
+		const Vec8 one = Vec8::Set(1.0f), zero = Vec8::Set(0.0f);
+		const Vec8 x0 = t * rdt, x1 = (t - one) * rdt;
+		const Vec8 fStart = x0 + x0 - x0 * x0 - one;
+		const Vec8 fEnd = x1 * x1 + x1 + x1 + one;
+		return SelectLess(t, dt, fStart, SelectLess(one - dt, t, fEnd, zero));
+	}
+
+	void FastSine8(const float* t, float* pOut)
+	{
+		FastSine(Vec8::Load(t)).Store(pOut);
+	}
+
+	float PolyBLEP(const float t, const float dt)
+	{
+		if (t < dt)
+		{
+			const float x = t / dt;
+			return x + x - x * x - 1.0f;
+		}
+		else if (t > 1.0f - dt)
+		{
+			const float x = (t - 1.0f) / dt;
+			return x * x + x + x + 1.0f;
+		}
+		return 0.0f;
+	}
+
+
 	Property::Property(double f)
 	{
 		value = std::clamp(f, -1.0, 1.0);
@@ -1250,7 +2632,19 @@ namespace olc::sound
 	}
 
 
-	ModularSynth::ModularSynth()
+	void Module::AddInputs(std::initializer_list<Property*> ports)
+	{
+		m_vInputs.insert(m_vInputs.end(), ports);
+	}
+
+	void Module::AddOutputs(std::initializer_list<Property*> ports)
+	{
+		m_vOutputs.insert(m_vOutputs.end(), ports);
+	}
+
+
+	ModularSynth::ModularSynth(const uint32_t nMaxBlockSamples)
+		: m_nMaxBlockSamples(nMaxBlockSamples)
 	{
 
 	}
@@ -1258,9 +2652,10 @@ namespace olc::sound
 	bool ModularSynth::AddModule(Module* pModule)
 	{
 		// Check if module already added
-		if (std::find(m_vModules.begin(), m_vModules.end(), pModule) == std::end(m_vModules))
+		if (pModule != nullptr && std::find(m_vModules.begin(), m_vModules.end(), pModule) == std::end(m_vModules))
 		{
 			m_vModules.push_back(pModule);
+			m_bCompiled = false;
 			return true;
 		}
 
@@ -1269,9 +2664,10 @@ namespace olc::sound
 
 	bool ModularSynth::RemoveModule(Module* pModule)
 	{
-		if (std::find(m_vModules.begin(), m_vModules.end(), pModule) == std::end(m_vModules))
+		if (std::find(m_vModules.begin(), m_vModules.end(), pModule) != std::end(m_vModules))
 		{
 			m_vModules.erase(std::remove(m_vModules.begin(), m_vModules.end(), pModule), m_vModules.end());
+			m_bCompiled = false;
 			return true;
 		}
 
@@ -1289,6 +2685,7 @@ namespace olc::sound
 			if (pInput != nullptr && pOutput != nullptr)
 			{
 				m_vPatches.push_back(newPatch);
+				m_bCompiled = false;
 				return true;
 			}
 		}
@@ -1300,76 +2697,249 @@ namespace olc::sound
 	{
 		std::pair<Property*, Property*> newPatch = std::pair<Property*, Property*>(pInput, pOutput);
 
-		if (std::find(m_vPatches.begin(), m_vPatches.end(), newPatch) == std::end(m_vPatches))
+		if (std::find(m_vPatches.begin(), m_vPatches.end(), newPatch) != std::end(m_vPatches))
 		{
 			m_vPatches.erase(std::remove(m_vPatches.begin(), m_vPatches.end(), newPatch), m_vPatches.end());
+			m_bCompiled = false;
 			return true;
 		}
-
-		return false;
+
+		return false;
+	}
+
+	void ModularSynth::Compile()
+	{
+		// Who owns which output?
+		std::map<const Property*, size_t> mapOutputOwner;
+		for (size_t i = 0; i < m_vModules.size(); i++)
+			for (auto& pPort : m_vModules[i]->m_vOutputs)
+			{
+				pPort->m_vBuffer.assign(m_nMaxBlockSamples, float(pPort->value));
+				pPort->m_pBlock = pPort->m_vBuffer.data();
+				mapOutputOwner[pPort] = i;
+			}
+
+		// Unpatched inputs read their own, ramped, buffer
+		for (auto& pModule : m_vModules)
+			for (auto& pPort : pModule->m_vInputs)
+			{
+				pPort->m_vBuffer.assign(m_nMaxBlockSamples, float(pPort->value));
+				pPort->m_pBlock = pPort->m_vBuffer.data();
+				pPort->m_pControl = nullptr;
+				pPort->m_fSmoothed = float(pPort->value);
+				pPort->m_nSettled = m_nMaxBlockSamples;
+			}
+
+		// Resolve patches into buffer aliases, and dependencies between modules
+		std::vector<std::vector<size_t>> vDependents(m_vModules.size());
+		std::vector<size_t> vDependencies(m_vModules.size(), 0);
+		std::map<const Property*, size_t> mapInputOwner;
+		for (size_t i = 0; i < m_vModules.size(); i++)
+			for (auto& pPort : m_vModules[i]->m_vInputs)
+				mapInputOwner[pPort] = i;
+
+		for (auto& patch : m_vPatches)
+		{
+			auto itSource = mapOutputOwner.find(patch.first);
+			if (itSource != mapOutputOwner.end())
+			{
+				patch.second->m_pBlock = patch.first->m_vBuffer.data();
+				patch.second->m_pControl = nullptr;
+
+				auto itDest = mapInputOwner.find(patch.second);
+				if (itDest != mapInputOwner.end() && itDest->second != itSource->second)
+				{
+					vDependents[itSource->second].push_back(itDest->second);
+					vDependencies[itDest->second]++;
+				}
+			}
+			else
+			{
+				// Not an output of this synth, so treat it as a control value
+				patch.second->m_pBlock = patch.second->m_vBuffer.data();
+				patch.second->m_pControl = patch.first;
+			}
+		}
+
+		m_vSmoothed.clear();
+		for (auto& pModule : m_vModules)
+			for (auto& pPort : pModule->m_vInputs)
+				if (!pPort->m_vBuffer.empty() && pPort->m_pBlock == pPort->m_vBuffer.data())
+					m_vSmoothed.push_back(pPort);
+
+		// Kahn's algorithm, preferring the order modules were added in
+		m_vRunOrder.clear();
+		std::vector<bool> vPlaced(m_vModules.size(), false);
+		std::vector<size_t> vReady;
+		for (size_t i = 0; i < m_vModules.size(); i++)
+			if (vDependencies[i] == 0) vReady.push_back(i);
+
+		while (m_vRunOrder.size() < m_vModules.size())
+		{
+			if (vReady.empty())
+			{
+				// Only feedback loops remain, so break one where it was added first
+				for (size_t i = 0; i < m_vModules.size(); i++)
+					if (!vPlaced[i]) { vReady.push_back(i); break; }
+			}
+
+			std::sort(vReady.begin(), vReady.end(), std::greater<size_t>());
+			const size_t nModule = vReady.back();
+			vReady.pop_back();
+			if (vPlaced[nModule]) continue;
+
+			vPlaced[nModule] = true;
+			m_vRunOrder.push_back(m_vModules[nModule]);
+			for (auto nDependent : vDependents[nModule])
+				if (!vPlaced[nDependent] && --vDependencies[nDependent] == 0)
+					vReady.push_back(nDependent);
+		}
+
+		m_bCompiled = true;
+	}
+
+	void ModularSynth::PrepareInputs(const uint32_t nSamples, const bool bNewBlock)
+	{
+		for (auto& pPort : m_vSmoothed)
+		{
+			const float fTarget = float(pPort->m_pControl != nullptr ? pPort->m_pControl->value : pPort->value);
+			float* pBuffer = pPort->m_vBuffer.data();
+
+			if (bNewBlock && fTarget != pPort->m_fSmoothed)
+			{
+				// Ramp to the new value across the block, rather than stepping
+				const float fStart = pPort->m_fSmoothed;
+				const float fStep = (fTarget - fStart) / float(nSamples);
+				for (uint32_t n = 0; n < nSamples; n++)
+					pBuffer[n] = fStart + fStep * float(n + 1);
+				pPort->m_fSmoothed = fTarget;
+				pPort->m_nSettled = 0;
+			}
+			else if (bNewBlock && pPort->m_nSettled < nSamples)
+			{
+				// Arrived last block, so hold from now on
+				std::fill_n(pBuffer, nSamples, fTarget);
+				pPort->m_nSettled = nSamples;
+			}
+		}
 	}
 
-	void ModularSynth::UpdatePatches()
+	void ModularSynth::Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples)
 	{
-		// Update patches
-		for (auto& patch : m_vPatches)
+		if (!m_bCompiled || nSamples > m_nMaxBlockSamples)
 		{
-			patch.second->value = patch.first->value;
+			m_nMaxBlockSamples = std::max(m_nMaxBlockSamples, nSamples);
+			Compile();
 		}
-	}
 
+		// Every channel of a block hears the same ramp
+		const bool bNewBlock = dTime != m_dBlockTime;
+		m_dBlockTime = dTime;
+		PrepareInputs(nSamples, bNewBlock);
 
-	void ModularSynth::Update(uint32_t nChannel, double dTime, double dTimeStep)
-	{
 		// Now update synth
-		for (auto& pModule : m_vModules)
+		for (auto& pModule : m_vRunOrder)
 		{
-			pModule->Update(nChannel, dTime, dTimeStep);
+			pModule->Update(nChannel, dTime, dTimeStep, nSamples);
+
+			for (auto& pPort : pModule->m_vOutputs)
+				pPort->value = pPort->m_vBuffer[nSamples - 1];
 		}
 	}
 
 
 	namespace modules
 	{		
-		void Oscillator::Update(uint32_t nChannel, double dTime, double dTimeStep)
+		Oscillator::Oscillator()
+		{
+			AddInputs({ &frequency, &amplitude, &lfo_input, &parameter });
+			AddOutputs({ &output });
+		}
+
+		void Oscillator::Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples)
 		{
-			// We use phase accumulation to combat change in parameter glitches
-			double w = frequency.value * max_frequency * dTimeStep;
-			phase_acc += w + lfo_input.value * frequency.value;
-			if (phase_acc >= 2.0) phase_acc -= 2.0;
+			// Phase is accumulated, so only the step between samples matters
+			(void)dTime;
+			double& phase = phase_acc[nChannel % phase_acc.size()];
+			float* pOutput = output.write();
+
+			// One loop per waveform, rather than a decision per sample. Phase is measured
+			// in cycles, 0.0 to 1.0, so every waveform plays at the same pitch
+			auto Advance = [&](uint32_t n)
+			{
+				// We use phase accumulation to combat change in parameter glitches
+				const double w = frequency[n] * max_frequency * dTimeStep + lfo_input[n] * frequency[n];
+				phase += w;
+				phase -= std::floor(phase);
+				return std::min(float(std::abs(w)), 0.5f);
+			};
 
 			switch (waveform)
 			{
 			case Type::Sine:
-				output = amplitude.value * sin(phase_acc * 2.0 * 3.14159);
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					Advance(n);
+					pOutput[n] = amplitude[n] * FastSine(float(phase));
+				}
 				break;
 
 			case Type::Saw:
-				output = amplitude.value * (phase_acc - 1.0) * 2.0;
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					const float dt = Advance(n), t = float(phase);
+					pOutput[n] = amplitude[n] * (t + t - 1.0f - PolyBLEP(t, dt));
+				}
 				break;
 
 			case Type::Square:
-				output = amplitude.value * (phase_acc >= 1.0) ? 1.0 : -1.0;
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					const float dt = Advance(n), t = float(phase);
+					const float fNaive = t >= 0.5f ? 1.0f : -1.0f;
+					pOutput[n] = amplitude[n] * (fNaive - PolyBLEP(t, dt) + PolyBLEP(t + 0.5f - float(t >= 0.5f), dt));
+				}
 				break;
 
 			case Type::Triangle:
-				output = amplitude.value * (phase_acc < 1.0) ? (phase_acc * 0.5) : (1.0 - phase_acc * 0.5);
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					Advance(n);
+					pOutput[n] = amplitude[n] * (1.0f - 4.0f * std::abs(float(phase) - 0.5f));
+				}
 				break;
 
 			case Type::PWM:
-				output = amplitude.value * (phase_acc >= (parameter.value + 1.0)) ? 1.0 : -1.0;
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					const float dt = Advance(n), t = float(phase);
+					const float fDuty = std::clamp((parameter[n] + 1.0f) * 0.5f, 0.0f, 1.0f);
+					const float fRise = t + 1.0f - fDuty;
+					pOutput[n] = amplitude[n] * ((t >= fDuty ? 1.0f : -1.0f) - PolyBLEP(t, dt) + PolyBLEP(fRise - float(fRise >= 1.0f), dt));
+				}
 				break;
 
 			case Type::Wave:
-				if(pWave != nullptr)
-					output = amplitude.value * pWave->vChannelView[nChannel].GetSample(phase_acc * 0.5 * pWave->file.durationInSamples());
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					Advance(n);
+					pOutput[n] = pWave == nullptr ? 0.0f :
+						amplitude[n] * float(pWave->vChannelView[nChannel % pWave->file.channels()].GetSample(phase * pWave->file.durationInSamples()));
+				}
 				break;
 
 			case Type::Noise:
-				output = amplitude.value * rndDouble(-1.0, 1.0);
+				for (uint32_t n = 0; n < nSamples; n++)
+				{
+					Advance(n);
+					pOutput[n] = amplitude[n] * float(rndDouble(-1.0, 1.0));
+				}
 				break;
 
 			}
+
+			for (uint32_t n = 0; n < nSamples; n++)
+				pOutput[n] = std::clamp(pOutput[n], -1.0f, 1.0f);
 		}
 
 		double Oscillator::rndDouble(double min, double max)
@@ -1387,6 +2957,164 @@ namespace olc::sound
 			uint32_t m2 = uint32_t(((tmp >> 32) ^ tmp) & 0xFFFFFFFF);
 			return m2;
 		}
+
+
+		OscillatorBank::OscillatorBank(const size_t nOscillators, const Type waveform)
+			: waveform(waveform), m_nOscillators(nOscillators)
+		{
+			AddInputs({ &amplitude });
+			AddOutputs({ &output });
+
+			m_vLanes.resize((nOscillators + nLanes - 1) / nLanes);
+			m_vMix.resize(512 * nLanes);
+			for (size_t i = 0; i < m_vLanes.size() * nLanes; i++)
+			{
+				auto& lanes = m_vLanes[i / nLanes];
+				lanes.duty[i % nLanes] = 0.5f;
+				lanes.seed[i % nLanes] = 0xB00B1E5u + uint32_t(i) * 0x9E3779B9u;
+			}
+		}
+
+		size_t OscillatorBank::size() const
+		{
+			return m_nOscillators;
+		}
+
+		void OscillatorBank::SetFrequency(const size_t nOscillator, const double dFrequency)
+		{
+			if (nOscillator < m_nOscillators)
+				m_vLanes[nOscillator / nLanes].frequency[nOscillator % nLanes] = float(dFrequency);
+		}
+
+		void OscillatorBank::SetAmplitude(const size_t nOscillator, const double dAmplitude)
+		{
+			if (nOscillator < m_nOscillators)
+				m_vLanes[nOscillator / nLanes].target[nOscillator % nLanes] = float(std::clamp(dAmplitude, -1.0, 1.0));
+		}
+
+		void OscillatorBank::SetParameter(const size_t nOscillator, const double dParameter)
+		{
+			if (nOscillator < m_nOscillators)
+				m_vLanes[nOscillator / nLanes].duty[nOscillator % nLanes] = float(std::clamp((dParameter + 1.0) * 0.5, 0.0, 1.0));
+		}
+
+		void OscillatorBank::Update(uint32_t nChannel, double dTime, double dTimeStep, uint32_t nSamples)
+		{
+			// Mono, so the other channels of this block are already done
+			(void)nChannel;
+			if (dTime == m_dBlockTime)
+				return;
+			m_dBlockTime = dTime;
+
+			// Each lane accumulates its own mix, so the lanes are only added together
+			// once a sample, at the end, rather than once a sample per group of lanes
+			if (m_vMix.size() < size_t(nSamples) * nLanes)
+				m_vMix.resize(size_t(nSamples) * nLanes);
+			std::fill_n(m_vMix.begin(), size_t(nSamples) * nLanes, 0.0f);
+			float* pMix = m_vMix.data();
+
+			const Vec8 one = Vec8::Set(1.0f), zero = Vec8::Set(0.0f), half = Vec8::Set(0.5f);
+
+			for (auto& lanes : m_vLanes)
+			{
+				alignas(32) float vIncrement[nLanes], vDelta[nLanes], vInvDelta[nLanes], vStep[nLanes];
+				for (size_t l = 0; l < nLanes; l++)
+				{
+					// Increments are at most half a cycle, so a compare is enough to wrap
+					vDelta[l] = std::min(std::abs(lanes.frequency[l] * float(dTimeStep)), 0.5f);
+					vIncrement[l] = std::copysign(vDelta[l], lanes.frequency[l]);
+					vInvDelta[l] = vDelta[l] > 0.0f ? 1.0f / vDelta[l] : 0.0f;
+					vStep[l] = (lanes.target[l] - lanes.amplitude[l]) / float(nSamples);
+				}
+
+				const Vec8 increment = Vec8::Load(vIncrement), dt = Vec8::Load(vDelta), rdt = Vec8::Load(vInvDelta);
+				const Vec8 step = Vec8::Load(vStep), duty = Vec8::Load(lanes.duty);
+				Vec8 phase = Vec8::Load(lanes.phase), gain = Vec8::Load(lanes.amplitude);
+
+				// The waveform is chosen once, and the sample loop built around it
+				auto Render = [&](auto&& Waveform)
+				{
+					for (uint32_t n = 0; n < nSamples; n++)
+					{
+						phase = phase + increment;
+						phase = phase - SelectLess(phase, one, zero, one);
+						phase = phase + SelectLess(phase, zero, one, zero);
+						gain = gain + step;
+
+						float* pLanes = pMix + size_t(n) * nLanes;
+						(Vec8::Load(pLanes) + Waveform(phase) * gain).Store(pLanes);
+					}
+				};
+
+				switch (waveform)
+				{
+				case Type::Sine:
+					Render([&](const Vec8& t) { return FastSine(t); });
+					break;
+
+				case Type::Saw:
+					Render([&](const Vec8& t) { return t + t - one - PolyBLEP(t, dt, rdt); });
+					break;
+
+				case Type::Square:
+					Render([&](const Vec8& t)
+					{
+						const Vec8 fNaive = SelectLess(t, half, zero - one, one);
+						const Vec8 fRise = t + half - SelectLess(t, half, zero, one);
+						return fNaive - PolyBLEP(t, dt, rdt) + PolyBLEP(fRise, dt, rdt);
+					});
+					break;
+
+				case Type::Triangle:
+					Render([&](const Vec8& t) { return one - Vec8::Set(4.0f) * Abs(t - half); });
+					break;
+
+				case Type::PWM:
+					Render([&](const Vec8& t)
+					{
+						const Vec8 fNaive = SelectLess(t, duty, zero - one, one);
+						Vec8 fRise = t + one - duty;
+						fRise = fRise - SelectLess(fRise, one, zero, one);
+						return fNaive - PolyBLEP(t, dt, rdt) + PolyBLEP(fRise, dt, rdt);
+					});
+					break;
+
+				case Type::Noise:
+					// xorshift32 per lane, with the top 23 bits becoming a float in [-1, 1)
+					Render([&](const Vec8&)
+					{
+						alignas(32) float vNoise[nLanes];
+						for (size_t l = 0; l < nLanes; l++)
+						{
+							uint32_t x = lanes.seed[l];
+							x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+							lanes.seed[l] = x;
+							const uint32_t nBits = (x >> 9) | 0x40000000u;
+							std::memcpy(&vNoise[l], &nBits, sizeof(float));
+						}
+						return Vec8::Load(vNoise) - Vec8::Set(3.0f);
+					});
+					break;
+
+				default:
+					break;
+				}
+
+				phase.Store(lanes.phase);
+				// Remove rounding error in the ramp, so it lands exactly
+				std::copy_n(lanes.target, nLanes, lanes.amplitude);
+			}
+
+			float* pOutput = output.write();
+			for (uint32_t n = 0; n < nSamples; n++)
+			{
+				const float* pLanes = pMix + size_t(n) * nLanes;
+				pOutput[n] = ((pLanes[0] + pLanes[4]) + (pLanes[2] + pLanes[6])) + ((pLanes[1] + pLanes[5]) + (pLanes[3] + pLanes[7]));
+			}
+
+			for (uint32_t n = 0; n < nSamples; n++)
+				pOutput[n] = std::clamp(pOutput[n] * amplitude[n], -1.0f, 1.0f);
+		}
 	}
 	}
 }
@@ -1410,15 +3138,30 @@ namespace olc::sound::driver
 
 	bool WinMM::Open(const std::string& sOutputDevice, const std::string& sInputDevice)
 	{
+		auto MakeFormat = [&](SampleFormat format)
+		{
+			WAVEFORMATEX waveFormat;
+			waveFormat.wFormatTag = format == SampleFormat::Float32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+			waveFormat.nSamplesPerSec = m_pHost->GetSampleRate();
+			waveFormat.wBitsPerSample = WORD(SampleFormatSize(format) * 8);
+			waveFormat.nChannels = m_pHost->GetChannels();
+			waveFormat.nBlockAlign = (waveFormat.wBitsPerSample / 8) * waveFormat.nChannels;
+			waveFormat.nAvgBytesPerSec = waveFormat.nSamplesPerSec * waveFormat.nBlockAlign;
+			waveFormat.cbSize = 0;
+			return waveFormat;
+		};
+
+		// Ask the device which formats it will take, without actually opening it
+		std::vector<SampleFormat> vFormats;
+		for (auto format : { SampleFormat::Float32, SampleFormat::S16 })
+		{
+			WAVEFORMATEX waveFormat = MakeFormat(format);
+			if (waveOutOpen(nullptr, WAVE_MAPPER, &waveFormat, 0, 0, WAVE_FORMAT_QUERY) == MMSYSERR_NOERROR)
+				vFormats.push_back(format);
+		}
+
 		// Device is available
-		WAVEFORMATEX waveFormat;
-		waveFormat.wFormatTag = WAVE_FORMAT_PCM;
-		waveFormat.nSamplesPerSec = m_pHost->GetSampleRate();
-		waveFormat.wBitsPerSample = sizeof(short) * 8;
-		waveFormat.nChannels = m_pHost->GetChannels();
-		waveFormat.nBlockAlign = (waveFormat.wBitsPerSample / 8) * waveFormat.nChannels;
-		waveFormat.nAvgBytesPerSec = waveFormat.nSamplesPerSec * waveFormat.nBlockAlign;
-		waveFormat.cbSize = 0;
+		WAVEFORMATEX waveFormat = MakeFormat(NegotiateFormat(vFormats));
 
 		// Open Device if valid
 		if (waveOutOpen(&m_hwDevice, WAVE_MAPPER, &waveFormat, (DWORD_PTR)WinMM::waveOutProc, (DWORD_PTR)this, CALLBACK_FUNCTION) != S_OK)
@@ -1429,15 +3172,15 @@ namespace olc::sound::driver
 
 		// Allocate block memory - I dont like vector of vectors, so going with this mess instead
 		// My std::vector's content will change, but their size never will - they are basically array now
-		m_pvBlockMemory = std::make_unique<std::vector<short>[]>(m_pHost->GetBlocks());
+		m_pvBlockMemory = std::make_unique<std::vector<uint8_t>[]>(m_pHost->GetBlocks());
 		for (size_t i = 0; i < m_pHost->GetBlocks(); i++)
-			m_pvBlockMemory[i].resize(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels(), 0);
+			m_pvBlockMemory[i].resize(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels() * SampleFormatSize(m_nSampleFormat), 0);
 
 		// Link headers to block memory - clever, so we only move headers about
 		// rather than memory...
 		for (unsigned int n = 0; n < m_pHost->GetBlocks(); n++)
 		{
-			m_pWaveHeaders[n].dwBufferLength = DWORD(m_pvBlockMemory[0].size() * sizeof(short));
+			m_pWaveHeaders[n].dwBufferLength = DWORD(m_pvBlockMemory[0].size());
 			m_pWaveHeaders[n].lpData = (LPSTR)(m_pvBlockMemory[n].data());
 		}
 
@@ -1499,10 +3242,15 @@ namespace olc::sound::driver
 		// We will be using this vector to transfer to the host for filling, with 
 		// user sound data (float32, -1.0 --> +1.0)
 		std::vector<float> vFloatBuffer(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels(), 0.0f);
+		uint32_t nBlocksWritten = 0;
 
 		// While the system is active, start requesting audio data
 		while (m_bDriverLoopActive)
 		{
+			// Once running, if every block has come back the device has nothing left to play
+			if (nBlocksWritten >= m_pHost->GetBlocks() && m_nBlockFree == m_pHost->GetBlocks())
+				ReportUnderrun();
+
 			// Are there any blocks available to fill? ...
 			if (m_nBlockFree == 0)
 			{
@@ -1531,12 +3279,13 @@ namespace olc::sound::driver
 			// maintain
 
 			// Userland will populate a float buffer, that gets cleanly converted to
-			// a buffer of shorts for DAC
-			ProcessOutputBlock(vFloatBuffer, m_pvBlockMemory[m_nBlockCurrent]);
+			// the format the DAC wants, if it doesn't want float anyway
+			ProcessOutputBlock(vFloatBuffer, m_pvBlockMemory[m_nBlockCurrent].data());
 
 			// Send block to sound device
 			waveOutPrepareHeader(m_hwDevice, &m_pWaveHeaders[m_nBlockCurrent], sizeof(WAVEHDR));
 			waveOutWrite(m_hwDevice, &m_pWaveHeaders[m_nBlockCurrent], sizeof(WAVEHDR));
+			nBlocksWritten++;
 			m_nBlockCurrent++;
 			m_nBlockCurrent %= m_pHost->GetBlocks();
 		}
@@ -1635,7 +3384,7 @@ void SDLMixer::FillChunkBuffer(const std::vector<float>& userData) const
             ConvertFloatTo<Sint32>(userData, reinterpret_cast<Sint32*>(audioChunk.abuf));
             break;
         case AUDIO_S16:
-            ConvertFloatTo<Sint16>(userData, reinterpret_cast<Sint16*>(audioChunk.abuf));
+            ConvertFloatToS16(userData.data(), reinterpret_cast<Sint16*>(audioChunk.abuf), userData.size());
             break;
         case AUDIO_U16:
             ConvertFloatTo<Uint16>(userData, reinterpret_cast<Uint16*>(audioChunk.abuf));
@@ -1662,8 +3411,16 @@ void SDLMixer::SDLMixerCallback(int channel)
     if (!instance->m_keepRunning)
         return;
 
-    instance->GetFullOutputBlock(userData);
-    instance->FillChunkBuffer(userData);
+    // Float devices are mixed into directly, everything else needs converting
+    if (instance->m_haveFormat == AUDIO_F32)
+    {
+        instance->GetFullOutputBlock(reinterpret_cast<float*>(instance->audioChunk.abuf));
+    }
+    else
+    {
+        instance->GetFullOutputBlock(userData);
+        instance->FillChunkBuffer(userData);
+    }
 
     if (Mix_PlayChannel(0, &instance->audioChunk, 0) == -1)
     {
@@ -1738,9 +3495,27 @@ namespace olc::sound::driver
 		snd_pcm_hw_params_alloca(&params);
 		snd_pcm_hw_params_any(m_pPCM, params);
 
+		// Find out which of our formats the device will accept
+		auto ToALSA = [](SampleFormat format)
+		{
+			switch (format)
+			{
+			case SampleFormat::S16: return SND_PCM_FORMAT_S16;
+			case SampleFormat::S24: return SND_PCM_FORMAT_S24;
+			default:                return SND_PCM_FORMAT_FLOAT;
+			}
+		};
+
+		std::vector<SampleFormat> vFormats;
+		for (auto format : { SampleFormat::Float32, SampleFormat::S16, SampleFormat::S24 })
+		{
+			if (snd_pcm_hw_params_test_format(m_pPCM, params, ToALSA(format)) == 0)
+				vFormats.push_back(format);
+		}
+
 		// Set other parameters
 		snd_pcm_hw_params_set_access(m_pPCM, params, SND_PCM_ACCESS_RW_INTERLEAVED);
-		snd_pcm_hw_params_set_format(m_pPCM, params, SND_PCM_FORMAT_FLOAT);
+		snd_pcm_hw_params_set_format(m_pPCM, params, ToALSA(NegotiateFormat(vFormats)));
 		snd_pcm_hw_params_set_rate(m_pPCM, params, m_pHost->GetSampleRate(), 0);
 		snd_pcm_hw_params_set_channels(m_pPCM, params, m_pHost->GetChannels());
 		snd_pcm_hw_params_set_period_size(m_pPCM, params, m_pHost->GetBlockSampleCount(), 0);
@@ -1756,16 +3531,20 @@ namespace olc::sound::driver
 
 	bool ALSA::Start()
 	{
+		// Zero is silence in all of our formats
+		const size_t nBlockBytes = m_pHost->GetBlockSampleCount() * m_pHost->GetChannels() * SampleFormatSize(m_nSampleFormat);
+
 		// Unsure if really needed, helped prevent underrun on my setup
-		std::vector<float> vSilence(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels(), 0.0f);
+		std::vector<uint8_t> vSilence(nBlockBytes, 0);
 		snd_pcm_start(m_pPCM);
 		for (unsigned int i = 0; i < m_pHost->GetBlocks(); i++)
 			snd_pcm_writei(m_pPCM, vSilence.data(), m_pHost->GetBlockSampleCount());
 
-		m_rBuffers.Resize(m_pHost->GetBlocks(), m_pHost->GetBlockSampleCount() * m_pHost->GetChannels());
+		m_rBuffers.Resize(m_pHost->GetBlocks(), nBlockBytes);
 
 		snd_pcm_start(m_pPCM);
 		m_bDriverLoopActive = true;
+		m_thMixerLoop = std::thread(&ALSA::MixerLoop, this);
 		m_thDriverLoop = std::thread(&ALSA::DriverLoop, this);
 
 		return true;
@@ -1773,10 +3552,15 @@ namespace olc::sound::driver
 
 	void ALSA::Stop()
 	{
-		// Signal the driver loop to exit
+		// Signal the driver loops to exit
 		m_bDriverLoopActive = false;
+		m_cvMixer.notify_all();
+		m_cvDriver.notify_all();
+
+		// Wait for driver threads to exit gracefully
+		if (m_thMixerLoop.joinable())
+			m_thMixerLoop.join();
 
-		// Wait for driver thread to exit gracefully
 		if (m_thDriverLoop.joinable())
 			m_thDriverLoop.join();
 
@@ -1795,9 +3579,40 @@ namespace olc::sound::driver
 		snd_config_update_free_global();
 	}
 
+	void ALSA::MixerLoop()
+	{
+		// Scratch space, only used if the device doesn't take float
+		std::vector<float> vFloatBuffer(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels(), 0.0f);
+
+		// A sleeper can miss a wake up between looking at the ring and waiting, so it
+		// never sleeps longer than this. Normally it is woken the moment a block is taken
+		const auto tMaxSleep = std::chrono::microseconds(int64_t(250000.0 * m_pHost->GetBlockSampleCount() / m_pHost->GetSampleRate()));
+
+		while (m_bDriverLoopActive)
+		{
+			uint8_t* pBlock = m_rBuffers.BeginWrite();
+			if (pBlock != nullptr)
+			{
+				ProcessOutputBlock(vFloatBuffer, pBlock);
+				m_rBuffers.EndWrite();
+				m_cvDriver.notify_one();
+			}
+			else
+			{
+				// Every block is mixed ahead, so wait for the device to take one
+				std::unique_lock<std::mutex> lm(m_muxWake);
+				m_cvMixer.wait_for(lm, tMaxSleep, [&] { return !m_bDriverLoopActive || !m_rBuffers.IsFull(); });
+			}
+		}
+	}
+
 	void ALSA::DriverLoop()
 	{
+		PromoteAudioThread();
+
 		const uint32_t nFrames = m_pHost->GetBlockSampleCount();
+		const size_t nFrameBytes = m_pHost->GetChannels() * SampleFormatSize(m_nSampleFormat);
+		const auto tMaxSleep = std::chrono::microseconds(int64_t(250000.0 * nFrames / m_pHost->GetSampleRate()));
 
 		int err;
 		std::vector<pollfd> vFDs;
@@ -1822,23 +3637,16 @@ namespace olc::sound::driver
 			}
 		}
 
-		// While the system is active, start requesting audio data
+		// While the system is active, hand mixed blocks to the device
 		while (m_bDriverLoopActive)
 		{
-			if (!m_rBuffers.IsFull())
-			{
-				// Grab some audio data
-				auto& vFreeBuffer = m_rBuffers.GetFreeBuffer();
-				GetFullOutputBlock(vFreeBuffer);
-			}
-
-			// Wait a bit if our buffer is full
+			// Wait for the device to have room for a block
 			auto avail = snd_pcm_avail_update(m_pPCM);
-			while (m_rBuffers.IsFull() && avail < nFrames)
+			while (m_bDriverLoopActive && avail >= 0 && avail < nFrames)
 			{
 				if (vFDs.size() == 0) break;
 
-				err = poll(vFDs.data(), vFDs.size(), -1);
+				err = poll(vFDs.data(), vFDs.size(), int(tMaxSleep.count() / 1000) + 1);
 				if (err < 0)
 					std::cerr << "poll returned " << err << "\n";
 
@@ -1853,32 +3661,56 @@ namespace olc::sound::driver
 				avail = snd_pcm_avail_update(m_pPCM);
 			}
 
-			// Write whatever we can
-			while (!m_rBuffers.IsEmpty() && avail >= nFrames)
+			if (avail == -EPIPE)
+			{
+				// Underrun, the device played everything we gave it
+				ReportUnderrun();
+				snd_pcm_recover(m_pPCM, int(avail), 1);
+				continue;
+			}
+
+			// Then for the mixer to have a block ready
+			const uint8_t* pBlock = m_rBuffers.BeginRead();
+			if (pBlock == nullptr)
 			{
-				auto vFullBuffer = m_rBuffers.GetFullBuffer();
-				uint32_t nWritten = 0;
+				std::unique_lock<std::mutex> lm(m_muxWake);
+				m_cvDriver.wait_for(lm, tMaxSleep, [&] { return !m_bDriverLoopActive || !m_rBuffers.IsEmpty(); });
+				continue;
+			}
 
-				while (nWritten < nFrames)
+			// Write it
+			uint32_t nWritten = 0;
+			while (nWritten < nFrames)
+			{
+				auto err = snd_pcm_writei(m_pPCM, pBlock + nWritten * nFrameBytes, nFrames - nWritten);
+				if (err > 0)
+					nWritten += err;
+				else if (err == -EPIPE)
 				{
-					auto err = snd_pcm_writei(m_pPCM, vFullBuffer.data() + nWritten, nFrames - nWritten);
-					if (err > 0)
-						nWritten += err;
-					else
-					{
-						std::cerr << "snd_pcm_writei returned " << err << "\n";
-						break;
-					}
+					ReportUnderrun();
+					snd_pcm_recover(m_pPCM, int(err), 1);
 				}
-				avail = snd_pcm_avail_update(m_pPCM);
+				else if (err == -EAGAIN)
+				{
+					if (vFDs.size() > 0) poll(vFDs.data(), vFDs.size(), int(tMaxSleep.count() / 1000) + 1);
+				}
+				else
+				{
+					std::cerr << "snd_pcm_writei returned " << err << "\n";
+					break;
+				}
+
+				if (!m_bDriverLoopActive) break;
 			}
+
+			m_rBuffers.EndRead();
+			m_cvMixer.notify_one();
 		}
 	}
 } // ALSA Driver Implementation
 #endif
 #if defined(SOUNDWAVE_USING_PULSE)
 // PULSE Driver Implementation
-#include <pulse/error.h>
 #include <iostream>
 
 namespace olc::sound::driver
@@ -1894,70 +3726,295 @@ namespace olc::sound::driver
 
 	bool PulseAudio::Open(const std::string& sOutputDevice, const std::string& sInputDevice)
 	{
+		// PulseAudio converts anything, and float is what the mixer makes
+		NegotiateFormat({ SampleFormat::Float32 });
+
+		const size_t nBlockBytes = m_pHost->GetBlockSampleCount() * m_pHost->GetChannels() * SampleFormatSize(m_nSampleFormat);
+		m_vFloatBuffer.assign(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels(), 0.0f);
+		m_vDeviceBuffer.assign(nBlockBytes, 0);
+
+		m_pMainLoop = pa_threaded_mainloop_new();
+		if (m_pMainLoop == nullptr)
+			return false;
+
+		m_pContext = pa_context_new(pa_threaded_mainloop_get_api(m_pMainLoop), "olcSoundWaveEngine");
+		if (m_pContext == nullptr)
+			return false;
+
+		pa_context_set_state_callback(m_pContext, &PulseAudio::ContextStateCallback, this);
+		if (pa_context_connect(m_pContext, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0)
+		{
+			std::cerr << "Failed to connect to PulseAudio: " << pa_strerror(pa_context_errno(m_pContext)) << "\n";
+			return false;
+		}
+
+		pa_threaded_mainloop_lock(m_pMainLoop);
+		if (pa_threaded_mainloop_start(m_pMainLoop) < 0)
+		{
+			pa_threaded_mainloop_unlock(m_pMainLoop);
+			return false;
+		}
+
+		// Wait for the server
+		pa_context_state_t nContextState;
+		while ((nContextState = pa_context_get_state(m_pContext)) != PA_CONTEXT_READY)
+		{
+			if (!PA_CONTEXT_IS_GOOD(nContextState))
+			{
+				std::cerr << "Failed to connect to PulseAudio: " << pa_strerror(pa_context_errno(m_pContext)) << "\n";
+				pa_threaded_mainloop_unlock(m_pMainLoop);
+				return false;
+			}
+			pa_threaded_mainloop_wait(m_pMainLoop);
+		}
+
 		pa_sample_spec ss {
 			PA_SAMPLE_FLOAT32, m_pHost->GetSampleRate(), (uint8_t)m_pHost->GetChannels()
 		};
 
-		m_pPA = pa_simple_new(NULL, "olcSoundWaveEngine", PA_STREAM_PLAYBACK, NULL,
-		                      "Output Stream", &ss, NULL, NULL, NULL);
+		m_pStream = pa_stream_new(m_pContext, "Output Stream", &ss, nullptr);
+		if (m_pStream == nullptr)
+		{
+			pa_threaded_mainloop_unlock(m_pMainLoop);
+			return false;
+		}
+
+		pa_stream_set_state_callback(m_pStream, &PulseAudio::StreamStateCallback, this);
+		pa_stream_set_write_callback(m_pStream, &PulseAudio::StreamWriteCallback, this);
+		pa_stream_set_underflow_callback(m_pStream, &PulseAudio::StreamUnderflowCallback, this);
+
+		// The whole of the latency (with ADJUST_LATENCY) is nBlocks blocks, requested a
+		// block at a time. Playback starts once the buffer is full, as the other drivers do
+		pa_buffer_attr attr;
+		attr.maxlength = uint32_t(-1);
+		attr.tlength = uint32_t(nBlockBytes * m_pHost->GetBlocks());
+		attr.prebuf = uint32_t(-1);
+		attr.minreq = uint32_t(nBlockBytes);
+		attr.fragsize = uint32_t(-1);
 
-		if (m_pPA == NULL)
+		const pa_stream_flags_t nFlags = pa_stream_flags_t(PA_STREAM_START_CORKED | PA_STREAM_ADJUST_LATENCY |
+			PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE);
+
+		const char* sDevice = sOutputDevice == "DEFAULT" || sOutputDevice.empty() ? nullptr : sOutputDevice.c_str();
+		if (pa_stream_connect_playback(m_pStream, sDevice, &attr, nFlags, nullptr, nullptr) < 0)
+		{
+			std::cerr << "Failed to open PulseAudio stream: " << pa_strerror(pa_context_errno(m_pContext)) << "\n";
+			pa_threaded_mainloop_unlock(m_pMainLoop);
 			return false;
+		}
+
+		pa_stream_state_t nStreamState;
+		while ((nStreamState = pa_stream_get_state(m_pStream)) != PA_STREAM_READY)
+		{
+			if (!PA_STREAM_IS_GOOD(nStreamState))
+			{
+				std::cerr << "Failed to open PulseAudio stream: " << pa_strerror(pa_context_errno(m_pContext)) << "\n";
+				pa_threaded_mainloop_unlock(m_pMainLoop);
+				return false;
+			}
+			pa_threaded_mainloop_wait(m_pMainLoop);
+		}
 
+		pa_threaded_mainloop_unlock(m_pMainLoop);
 		return true;
 	}
 
 	bool PulseAudio::Start()
 	{
-		m_bDriverLoopActive = true;
-		m_thDriverLoop = std::thread(&PulseAudio::DriverLoop, this);
+		if (m_pStream == nullptr)
+			return false;
 
+		pa_threaded_mainloop_lock(m_pMainLoop);
+		Wait(pa_stream_cork(m_pStream, 0, [](pa_stream*, int, void* pUser) { pa_threaded_mainloop_signal(static_cast<pa_threaded_mainloop*>(pUser), 0); }, m_pMainLoop));
+		pa_threaded_mainloop_unlock(m_pMainLoop);
 		return true;
 	}
 
 	void PulseAudio::Stop()
 	{
-		// Signal the driver loop to exit
-		m_bDriverLoopActive = false;
+		if (m_pStream == nullptr)
+			return;
 
-		// Wait for driver thread to exit gracefully
-		if (m_thDriverLoop.joinable())
-			m_thDriverLoop.join();
+		pa_threaded_mainloop_lock(m_pMainLoop);
+		if (pa_stream_get_state(m_pStream) == PA_STREAM_READY)
+			Wait(pa_stream_cork(m_pStream, 1, [](pa_stream*, int, void* pUser) { pa_threaded_mainloop_signal(static_cast<pa_threaded_mainloop*>(pUser), 0); }, m_pMainLoop));
+		pa_threaded_mainloop_unlock(m_pMainLoop);
 	}
 
 	void PulseAudio::Close()
 	{
-		if (m_pPA != nullptr)
+		// Stopping the loop joins its thread, so nothing below races a callback
+		if (m_pMainLoop != nullptr)
+			pa_threaded_mainloop_stop(m_pMainLoop);
+
+		if (m_pStream != nullptr)
+		{
+			pa_stream_disconnect(m_pStream);
+			pa_stream_unref(m_pStream);
+			m_pStream = nullptr;
+		}
+
+		if (m_pContext != nullptr)
 		{
-			pa_simple_free(m_pPA);
-			m_pPA = nullptr;
+			pa_context_disconnect(m_pContext);
+			pa_context_unref(m_pContext);
+			m_pContext = nullptr;
 		}
+
+		if (m_pMainLoop != nullptr)
+		{
+			pa_threaded_mainloop_free(m_pMainLoop);
+			m_pMainLoop = nullptr;
+		}
+
+		m_bLatencyKnown = false;
 	}
 
-	void PulseAudio::DriverLoop()
+	double PulseAudio::GetOutputLatency() const
 	{
-		// We will be using this vector to transfer to the host for filling, with
-		// user sound data (float32, -1.0 --> +1.0)
-		std::vector<float> vFloatBuffer(m_pHost->GetBlockSampleCount() * m_pHost->GetChannels(), 0.0f);
+		if (!m_bLatencyKnown)
+			return Base::GetOutputLatency();
+		return double(m_nLatencyMicroseconds.load(std::memory_order_relaxed)) * 1e-6;
+	}
 
-		// While the system is active, start requesting audio data
-		while (m_bDriverLoopActive)
+	void PulseAudio::Wait(pa_operation* pOperation)
+	{
+		if (pOperation == nullptr)
+			return;
+
+		while (pa_operation_get_state(pOperation) == PA_OPERATION_RUNNING)
+			pa_threaded_mainloop_wait(m_pMainLoop);
+		pa_operation_unref(pOperation);
+	}
+
+	void PulseAudio::ContextStateCallback(pa_context* pContext, void* pUser)
+	{
+		pa_threaded_mainloop_signal(static_cast<PulseAudio*>(pUser)->m_pMainLoop, 0);
+	}
+
+	void PulseAudio::StreamStateCallback(pa_stream* pStream, void* pUser)
+	{
+		pa_threaded_mainloop_signal(static_cast<PulseAudio*>(pUser)->m_pMainLoop, 0);
+	}
+
+	void PulseAudio::StreamUnderflowCallback(pa_stream* pStream, void* pUser)
+	{
+		static_cast<PulseAudio*>(pUser)->ReportUnderrun();
+	}
+
+	void PulseAudio::StreamWriteCallback(pa_stream* pStream, size_t nBytes, void* pUser)
+	{
+		auto* pDriver = static_cast<PulseAudio*>(pUser);
+		const size_t nBlockBytes = pDriver->m_vDeviceBuffer.size();
+
+		// Always whole blocks - minreq is one block, so this is usually exactly one
+		for (size_t nWritten = 0; nWritten < nBytes; nWritten += nBlockBytes)
 		{
-			// Grab audio data from user
-			GetFullOutputBlock(vFloatBuffer);
+			// Mix straight into the server's memory if it will lend us a whole block
+			void* pData = nullptr;
+			size_t nSize = nBlockBytes;
+			if (pa_stream_begin_write(pStream, &pData, &nSize) < 0 || pData == nullptr || nSize < nBlockBytes)
+			{
+				if (pData != nullptr)
+					pa_stream_cancel_write(pStream);
+				pData = pDriver->m_vDeviceBuffer.data();
+			}
 
-			// Fill PulseAudio data buffer
-			int error;
-			if (pa_simple_write(m_pPA, vFloatBuffer.data(),
-			                    vFloatBuffer.size() * sizeof(float), &error) < 0)
+			pDriver->ProcessOutputBlock(pDriver->m_vFloatBuffer, pData);
+
+			if (pa_stream_write(pStream, pData, nBlockBytes, nullptr, 0, PA_SEEK_RELATIVE) < 0)
 			{
-				std::cerr << "Failed to feed data to PulseAudio: " << pa_strerror(error) << "\n";
+				std::cerr << "Failed to feed data to PulseAudio: " << pa_strerror(pa_context_errno(pa_stream_get_context(pStream))) << "\n";
+				break;
 			}
 		}
+
+		// Fresh after a write, and cheap - the timing info is interpolated locally
+		pa_usec_t nLatency = 0;
+		int nNegative = 0;
+		if (pa_stream_get_latency(pStream, &nLatency, &nNegative) == 0)
+		{
+			pDriver->m_nLatencyMicroseconds.store(nNegative ? 0 : uint64_t(nLatency), std::memory_order_relaxed);
+			pDriver->m_bLatencyKnown = true;
+		}
 	}
 } // PulseAudio Driver Implementation
 #endif
 
+#if defined(SOUNDWAVE_USING_OFFLINE)
+// Offline Driver Implementation
+namespace olc::sound::driver
+{
+	Offline::Offline(WaveEngine* pHost) : Base(pHost)
+	{ }
+
+	Offline::~Offline()
+	{
+		Stop();
+		Close();
+	}
+
+	bool Offline::Open(const std::string& sOutputDevice, const std::string& sInputDevice)
+	{
+		// Nothing to record from
+		(void)sInputDevice;
+
+		m_ofsOutput.open(sOutputDevice == "DEFAULT" ? "soundwave.wav" : sOutputDevice, std::ios::binary);
+		if (!m_ofsOutput.is_open())
+			return false;
+
+		// A file will take whatever it's given, so give it what the mixer makes
+		NegotiateFormat({ SampleFormat::Float32 });
+
+		const size_t nValues = m_pHost->GetBlockSampleCount() * m_pHost->GetChannels();
+		m_vFloatBuffer.resize(nValues);
+		m_vDeviceBuffer.resize(nValues * SampleFormatSize(m_nSampleFormat));
+
+		// Sizes are unknown until the end, so the header is rewritten on Close()
+		m_nSamplesWritten = 0;
+		wave::WriteHeader(m_ofsOutput, m_pHost->GetChannels(), m_pHost->GetSampleRate(), SampleFormatSize(m_nSampleFormat), 0);
+		return true;
+	}
+
+	bool Offline::Start()
+	{
+		m_bRunning = m_ofsOutput.is_open();
+		return m_bRunning;
+	}
+
+	void Offline::Stop()
+	{
+		m_bRunning = false;
+	}
+
+	void Offline::Close()
+	{
+		if (!m_ofsOutput.is_open())
+			return;
+
+		m_ofsOutput.seekp(0, std::ios::beg);
+		wave::WriteHeader(m_ofsOutput, m_pHost->GetChannels(), m_pHost->GetSampleRate(), SampleFormatSize(m_nSampleFormat), m_nSamplesWritten);
+		m_ofsOutput.close();
+	}
+
+	bool Offline::Render(const uint32_t nBlocks)
+	{
+		if (!m_bRunning)
+			return false;
+
+		// Stream each block straight out, nothing waits on a device clock here
+		for (uint32_t n = 0; n < nBlocks; n++)
+		{
+			ProcessOutputBlock(m_vFloatBuffer, m_vDeviceBuffer.data());
+			m_ofsOutput.write(reinterpret_cast<const char*>(m_vDeviceBuffer.data()), m_vDeviceBuffer.size());
+			m_nSamplesWritten += m_pHost->GetBlockSampleCount();
+		}
+
+		return m_ofsOutput.good();
+	}
+} // Offline Driver Implementation
+#endif
+
 #endif // OLC_SOUNDWAVE IMPLEMENTATION
 #endif // OLC_SOUNDWAVE_H
 
@@ -0,0 +1,289 @@
+/*
+	olcTextureAtlas.h
+
+	+-------------------------------------------------------------+
+	|         Texture atlases for the olcPixelGameEngine          |
+	+-------------------------------------------------------------+
+
+	What is this?
+	~~~~~~~~~~~~~
+	Every olc::Decal is its own GPU texture, so drawing a scene made of
+	many small sprites binds a texture per draw. olc::TextureAtlas packs
+	many sprites into a few large pages, each a single Decal, and hands
+	back the sub-rectangle each sprite ended up in. Draws from the same
+	page, one after another, then share one texture.
+
+	Packing uses a skyline, bottom-left, with the tallest sprites placed
+	first. Each sprite is surrounded by nPadding pixels copied from its
+	own edges, so filtering and rounding never pick up a neighbour.
+
+	Usage
+	~~~~~
+	olc::TextureAtlas atlas;
+	size_t nShip = atlas.Add(&sprShip);
+	size_t nRock = atlas.Add(&sprRock);
+	atlas.Build();
+
+	const olc::AtlasRegion& r = atlas.Region(nShip);
+	DrawPartialDecal(pos, r.decal, r.pos, r.size);
+
+	Build() creates Decals, so call it from the engine thread. Exactly one
+	translation unit must provide the implementation:
+
+	#define OLC_TEXTUREATLAS
+	#include "olcTextureAtlas.h"
+*/
+
+#pragma once
+#ifndef OLC_TEXTUREATLAS_H
+#define OLC_TEXTUREATLAS_H
+
+#include "olcPixelGameEngine.h"
+
+namespace olc
+{
+	// Where a sprite lives: a source rectangle within a Decal, ready for DrawPartialDecal()
+	struct AtlasRegion
+	{
+		olc::Decal* decal = nullptr;
+		olc::vf2d pos;
+		olc::vf2d size;
+		// which page of the atlas, or -1 if the sprite has a Decal of its own
+		int32_t page = -1;
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::SkylinePacker - places rectangles within a fixed size page              |
+	// O------------------------------------------------------------------------------O
+	class SkylinePacker
+	{
+	public:
+		SkylinePacker(const int32_t nWidth, const int32_t nHeight);
+
+	public:
+		// Returns false if there is no room left for a nWidth x nHeight rectangle
+		bool Insert(const int32_t nWidth, const int32_t nHeight, olc::vi2d& vPos);
+		// Smallest size holding everything inserted so far
+		olc::vi2d Used() const { return m_vUsed; }
+
+	private:
+		struct Segment { int32_t x, y, w; };
+		std::vector<Segment> m_vSkyline;
+		int32_t m_nWidth, m_nHeight;
+		olc::vi2d m_vUsed = { 0, 0 };
+	};
+
+	// O------------------------------------------------------------------------------O
+	// | olc::TextureAtlas - packs sprites into a few large Decals                    |
+	// O------------------------------------------------------------------------------O
+	class TextureAtlas
+	{
+	public:
+		TextureAtlas(const int32_t nPageSize = 2048, const int32_t nPadding = 1);
+
+	public:
+		// Queues a sprite for packing. It is copied by Build(), so must live until then
+		size_t Add(const olc::Sprite* pSprite);
+		// Packs everything added and creates a Decal per page. Engine thread only
+		void Build(const bool bFilter = false);
+
+		// Where sprite nIndex was packed; the decal is nullptr if it was too big for a page
+		const AtlasRegion& Region(const size_t nIndex) const { return m_vRegions[nIndex]; }
+		size_t Count() const { return m_vRegions.size(); }
+		size_t PageCount() const { return m_vPages.size(); }
+		olc::Decal* Page(const size_t nPage) const { return m_vPages[nPage]->Decal(); }
+
+		// Copies new pixels for sprite nIndex into its page, and uploads only that
+		// page again. The sprite must be the size it was when packed
+		bool Update(const size_t nIndex, const olc::Sprite* pSprite);
+
+	private:
+		void Blit(olc::Sprite* pPage, const olc::vi2d& vPos, const olc::Sprite* pSprite) const;
+
+		int32_t m_nPageSize;
+		int32_t m_nPadding;
+		std::vector<const olc::Sprite*> m_vPending;
+		std::vector<AtlasRegion> m_vRegions;
+		std::vector<std::unique_ptr<olc::Renderable>> m_vPages;
+	};
+}
+
+#ifdef OLC_TEXTUREATLAS
+#undef OLC_TEXTUREATLAS
+
+namespace olc
+{
+	SkylinePacker::SkylinePacker(const int32_t nWidth, const int32_t nHeight)
+		: m_nWidth(nWidth), m_nHeight(nHeight)
+	{
+		m_vSkyline.push_back({ 0, 0, nWidth });
+	}
+
+	bool SkylinePacker::Insert(const int32_t nWidth, const int32_t nHeight, olc::vi2d& vPos)
+	{
+		if (nWidth <= 0 || nHeight <= 0 || nWidth > m_nWidth || nHeight > m_nHeight) return false;
+
+		// Bottom-left: the lowest top edge wins, then the narrowest segment to waste less
+		size_t nBest = SIZE_MAX;
+		int32_t nBestTop = INT32_MAX, nBestWidth = INT32_MAX, nBestY = 0;
+		for (size_t i = 0; i < m_vSkyline.size(); i++)
+		{
+			const int32_t x = m_vSkyline[i].x;
+			if (x + nWidth > m_nWidth) break;
+
+			// Resting on the highest segment underneath it
+			int32_t y = 0, nRemaining = nWidth;
+			for (size_t j = i; nRemaining > 0; j++)
+			{
+				y = std::max(y, m_vSkyline[j].y);
+				nRemaining -= m_vSkyline[j].w;
+			}
+			if (y + nHeight > m_nHeight) continue;
+
+			if (y + nHeight < nBestTop || (y + nHeight == nBestTop && m_vSkyline[i].w < nBestWidth))
+			{
+				nBest = i;
+				nBestTop = y + nHeight;
+				nBestWidth = m_vSkyline[i].w;
+				nBestY = y;
+			}
+		}
+		if (nBest == SIZE_MAX) return false;
+
+		const int32_t x = m_vSkyline[nBest].x;
+		vPos = { x, nBestY };
+		m_vUsed = { std::max(m_vUsed.x, x + nWidth), std::max(m_vUsed.y, nBestTop) };
+
+		// The new segment covers the ones it sits on, trimming the last of them
+		m_vSkyline.insert(m_vSkyline.begin() + nBest, { x, nBestTop, nWidth });
+		size_t i = nBest + 1;
+		while (i < m_vSkyline.size() && m_vSkyline[i].x < x + nWidth)
+		{
+			const int32_t nOverlap = x + nWidth - m_vSkyline[i].x;
+			if (nOverlap < m_vSkyline[i].w)
+			{
+				m_vSkyline[i].x += nOverlap;
+				m_vSkyline[i].w -= nOverlap;
+				break;
+			}
+			m_vSkyline.erase(m_vSkyline.begin() + i);
+		}
+
+		// Neighbours at the same height become one segment
+		for (size_t j = 0; j + 1 < m_vSkyline.size(); )
+		{
+			if (m_vSkyline[j].y == m_vSkyline[j + 1].y)
+			{
+				m_vSkyline[j].w += m_vSkyline[j + 1].w;
+				m_vSkyline.erase(m_vSkyline.begin() + j + 1);
+			}
+			else
+				j++;
+		}
+
+		return true;
+	}
+
+	TextureAtlas::TextureAtlas(const int32_t nPageSize, const int32_t nPadding)
+		: m_nPageSize(nPageSize), m_nPadding(std::max(nPadding, 0))
+	{ }
+
+	size_t TextureAtlas::Add(const olc::Sprite* pSprite)
+	{
+		m_vPending.push_back(pSprite);
+		m_vRegions.push_back({});
+		return m_vRegions.size() - 1;
+	}
+
+	void TextureAtlas::Blit(olc::Sprite* pPage, const olc::vi2d& vPos, const olc::Sprite* pSprite) const
+	{
+		// The padding repeats the sprite's own edge pixels
+		const int32_t w = pSprite->width, h = pSprite->height, p = m_nPadding;
+		for (int32_t y = -p; y < h + p; y++)
+		{
+			const int32_t sy = std::clamp(y, 0, h - 1);
+			olc::Pixel* pDst = pPage->GetData() + size_t(vPos.y + y) * size_t(pPage->width) + size_t(vPos.x);
+			const olc::Pixel* pSrc = pSprite->pColData.data() + size_t(sy) * size_t(w);
+			for (int32_t x = -p; x < 0; x++) pDst[x] = pSrc[0];
+			std::memcpy(pDst, pSrc, size_t(w) * sizeof(olc::Pixel));
+			for (int32_t x = w; x < w + p; x++) pDst[x] = pSrc[w - 1];
+		}
+	}
+
+	void TextureAtlas::Build(const bool bFilter)
+	{
+		// Tallest first packs a skyline most tightly
+		std::vector<size_t> vOrder;
+		for (size_t i = 0; i < m_vPending.size(); i++)
+			if (m_vPending[i] != nullptr && m_vRegions[i].decal == nullptr) vOrder.push_back(i);
+		std::stable_sort(vOrder.begin(), vOrder.end(), [&](size_t a, size_t b)
+			{
+				if (m_vPending[a]->height != m_vPending[b]->height) return m_vPending[a]->height > m_vPending[b]->height;
+				return m_vPending[a]->width > m_vPending[b]->width;
+			});
+
+		struct Placement { size_t nIndex; olc::vi2d vPos; };
+		std::vector<SkylinePacker> vPackers;
+		std::vector<std::vector<Placement>> vPlaced;
+
+		for (size_t i : vOrder)
+		{
+			const olc::Sprite* pSprite = m_vPending[i];
+			const int32_t w = pSprite->width + 2 * m_nPadding, h = pSprite->height + 2 * m_nPadding;
+			if (pSprite->width <= 0 || pSprite->height <= 0 || w > m_nPageSize || h > m_nPageSize) continue;
+
+			// First page with room, or a new one
+			olc::vi2d vPos;
+			size_t nPage = 0;
+			while (nPage < vPackers.size() && !vPackers[nPage].Insert(w, h, vPos)) nPage++;
+			if (nPage == vPackers.size())
+			{
+				vPackers.emplace_back(m_nPageSize, m_nPageSize);
+				vPlaced.emplace_back();
+				vPackers.back().Insert(w, h, vPos);
+			}
+			vPlaced[nPage].push_back({ i, vPos + olc::vi2d(m_nPadding, m_nPadding) });
+		}
+
+		// Pages are trimmed to what was used, then filled and uploaded once
+		const size_t nFirstPage = m_vPages.size();
+		for (size_t n = 0; n < vPackers.size(); n++)
+		{
+			const olc::vi2d vSize = vPackers[n].Used();
+			auto pSheet = std::make_unique<olc::Sprite>(vSize.x, vSize.y);
+			for (const auto& p : vPlaced[n])
+				Blit(pSheet.get(), p.vPos, m_vPending[p.nIndex]);
+
+			auto pPage = std::make_unique<olc::Renderable>();
+			pPage->Create(std::move(pSheet), bFilter, true);
+
+			for (const auto& p : vPlaced[n])
+			{
+				AtlasRegion& r = m_vRegions[p.nIndex];
+				r.decal = pPage->Decal();
+				r.pos = olc::vf2d(p.vPos);
+				r.size = { float(m_vPending[p.nIndex]->width), float(m_vPending[p.nIndex]->height) };
+				r.page = int32_t(nFirstPage + n);
+			}
+
+			m_vPages.push_back(std::move(pPage));
+		}
+
+		std::fill(m_vPending.begin(), m_vPending.end(), nullptr);
+	}
+
+	bool TextureAtlas::Update(const size_t nIndex, const olc::Sprite* pSprite)
+	{
+		const AtlasRegion& r = m_vRegions[nIndex];
+		if (r.page < 0 || pSprite->width != int32_t(r.size.x) || pSprite->height != int32_t(r.size.y))
+			return false;
+
+		olc::Renderable* pPage = m_vPages[size_t(r.page)].get();
+		Blit(pPage->Sprite(), olc::vi2d(r.pos), pSprite);
+		pPage->Decal()->Update();
+		return true;
+	}
+}
+
+#endif // OLC_TEXTUREATLAS
+#endif // OLC_TEXTUREATLAS_H
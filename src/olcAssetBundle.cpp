@@ -0,0 +1,2 @@
+#define OLC_ASSETBUNDLE
+#include "olcAssetBundle.h"
\ No newline at end of file
@@ -0,0 +1,2 @@
+#define OLC_MAPPEDFILE
+#include "olcMappedFile.h"
\ No newline at end of file
@@ -0,0 +1,5 @@
+#include "olcPixelGameEngine.h"
+#include "olcSoundWaveEngine.h"
+
+#define OLC_PGEX_AUDIOSTATS
+#include "olcPGEX_AudioStats.h"
\ No newline at end of file
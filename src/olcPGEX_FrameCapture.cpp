@@ -0,0 +1,4 @@
+#include "olcPixelGameEngine.h"
+
+#define OLC_PGEX_FRAMECAPTURE
+#include "olcPGEX_FrameCapture.h"
@@ -0,0 +1,2 @@
+#define OLC_TEXTUREATLAS
+#include "olcTextureAtlas.h"
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*
+	olcAudioCheck - checks wave files and offline rendering in olcSoundWaveEngine.h
+
+	Usage:
+		olcAudioCheck wavefile
+		olcAudioCheck offline
+
+	"wavefile" saves generated waves with wave::File::SaveFile() as 8, 16 and
+	24-bit PCM and 32-bit float, loads each back with LoadFile(), and checks
+	every sample is within the sample size's rounding of the original. It
+	also loads a hand written 8-bit file, which the format stores unsigned,
+	so the loader's reading of it doesn't only have to agree with the saver.
+
+	"offline" plays a known wave through driver::Offline, renders a fixed
+	number of blocks with WaveEngine::RenderOffline(), then loads the file
+	the driver wrote and checks it holds exactly those blocks: the wave,
+	then silence once the voice has finished.
+
+	Both write their files to the working directory, and remove them after.
+*/
+
+// Only ever renders offline, so none of the device drivers the build may have chosen
+#undef SOUNDWAVE_USING_ALSA
+#undef SOUNDWAVE_USING_PULSE
+#undef SOUNDWAVE_USING_SDLMIXER
+#if !defined(SOUNDWAVE_USING_OFFLINE)
+	#define SOUNDWAVE_USING_OFFLINE
+#endif
+#define OLC_SOUNDWAVE
+#include "olcSoundWaveEngine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using olc::sound::wave::File;
+
+// A sine on the left, a saw on the right, touching full scale both ways
+static File<float> MakeSource(const size_t nSampleSize, const size_t nSampleRate, const size_t nSamples)
+{
+	File<float> file(2, nSampleSize, nSampleRate, nSamples);
+	for (size_t n = 0; n < nSamples; n++)
+	{
+		file.data()[n * 2 + 0] = float(std::sin(6.283185307179586 * 441.0 * double(n) / double(nSampleRate)));
+		file.data()[n * 2 + 1] = float(int(n % 201) - 100) / 100.0f;
+	}
+	return file;
+}
+
+static int CheckWaveFile()
+{
+	const std::string sFile = "olcAudioCheck_wavefile.wav";
+	size_t nFailed = 0;
+
+	for (const size_t nSampleSize : { 1, 2, 3, 4 })
+	{
+		File<float> source = MakeSource(nSampleSize, 22050, 1000);
+		File<float> loaded;
+		if (!source.SaveFile(sFile) || !loaded.LoadFile(sFile))
+		{
+			std::cout << "FAIL " << nSampleSize * 8 << "-bit: could not save and load" << std::endl;
+			nFailed++;
+			continue;
+		}
+
+		if (loaded.samplesize() != nSampleSize || loaded.channels() != 2 || loaded.samplerate() != 22050 || loaded.samples() != 1000)
+		{
+			std::cout << "FAIL " << nSampleSize * 8 << "-bit: loaded as " << loaded.samplesize() * 8 << "-bit, "
+				<< loaded.channels() << " channels at " << loaded.samplerate() << "Hz, " << loaded.samples() << " samples" << std::endl;
+			nFailed++;
+			continue;
+		}
+
+		// Half a step of the integer formats, float is exact
+		const double dTolerance = nSampleSize == 4 ? 0.0 : 0.5 / double((uint32_t(1) << (nSampleSize * 8 - 1)) - 1) + 1e-7;
+		double dWorst = 0.0;
+		for (size_t i = 0; i < source.samples() * source.channels(); i++)
+			dWorst = std::max(dWorst, std::abs(double(loaded.data()[i]) - double(source.data()[i])));
+
+		if (dWorst > dTolerance)
+		{
+			std::cout << "FAIL " << nSampleSize * 8 << "-bit: off by up to " << dWorst << ", allowed " << dTolerance << std::endl;
+			nFailed++;
+		}
+	}
+
+	// 8-bit samples are unsigned, centred on 128
+	{
+		std::ofstream ofs(sFile, std::ios::binary);
+		olc::sound::wave::WriteHeader(ofs, 1, 8000, 1, 4);
+		const uint8_t nBytes[4] = { 128, 255, 1, 0 };
+		ofs.write(reinterpret_cast<const char*>(nBytes), sizeof(nBytes));
+	}
+
+	File<float> loaded;
+	const float fExpected[4] = { 0.0f, 1.0f, -1.0f, -128.0f / 127.0f };
+	if (!loaded.LoadFile(sFile) || loaded.samples() != 4 || !std::equal(fExpected, fExpected + 4, loaded.data()))
+	{
+		std::cout << "FAIL 8-bit: unsigned samples decoded wrongly" << std::endl;
+		nFailed++;
+	}
+
+	std::remove(sFile.c_str());
+	std::cout << (nFailed == 0 ? "PASS " : "FAIL ") << "wave files at 8, 16, 24 and 32-bit" << std::endl;
+	return nFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int CheckOffline()
+{
+	const std::string sFile = "olcAudioCheck_offline.wav";
+	constexpr uint32_t nSampleRate = 44100, nBlockSamples = 512, nBlocks = 8;
+	constexpr size_t nWaveSamples = 3000;
+	size_t nFailed = 0;
+
+	// At the device rate, so the mixer copies the wave's samples across untouched
+	olc::sound::Wave wave;
+	wave.LoadAudioWaveform(MakeSource(4, nSampleRate, nWaveSamples));
+	File<float> source = MakeSource(4, nSampleRate, nWaveSamples);
+
+	{
+		olc::sound::WaveEngine engine;
+		engine.UseOutputDevice(sFile);
+		engine.InitialiseAudio(nSampleRate, 2, 8, nBlockSamples);
+		engine.PlayWaveform(&wave);
+
+		// Rounded up to whole blocks, so half a block short asks for exactly nBlocks
+		if (!engine.RenderOffline((double(nBlocks) - 0.5) * nBlockSamples / nSampleRate))
+		{
+			std::cout << "FAIL RenderOffline() refused to render" << std::endl;
+			nFailed++;
+		}
+		if (wave.IsPlaying())
+		{
+			std::cout << "FAIL the voice was still playing after the wave had ended" << std::endl;
+			nFailed++;
+		}
+		// Closing the driver writes the final sizes into the header
+		engine.DestroyAudio();
+	}
+
+	// Loaded in place, so let go of the mapping before removing the file
+	{
+		File<float> rendered;
+		if (!rendered.LoadFile(sFile))
+		{
+			std::cout << "FAIL could not load the rendered file" << std::endl;
+			nFailed++;
+		}
+		else if (rendered.channels() != 2 || rendered.samplerate() != nSampleRate || rendered.samples() != size_t(nBlocks) * nBlockSamples)
+		{
+			std::cout << "FAIL rendered " << rendered.channels() << " channels at " << rendered.samplerate() << "Hz, "
+				<< rendered.samples() << " samples, expected " << nBlocks * nBlockSamples << std::endl;
+			nFailed++;
+		}
+		else
+		{
+			for (size_t i = 0; i < rendered.samples() * 2; i++)
+			{
+				const float fExpected = i < nWaveSamples * 2 ? source.data()[i] : 0.0f;
+				if (rendered.data()[i] != fExpected)
+				{
+					std::cout << "FAIL sample " << i / 2 << " channel " << i % 2 << " is " << rendered.data()[i] << ", expected " << fExpected << std::endl;
+					nFailed++;
+					break;
+				}
+			}
+		}
+	}
+
+	std::remove(sFile.c_str());
+	std::cout << (nFailed == 0 ? "PASS " : "FAIL ") << "offline render of " << nBlocks << " blocks" << std::endl;
+	return nFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string sMode = argc == 2 ? argv[1] : "";
+	if (sMode == "wavefile") return CheckWaveFile();
+	if (sMode == "offline") return CheckOffline();
+
+	std::cerr << "usage: olcAudioCheck wavefile" << std::endl;
+	std::cerr << "       olcAudioCheck offline" << std::endl;
+	return EXIT_FAILURE;
+}
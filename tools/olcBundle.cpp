@@ -0,0 +1,125 @@
+/*
+	olcBundle - builds an asset bundle for olcAssetBundle.h / AssetManager::LoadBundle
+
+	Usage:
+		olcBundle [-u] <bundle> <file or directory>...
+
+	Files in a directory are named by their path relative to it, so
+
+		olcBundle assets.olcb assets
+
+	makes "gfx/space.png", "sounds/thruster.wav" and so on. PNGs (and anything
+	else the engine can load as a sprite) are stored as decoded RGBA, WAVs as
+	float32 samples at their original rate, and every other file as it is.
+	Payloads are LZ4 compressed where it helps, unless -u is given.
+*/
+
+#define OLC_PGE_HEADLESS
+#define OLC_IMAGE_LIBPNG
+#define OLC_PGE_APPLICATION
+#include "olcPixelGameEngine.h"
+
+// Only wave::File is used, which needs no audio device
+#if !defined(SOUNDWAVE_USING_OFFLINE)
+	#define SOUNDWAVE_USING_OFFLINE
+#endif
+#include "olcSoundWaveEngine.h"
+
+#define OLC_ASSETBUNDLE
+#include "olcAssetBundle.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+static bool AddFile(olc::AssetBundleWriter& writer, const fs::path& file, const std::string& sName)
+{
+	std::string sExt = file.extension().string();
+	std::transform(sExt.begin(), sExt.end(), sExt.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+
+	if (sExt == ".png")
+	{
+		olc::Sprite sprite;
+		if (sprite.LoadFromFile(file.string()) != olc::rcode::OK)
+		{
+			std::cerr << "olcBundle: cannot decode <" << file.string() << ">" << std::endl;
+			return false;
+		}
+		writer.AddImage(sName, uint32_t(sprite.width), uint32_t(sprite.height), sprite.GetData());
+		std::cout << "image " << sName << " " << sprite.width << "x" << sprite.height << std::endl;
+		return true;
+	}
+
+	if (sExt == ".wav")
+	{
+		olc::sound::wave::File<float> wav;
+		if (!wav.LoadFile(file.string()))
+		{
+			std::cerr << "olcBundle: cannot decode <" << file.string() << ">" << std::endl;
+			return false;
+		}
+		writer.AddWave(sName, uint32_t(wav.channels()), uint32_t(wav.samplerate()), uint32_t(wav.samples()), wav.data());
+		std::cout << "wave  " << sName << " " << wav.channels() << "ch " << wav.samplerate() << "Hz " << wav.samples() << std::endl;
+		return true;
+	}
+
+	std::shared_ptr<olc::MappedFile> pFile = olc::MappedFile::Open(file.string());
+	if (!pFile)
+	{
+		std::cerr << "olcBundle: cannot read <" << file.string() << ">" << std::endl;
+		return false;
+	}
+	writer.AddRaw(sName, pFile->data(), pFile->size());
+	std::cout << "raw   " << sName << " " << pFile->size() << " bytes" << std::endl;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	bool bCompress = true;
+	std::vector<std::string> vArgs;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::string(argv[i]) == "-u") bCompress = false;
+		else vArgs.push_back(argv[i]);
+	}
+
+	if (vArgs.size() < 2)
+	{
+		std::cerr << "usage: olcBundle [-u] <bundle> <file or directory>..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// No engine is constructed, so the image loader has to be set up by hand
+	olc::Sprite::loader = std::make_unique<olc::ImageLoader_LibPNG>();
+
+	olc::AssetBundleWriter writer;
+	for (size_t i = 1; i < vArgs.size(); i++)
+	{
+		const fs::path input(vArgs[i]);
+		if (fs::is_directory(input))
+		{
+			// Sorted, so the same inputs always build the same bundle
+			std::vector<fs::path> vFiles;
+			for (const auto& e : fs::recursive_directory_iterator(input))
+				if (e.is_regular_file()) vFiles.push_back(e.path());
+			std::sort(vFiles.begin(), vFiles.end());
+
+			for (const auto& file : vFiles)
+				if (!AddFile(writer, file, fs::relative(file, input).generic_string())) return EXIT_FAILURE;
+		}
+		else if (!AddFile(writer, input, input.filename().generic_string()))
+			return EXIT_FAILURE;
+	}
+
+	std::string sError;
+	if (!writer.Save(vArgs[0], bCompress, &sError))
+	{
+		std::cerr << "olcBundle: " << sError << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "wrote " << vArgs[0] << " (" << fs::file_size(vArgs[0]) << " bytes)" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+/*
+	olcGolden - golden frame tests for MJ113, using olcPGEX_FrameCapture.h
+
+	Usage:
+		olcGolden record <session> <golden dir>
+		olcGolden verify <session> <golden dir> [-t tolerance] [-n pixels] [-o output dir]
+
+	A session replays scripted input into a seeded game at a fixed time step,
+	with no window, so every run draws exactly the same frames. "record"
+	writes every captured frame of layer 0 into the golden directory as a
+	PNG; "verify" plays the session again and compares each frame with its
+	golden. A pixel matches if no channel is more than -t apart (default 0),
+	and a frame passes with at most -n pixels that don't (default 0). Frames
+	that fail are written to the output directory (default golden_out) as
+	frame_NNNNNN.rgba next to frame_NNNNNN_diff.png, which shows the golden
+	dimmed with the differing pixels in red.
+
+	Sessions are text, one setting or key event per line:
+
+		seed 113
+		step 0.0166667		# seconds per frame
+		frames 1200
+		every 60		# capture frames 0, 60, 120...
+		90 RIGHT down		# key events, by frame
+		92 RIGHT up
+
+	Run "verify" before and after touching the rasteriser; run "record" only
+	when a change to the picture is intended.
+*/
+
+#define OLC_PGE_HEADLESS
+#define OLC_IMAGE_LIBPNG
+#define OLC_PGE_APPLICATION
+#include "olcPixelGameEngine.h"
+
+#define OLC_PGEX_FRAMECAPTURE
+#include "olcPGEX_FrameCapture.h"
+
+#include "MJ113.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+struct Session
+{
+	uint32_t nSeed = 113;
+	float fStep = 1.0f / 60.0f;
+	uint64_t nFrames = 600;
+	uint32_t nEvery = 60;
+
+	struct KeyEvent { uint64_t nFrame; olc::Key key; bool bDown; };
+	std::vector<KeyEvent> vEvents;
+};
+
+static bool LoadSession(const std::string& sFile, Session& session)
+{
+	static const std::map<std::string, olc::Key> mapKeyNames =
+	{
+		{ "LEFT", olc::Key::LEFT }, { "RIGHT", olc::Key::RIGHT }, { "UP", olc::Key::UP }, { "DOWN", olc::Key::DOWN },
+		{ "SPACE", olc::Key::SPACE }, { "SHIFT", olc::Key::SHIFT }, { "CTRL", olc::Key::CTRL },
+		{ "ENTER", olc::Key::ENTER }, { "ESCAPE", olc::Key::ESCAPE }, { "TAB", olc::Key::TAB },
+	};
+
+	std::ifstream ifs(sFile);
+	if (!ifs.is_open())
+	{
+		std::cerr << "olcGolden: cannot read <" << sFile << ">" << std::endl;
+		return false;
+	}
+
+	std::string sLine;
+	for (int nLine = 1; std::getline(ifs, sLine); nLine++)
+	{
+		sLine = sLine.substr(0, sLine.find('#'));
+		std::istringstream is(sLine);
+		std::string sWord;
+		if (!(is >> sWord)) continue;
+
+		bool bOK = true;
+		if (sWord == "seed") bOK = bool(is >> session.nSeed);
+		else if (sWord == "step") bOK = bool(is >> session.fStep) && session.fStep > 0.0f;
+		else if (sWord == "frames") bOK = bool(is >> session.nFrames) && session.nFrames > 0;
+		else if (sWord == "every") bOK = bool(is >> session.nEvery) && session.nEvery > 0;
+		else
+		{
+			Session::KeyEvent e;
+			std::string sKey, sState;
+			bOK = bool(std::istringstream(sWord) >> e.nFrame) && bool(is >> sKey >> sState) &&
+				mapKeyNames.count(sKey) && (sState == "down" || sState == "up");
+			if (bOK)
+			{
+				e.key = mapKeyNames.at(sKey);
+				e.bDown = sState == "down";
+				session.vEvents.push_back(e);
+			}
+		}
+
+		if (!bOK)
+		{
+			std::cerr << "olcGolden: " << sFile << ":" << nLine << ": cannot parse \"" << sLine << "\"" << std::endl;
+			return false;
+		}
+	}
+
+	std::stable_sort(session.vEvents.begin(), session.vEvents.end(),
+		[](const Session::KeyEvent& a, const Session::KeyEvent& b) { return a.nFrame < b.nFrame; });
+	return true;
+}
+
+// Drives the engine from the session: a fixed time step, scripted keys, and a set length
+class SessionPlayer : public olc::PGEX
+{
+public:
+	SessionPlayer(const Session& session) : olc::PGEX(true), m_session(session) {}
+
+protected:
+	void OnAfterUserCreate() override
+	{ Press(0); }
+
+	bool OnBeforeUserUpdate(float& fElapsedTime) override
+	{
+		fElapsedTime = m_session.fStep;
+		return false;
+	}
+
+	void OnAfterUserUpdate(float fElapsedTime) override
+	{
+		if (++m_nFrame == m_session.nFrames) pge->olc_Terminate();
+		else Press(m_nFrame);
+	}
+
+private:
+	// Key states set between frames are picked up by the next one, as if typed then
+	void Press(const uint64_t nFrame)
+	{
+		for (; m_nEvent < m_session.vEvents.size() && m_session.vEvents[m_nEvent].nFrame <= nFrame; m_nEvent++)
+			pge->olc_UpdateKeyState(int32_t(m_session.vEvents[m_nEvent].key), m_session.vEvents[m_nEvent].bDown);
+	}
+
+	const Session& m_session;
+	uint64_t m_nFrame = 0;
+	size_t m_nEvent = 0;
+};
+
+static bool Play(const Session& session, const std::string& sDirectory, const olc::FrameCapture::Format format)
+{
+	// Both of MJ113's random sources come from the seed
+	srand(session.nSeed);
+	MJ113 game(session.nSeed);
+	if (!game.Construct(LANE_WIDTH * LANES + 1, PREVIEW_DEPTH + LANE_DEPTH + 4 + 4 + PLAYER_WIDTH + ACCEPTOR_DEPTH, 2, 2))
+		return false;
+
+	SessionPlayer player(session);
+	olc::FrameCapture capture;
+	capture.Start(sDirectory, format, session.nEvery);
+	game.Start();
+	capture.Flush();
+
+	if (capture.Failed() > 0)
+	{
+		std::cerr << "olcGolden: " << capture.Failed() << " frames could not be written to <" << sDirectory << ">" << std::endl;
+		return false;
+	}
+	std::cout << "played " << session.nFrames << " frames, captured " << capture.Written() << std::endl;
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> vArgs;
+	int nTolerance = 0;
+	uint32_t nAllowed = 0;
+	std::string sOutput = "golden_out";
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string sArg = argv[i];
+		if (sArg == "-t" && i + 1 < argc) nTolerance = std::clamp(std::atoi(argv[++i]), 0, 255);
+		else if (sArg == "-n" && i + 1 < argc) nAllowed = uint32_t(std::max(std::atoi(argv[++i]), 0));
+		else if (sArg == "-o" && i + 1 < argc) sOutput = argv[++i];
+		else vArgs.push_back(sArg);
+	}
+
+	if (vArgs.size() != 3 || (vArgs[0] != "record" && vArgs[0] != "verify"))
+	{
+		std::cerr << "usage: olcGolden record <session> <golden dir>" << std::endl;
+		std::cerr << "       olcGolden verify <session> <golden dir> [-t tolerance] [-n pixels] [-o output dir]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Session session;
+	if (!LoadSession(vArgs[1], session)) return EXIT_FAILURE;
+	const std::string& sGolden = vArgs[2];
+
+	if (vArgs[0] == "record")
+	{
+		fs::create_directories(sGolden);
+		return Play(session, sGolden, olc::FrameCapture::Format::PNG) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// Raw frames are quicker to write, and lossless like the PNG goldens
+	fs::create_directories(sOutput);
+	if (!Play(session, sOutput, olc::FrameCapture::Format::RAW)) return EXIT_FAILURE;
+
+	size_t nChecked = 0, nFailed = 0;
+	for (uint64_t nFrame = 0; nFrame < session.nFrames; nFrame += session.nEvery)
+	{
+		const fs::path golden = fs::path(sGolden) / olc::FrameCapture::FrameName(nFrame, olc::FrameCapture::Format::PNG);
+		const fs::path actual = fs::path(sOutput) / olc::FrameCapture::FrameName(nFrame, olc::FrameCapture::Format::RAW);
+		nChecked++;
+
+		olc::Sprite sprGolden, sprActual;
+		if (sprGolden.LoadFromFile(golden.string()) != olc::rcode::OK)
+		{
+			std::cout << "FAIL frame " << nFrame << ": no golden <" << golden.string() << ">" << std::endl;
+			nFailed++;
+			continue;
+		}
+		if (sprActual.LoadFromFile(actual.string()) != olc::rcode::OK)
+		{
+			std::cout << "FAIL frame " << nFrame << ": not captured" << std::endl;
+			nFailed++;
+			continue;
+		}
+
+		olc::Sprite sprDiff;
+		const olc::FrameDiff diff = olc::FrameCapture::Compare(&sprGolden, &sprActual, uint8_t(nTolerance), &sprDiff);
+		if (diff.Matches(nAllowed))
+		{
+			// Only failures are kept, so the output directory is the list of what to look at
+			sprActual.pColData.clear();
+			fs::remove(actual);
+			continue;
+		}
+
+		nFailed++;
+		if (!diff.bSameSize)
+		{
+			std::cout << "FAIL frame " << nFrame << ": " << sprActual.width << "x" << sprActual.height
+				<< ", golden is " << sprGolden.width << "x" << sprGolden.height << std::endl;
+			continue;
+		}
+
+		const fs::path diffFile = fs::path(sOutput) / (actual.stem().string() + "_diff.png");
+		olc::Sprite::loader->SaveImageResource(&sprDiff, diffFile.string());
+		std::cout << "FAIL frame " << nFrame << ": " << diff.nDiffering << " pixels differ, by up to " << int(diff.nMaxDelta)
+			<< ", first at (" << diff.vFirst.x << "," << diff.vFirst.y << ") - see " << diffFile.string() << std::endl;
+	}
+
+	std::cout << (nFailed == 0 ? "PASS " : "FAIL ") << nChecked - nFailed << "/" << nChecked << " frames match" << std::endl;
+	return nFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
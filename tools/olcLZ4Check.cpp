@@ -0,0 +1,257 @@
+/*
+	olcLZ4Check - checks the LZ4 block codec in olcAssetBundle.h
+
+	Usage:
+		olcLZ4Check roundtrip [iterations]
+		olcLZ4Check interop <lz4 executable> <file>
+
+	"roundtrip" compresses and decompresses generated data - empty, tiny,
+	random, repetitive and mixed, at many sizes - and checks every byte
+	comes back. It also feeds the decoder truncated and corrupted blocks,
+	which must be rejected, never read or written out of bounds.
+
+	"interop" checks the codec against the reference lz4 tool both ways:
+	the tool compresses <file>, and each block of the frame it writes is
+	decoded with olc::lz4::Decompress(); then <file> is compressed with
+	olc::lz4::Compress(), wrapped in a frame, and the tool decompresses it.
+	Either way the result must match <file> exactly.
+*/
+
+#define OLC_ASSETBUNDLE
+#include "olcAssetBundle.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+static bool RoundTrip(const std::vector<uint8_t>& vData, std::mt19937& rng)
+{
+	std::vector<uint8_t> vPacked(olc::lz4::Bound(vData.size()));
+	const size_t nPacked = olc::lz4::Compress(vData.data(), vData.size(), vPacked.data());
+	if (nPacked > vPacked.size()) return false;
+
+	std::vector<uint8_t> vOut(vData.size());
+	if (!olc::lz4::Decompress(vPacked.data(), nPacked, vOut.data(), vOut.size()) || vOut != vData)
+		return false;
+
+	// Damaged input may decode to rubbish, but must stay inside the buffers
+	if (nPacked > 1)
+	{
+		olc::lz4::Decompress(vPacked.data(), nPacked - 1 - rng() % (nPacked - 1), vOut.data(), vOut.size());
+		std::vector<uint8_t> vBad(vPacked.begin(), vPacked.begin() + nPacked);
+		vBad[rng() % nPacked] ^= uint8_t(1 + rng() % 255);
+		olc::lz4::Decompress(vBad.data(), vBad.size(), vOut.data(), vOut.size());
+	}
+	return true;
+}
+
+static int CheckRoundTrip(const int nIterations)
+{
+	std::mt19937 rng(38);
+	size_t nFailed = 0;
+
+	// An empty payload, with nothing behind the pointers at all
+	if (olc::lz4::Compress(nullptr, 0, std::vector<uint8_t>(olc::lz4::Bound(0)).data()) == 0) nFailed++;
+
+	for (int i = 0; i < nIterations; i++)
+	{
+		// Sizes either side of the format's end-of-block limits, and larger ones
+		const size_t nSize = i < 64 ? size_t(i) : size_t(rng() % (i % 8 == 0 ? 1 << 20 : 4096));
+		std::vector<uint8_t> vData(nSize);
+		switch (i % 4)
+		{
+		case 0: for (auto& b : vData) b = uint8_t(rng()); break;
+		case 1: for (auto& b : vData) b = uint8_t(rng() % 3); break;
+		case 2: for (size_t n = 0; n < nSize; n++) vData[n] = uint8_t(n % (1 + i % 17)); break;
+		default:
+			// Runs of random length copied from earlier on, at random distances
+			for (size_t n = 0; n < nSize; )
+			{
+				const size_t nRun = std::min<size_t>(1 + rng() % 300, nSize - n);
+				const size_t nBack = 1 + rng() % 70000;
+				for (size_t k = 0; k < nRun; k++, n++)
+					vData[n] = (n >= nBack && rng() % 8 != 0) ? vData[n - nBack] : uint8_t(rng());
+			}
+			break;
+		}
+
+		if (!RoundTrip(vData, rng))
+		{
+			std::cout << "FAIL round trip of " << nSize << " bytes, pattern " << i % 4 << std::endl;
+			nFailed++;
+		}
+	}
+
+	std::cout << (nFailed == 0 ? "PASS " : "FAIL ") << nIterations << " round trips" << std::endl;
+	return nFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// XXH32, only as much as an LZ4 frame descriptor checksum needs: fewer than 16 bytes
+static uint32_t XXH32Short(const uint8_t* p, const size_t n)
+{
+	constexpr uint32_t P1 = 2654435761u, P3 = 3266489917u, P4 = 668265263u, P5 = 374761393u;
+	auto Rotl = [](uint32_t x, int r) { return (x << r) | (x >> (32 - r)); };
+	uint32_t h = P5 + uint32_t(n);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		uint32_t v; std::memcpy(&v, p + i, 4);
+		h = Rotl(h + v * P3, 17) * P4;
+	}
+	for (; i < n; i++) h = Rotl(h + p[i] * P5, 11) * P1;
+	h ^= h >> 15; h *= 2246822519u; h ^= h >> 13; h *= P3; h ^= h >> 16;
+	return h;
+}
+
+static uint32_t Read32LE(const uint8_t* p)
+{ return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24; }
+
+static void Write32LE(std::vector<uint8_t>& v, const uint32_t n)
+{ for (int i = 0; i < 4; i++) v.push_back(uint8_t(n >> (8 * i))); }
+
+static bool ReadFile(const std::string& sFile, std::vector<uint8_t>& vData)
+{
+	std::ifstream ifs(sFile, std::ios::binary);
+	if (!ifs.is_open()) return false;
+	vData.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static bool WriteFile(const std::string& sFile, const std::vector<uint8_t>& vData)
+{
+	std::ofstream ofs(sFile, std::ios::binary);
+	ofs.write(reinterpret_cast<const char*>(vData.data()), std::streamsize(vData.size()));
+	return ofs.good();
+}
+
+// Decodes an LZ4 frame of independent blocks, using the size of the original to size each block
+static bool DecodeFrame(const std::vector<uint8_t>& vFrame, const size_t nOriginal, std::vector<uint8_t>& vOut, std::string& sError)
+{
+	if (vFrame.size() < 7 || Read32LE(vFrame.data()) != 0x184D2204) { sError = "not an LZ4 frame"; return false; }
+	const uint8_t nFlags = vFrame[4], nBD = vFrame[5];
+	if ((nFlags & 0x20) == 0) { sError = "blocks are linked, only independent blocks can be checked"; return false; }
+	const bool bBlockChecksum = (nFlags & 0x10) != 0, bContentSize = (nFlags & 0x08) != 0, bDictionary = (nFlags & 0x01) != 0;
+	const size_t nBlockMax = size_t(1) << (8 + 2 * ((nBD >> 4) & 7));
+
+	size_t ip = 6 + (bContentSize ? 8 : 0) + (bDictionary ? 4 : 0) + 1;
+	vOut.resize(nOriginal);
+	size_t op = 0;
+	while (ip + 4 <= vFrame.size())
+	{
+		const uint32_t nBlock = Read32LE(vFrame.data() + ip);
+		ip += 4;
+		if (nBlock == 0) return op == nOriginal || (sError = "frame is shorter than the file", false);
+
+		const size_t nSize = nBlock & 0x7FFFFFFF;
+		const size_t nExpect = std::min(nBlockMax, nOriginal - op);
+		if (nSize > vFrame.size() - ip) { sError = "truncated block"; return false; }
+		if (nBlock & 0x80000000)
+		{
+			if (nSize != nExpect) { sError = "stored block of the wrong size"; return false; }
+			std::memcpy(vOut.data() + op, vFrame.data() + ip, nSize);
+		}
+		else if (!olc::lz4::Decompress(vFrame.data() + ip, nSize, vOut.data() + op, nExpect))
+		{
+			sError = "olc::lz4::Decompress rejected the block at byte " + std::to_string(ip - 4);
+			return false;
+		}
+		ip += nSize + (bBlockChecksum ? 4 : 0);
+		op += nExpect;
+	}
+	sError = "no end mark";
+	return false;
+}
+
+// One frame of independent 4 MB blocks, without checksums
+static std::vector<uint8_t> EncodeFrame(const std::vector<uint8_t>& vData)
+{
+	constexpr size_t nBlockMax = size_t(4) << 20;
+	std::vector<uint8_t> vFrame;
+	Write32LE(vFrame, 0x184D2204);
+	vFrame.push_back(0x60);	// version 1, independent blocks
+	vFrame.push_back(0x70);	// 4 MB blocks
+	vFrame.push_back(uint8_t(XXH32Short(vFrame.data() + 4, 2) >> 8));
+
+	std::vector<uint8_t> vPacked(olc::lz4::Bound(nBlockMax));
+	for (size_t n = 0; n < vData.size(); n += nBlockMax)
+	{
+		const size_t nSize = std::min(nBlockMax, vData.size() - n);
+		const size_t nPacked = olc::lz4::Compress(vData.data() + n, nSize, vPacked.data());
+		if (nPacked >= nSize)
+		{
+			// Incompressible, and the format caps a block at its maximum size, so store it
+			Write32LE(vFrame, uint32_t(nSize) | 0x80000000);
+			vFrame.insert(vFrame.end(), vData.begin() + n, vData.begin() + n + nSize);
+		}
+		else
+		{
+			Write32LE(vFrame, uint32_t(nPacked));
+			vFrame.insert(vFrame.end(), vPacked.begin(), vPacked.begin() + nPacked);
+		}
+	}
+	Write32LE(vFrame, 0);
+	return vFrame;
+}
+
+static int CheckInterop(const std::string& sLZ4, const std::string& sFile)
+{
+	std::vector<uint8_t> vData;
+	if (!ReadFile(sFile, vData))
+	{
+		std::cerr << "olcLZ4Check: cannot read <" << sFile << ">" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const std::string sTheirs = "olcLZ4Check_theirs.lz4", sOurs = "olcLZ4Check_ours.lz4", sBack = "olcLZ4Check_ours.out";
+	size_t nFailed = 0;
+
+	// Reference lz4 to olc::lz4
+	std::vector<uint8_t> vFrame, vOut;
+	std::string sError;
+	if (std::system(("\"" + sLZ4 + "\" -q -f -BI -B4 \"" + sFile + "\" " + sTheirs).c_str()) != 0 || !ReadFile(sTheirs, vFrame))
+	{
+		std::cout << "FAIL lz4 could not compress <" << sFile << ">" << std::endl;
+		nFailed++;
+	}
+	else if (!DecodeFrame(vFrame, vData.size(), vOut, sError) || vOut != vData)
+	{
+		std::cout << "FAIL decoding lz4's output: " << (sError.empty() ? "contents differ" : sError) << std::endl;
+		nFailed++;
+	}
+
+	// olc::lz4 to reference lz4
+	vOut.clear();
+	if (!WriteFile(sOurs, EncodeFrame(vData)) ||
+		std::system(("\"" + sLZ4 + "\" -q -f -d " + sOurs + " " + sBack).c_str()) != 0 || !ReadFile(sBack, vOut))
+	{
+		std::cout << "FAIL lz4 could not decompress olc::lz4's output" << std::endl;
+		nFailed++;
+	}
+	else if (vOut != vData)
+	{
+		std::cout << "FAIL lz4 decompressed olc::lz4's output to something else" << std::endl;
+		nFailed++;
+	}
+
+	std::remove(sTheirs.c_str());
+	std::remove(sOurs.c_str());
+	std::remove(sBack.c_str());
+
+	std::cout << (nFailed == 0 ? "PASS " : "FAIL ") << "interop with lz4 on <" << sFile << "> (" << vData.size() << " bytes)" << std::endl;
+	return nFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::string sMode = argc > 1 ? argv[1] : "";
+	if (sMode == "roundtrip" && argc <= 3)
+		return CheckRoundTrip(argc == 3 ? std::max(std::atoi(argv[2]), 1) : 2000);
+	if (sMode == "interop" && argc == 4)
+		return CheckInterop(argv[2], argv[3]);
+
+	std::cerr << "usage: olcLZ4Check roundtrip [iterations]" << std::endl;
+	std::cerr << "       olcLZ4Check interop <lz4 executable> <file>" << std::endl;
+	return EXIT_FAILURE;
+}
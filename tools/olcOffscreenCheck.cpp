@@ -0,0 +1,168 @@
+/*
+	olcOffscreenCheck - draws through the real OpenGL 3.3 renderer, with no display
+
+	Usage:
+		olcOffscreenCheck [pipelined] [frames]
+
+	Built with OLC_PGE_OFFSCREEN, so the engine renders into an EGL pbuffer.
+	Every frame fills layer 0 with a pattern that moves from frame to frame,
+	and draws two decals over it: one as it is, and one scaled and tinted.
+	Each frame is read back with ReadFrame() during the next one, and every
+	pixel is checked against what was drawn - the layer must come through
+	exactly, and the decals within one step for the tint. "pipelined" runs
+	the engine with its render thread.
+
+	The time per frame is printed, so the GL path can be compared between
+	runs as well as tested. Exits with 77, which ctest counts as skipped,
+	if no EGL display can be opened at all.
+*/
+
+#define OLC_PGE_OFFSCREEN
+#define OLC_PGE_APPLICATION
+#include "olcPixelGameEngine.h"
+
+#include <cstdlib>
+#include <iostream>
+
+class OffscreenCheck : public olc::PixelGameEngine
+{
+public:
+	OffscreenCheck(const int nFrames) : m_nFrames(nFrames)
+	{ sAppName = "olcOffscreenCheck"; }
+
+	bool m_bNoDevice = false;
+	int m_nFramesDrawn = 0;
+	int m_nFramesChecked = 0;
+	int m_nFramesFailed = 0;
+
+protected:
+	bool OnUserCreate() override
+	{
+		// Graphics failed to start, so there is no layer to draw on
+		if (GetLayers().empty())
+		{
+			m_bNoDevice = true;
+			return false;
+		}
+
+		m_pDecal = std::make_unique<olc::Renderable>();
+		m_pDecal->Create(4, 4);
+		for (int y = 0; y < 4; y++)
+			for (int x = 0; x < 4; x++)
+				m_pDecal->Sprite()->SetPixel(x, y, Quadrant(x / 2, y / 2));
+		m_pDecal->Decal()->Update();
+		return true;
+	}
+
+	bool OnUserUpdate(float fElapsedTime) override
+	{
+		UNUSED(fElapsedTime);
+
+		// The back buffer still holds the frame drawn last time round
+		if (m_nFramesDrawn > 0)
+		{
+			ReadFrame(&m_sprFrame);
+			m_nFramesChecked++;
+			if (!CheckFrame(m_nFramesDrawn - 1)) m_nFramesFailed++;
+		}
+
+		const int f = m_nFramesDrawn;
+		for (int y = 0; y < ScreenHeight(); y++)
+			for (int x = 0; x < ScreenWidth(); x++)
+				Draw(x, y, Layer(x, y, f));
+		DrawDecal(m_vPlain, m_pDecal->Decal());
+		DrawDecal(m_vScaled, m_pDecal->Decal(), { 2.0f, 2.0f }, m_tint);
+
+		return ++m_nFramesDrawn <= m_nFrames;
+	}
+
+private:
+	static olc::Pixel Layer(const int x, const int y, const int f)
+	{ return olc::Pixel(uint8_t(x + f), uint8_t(y * 3 + f), uint8_t(x ^ y)); }
+
+	static olc::Pixel Quadrant(const int x, const int y)
+	{
+		static const olc::Pixel p[4] = { olc::RED, olc::GREEN, olc::BLUE, olc::WHITE };
+		return p[y * 2 + x];
+	}
+
+	static std::string RGB(const olc::Pixel p)
+	{ return "rgb(" + std::to_string(p.r) + "," + std::to_string(p.g) + "," + std::to_string(p.b) + ")"; }
+
+	bool InTinted(const int x, const int y) const
+	{ return x >= m_vScaled.x && x < m_vScaled.x + 8 && y >= m_vScaled.y && y < m_vScaled.y + 8; }
+
+	// What frame f should look like, in layer coordinates
+	olc::Pixel Expected(const int x, const int y, const int f) const
+	{
+		if (x >= m_vPlain.x && x < m_vPlain.x + 4 && y >= m_vPlain.y && y < m_vPlain.y + 4)
+			return Quadrant((x - m_vPlain.x) / 2, (y - m_vPlain.y) / 2);
+		if (InTinted(x, y))
+		{
+			const olc::Pixel q = Quadrant((x - m_vScaled.x) / 4, (y - m_vScaled.y) / 4);
+			return olc::Pixel(uint8_t(q.r * m_tint.r / 255), uint8_t(q.g * m_tint.g / 255), uint8_t(q.b * m_tint.b / 255));
+		}
+		return Layer(x, y, f);
+	}
+
+	bool CheckFrame(const int f)
+	{
+		if (m_sprFrame.width != ScreenWidth() || m_sprFrame.height != ScreenHeight())
+		{
+			std::cout << "FAIL frame " << f << ": read back " << m_sprFrame.width << "x" << m_sprFrame.height << std::endl;
+			return false;
+		}
+
+		int nDiffering = 0;
+		for (int y = 0; y < ScreenHeight(); y++)
+			for (int x = 0; x < ScreenWidth(); x++)
+			{
+				const olc::Pixel a = m_sprFrame.GetPixel(x, y), e = Expected(x, y, f);
+				const int nDelta = std::max({ std::abs(a.r - e.r), std::abs(a.g - e.g), std::abs(a.b - e.b) });
+				// The tint is a float multiply on the GPU, so may round either way
+				if (nDelta > (InTinted(x, y) ? 1 : 0) && nDiffering++ == 0)
+					std::cout << "FAIL frame " << f << ": (" << x << "," << y << ") is " << RGB(a) << ", expected " << RGB(e) << std::endl;
+			}
+		return nDiffering == 0;
+	}
+
+	const int m_nFrames;
+	std::unique_ptr<olc::Renderable> m_pDecal;
+	olc::Sprite m_sprFrame;
+
+	const olc::vi2d m_vPlain = { 10, 20 };
+	const olc::vi2d m_vScaled = { 40, 12 };
+	const olc::Pixel m_tint = { 128, 200, 64 };
+};
+
+int main(int argc, char* argv[])
+{
+	bool bPipelined = false;
+	int nFrames = 60;
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string sArg = argv[i];
+		if (sArg == "pipelined") bPipelined = true;
+		else nFrames = std::max(std::atoi(argv[i]), 1);
+	}
+
+	OffscreenCheck check(nFrames);
+	if (!check.Construct(320, 240, 1, 1, false, false, false, bPipelined))
+		return EXIT_FAILURE;
+
+	const auto tStart = std::chrono::steady_clock::now();
+	check.Start();
+	const double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+	if (check.m_bNoDevice)
+	{
+		std::cout << "SKIP no EGL display to render to" << std::endl;
+		return 77;
+	}
+
+	const bool bPassed = check.m_nFramesChecked == nFrames && check.m_nFramesFailed == 0;
+	std::cout << (bPassed ? "PASS " : "FAIL ") << check.m_nFramesChecked - check.m_nFramesFailed << "/" << nFrames
+		<< " frames match" << (bPipelined ? ", pipelined" : "") << ", "
+		<< dSeconds * 1000.0 / std::max(check.m_nFramesDrawn, 1) << " ms/frame" << std::endl;
+	return bPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}